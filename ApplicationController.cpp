@@ -2,18 +2,34 @@
 #include <QtQml>
 #include <QFile>
 #include <QTextStream>
+#include <QDir>
+#include <QStandardPaths>
+#include <QQuickWindow>
 #include "DebugLogger.h"
+#include "FlightRecorder.h"
+#include "SimulatedArduino.h"
 
-ApplicationController::ApplicationController(QObject *parent)
+ApplicationController::ApplicationController(const bool headless, QObject *parent)
     : QObject(parent)
-      , m_engine(new QQmlApplicationEngine)
+      , m_headless(headless)
+      , m_engine(headless ? nullptr : new QQmlApplicationEngine)
       , m_workerThread(new QThread)
       , m_worker(new I2CWorker)
       , m_serialThread(new QThread)
       , m_serialWorker(new SerialWorker)
+      , m_logThread(new QThread)
+      , m_logArchiver(new LogArchiver(DebugLogger::instance().logDirectory()))
       , m_slotMachine(new SlotMachine)
-      , m_healthcheckTimer(new QTimer(this)) {
+      , m_healthcheckTimer(new ClockTimer(this))
+      , m_telemetryTimer(new QTimer(this))
+      , m_metricsTimer(new QTimer(this))
+      , m_stallWatchdog(new StallWatchdog)
+      , m_startup(new StartupPipeline)
+      , m_healthcheckFailuresGauge(MetricsRegistry::instance().gauge(
+            "allesspitze_healthcheck_consecutive_failures", "Failed I2C healthchecks in a row")) {
     m_healthcheckTimer->setInterval(1000);
+    m_telemetryTimer->setInterval(1000);
+    m_metricsTimer->setInterval(METRICS_INTERVAL_MS);
 }
 
 ApplicationController::~ApplicationController() {
@@ -25,42 +41,51 @@ ApplicationController::~ApplicationController() {
         m_serialThread->quit();
         m_serialThread->wait();
     }
+    if (m_logThread) {
+        m_logThread->quit();
+        m_logThread->wait();
+    }
 }
 
 void ApplicationController::initialize() {
     qDebug() << "Main/UI Thread ID:" << QThread::currentThreadId();
 
-    setupQmlEngine();
+    setupTracing();
+    setupFlightRecorder();
+    setupLogArchiver();
+    if (!m_headless) {
+        setupQmlEngine();
+    }
     setupI2CWorker();
     setupSerialWorker();
     setupSlotMachine();
     setupConnections();
+    setupSerialEvents();
+    setupMetrics();
+    setupStallWatchdog();
     setupCleanup();
 
-    QTimer::singleShot(200, this, [this]() {
-        QMetaObject::invokeMethod(m_worker.data(), "openDevice",
-                                  Q_ARG(uint8_t, 0x42));
-    });
-
-    QTimer::singleShot(500, this, [this]() {
-        applyPowerState();
-        startHealthcheck();
-    });
-
-    // Open serial port after a delay
-    QTimer::singleShot(1000, this, [this]() {
-        QMetaObject::invokeMethod(m_serialWorker.data(), "openPort",
-                                  Qt::QueuedConnection);
-    });
+    setupStartup();
 }
 
-bool ApplicationController::start() const {
+bool ApplicationController::start() {
+    if (m_headless) {
+        // Results only: no QML engine, symbol images or scene graph
+        m_headlessReel.reset(new HeadlessReel);
+        m_slotMachine->setReel(m_headlessReel.data());
+        m_startup->finish("ui");
+        DebugLogger::instance().info("Headless: game driven by the cabinet buttons and serial commands");
+        return true;
+    }
+
     if (!m_engine) {
         qCritical() << "QML Engine is null!";
         return false;
     }
 
+    // The worker threads are already bringing up the hardware meanwhile
     m_engine->load(QUrl(QStringLiteral("qrc:/qml/main.qml")));
+    m_startup->finish("ui", !m_engine->rootObjects().isEmpty());
 
     if (m_engine->rootObjects().isEmpty()) {
         qCritical() << "Failed to load QML - no root objects created";
@@ -68,9 +93,219 @@ bool ApplicationController::start() const {
         return false;
     }
 
+    setupFrameTiming();
     return true;
 }
 
+void ApplicationController::setupStartup() {
+    // Completion signals are connected before the threads exist, so none
+    // can be missed
+    connect(m_worker.data(), &I2CWorker::initialization_complete,
+            this, [this]() {
+                m_startup->finish("i2c worker");
+            });
+    connect(m_worker.data(), &I2CWorker::deviceOpened,
+            this, [this](const bool success) {
+                if (!success) {
+                    m_startup->finish("i2c link", false); // Recovery carries on in the background
+                }
+            });
+    connect(m_worker.data(), &I2CWorker::connectionStateChanged,
+            this, [this](const I2CWorker::ConnectionState state) {
+                if (state == I2CWorker::ConnectionState::Ready ||
+                    state == I2CWorker::ConnectionState::Degraded) {
+                    m_startup->finish("i2c link");
+                }
+            });
+    connect(m_serialWorker.data(), &SerialWorker::portOpened,
+            this, [this](const bool success) {
+                m_startup->finish("serial", success);
+            });
+
+    m_startup->addStep("i2c worker", {}, [this]() {
+        m_workerThread->start();
+    });
+    m_startup->addStep("i2c link", {"i2c worker"}, [this]() {
+        QMetaObject::invokeMethod(m_worker.data(), "openDevices", Qt::QueuedConnection);
+    }, I2C_LINK_TIMEOUT_MS);
+
+    // ALLESSPITZE_SERIAL_PORT overrides the USB adapter scan, e.g. to attach
+    // a pty for testing
+    m_startup->addStep("serial", {}, [this]() {
+        m_serialThread->start();
+        QMetaObject::invokeMethod(m_serialWorker.data(), "openPort",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QString, qEnvironmentVariable("ALLESSPITZE_SERIAL_PORT")));
+    });
+    m_startup->addStep("balance", {}, [this]() {
+        loadBalance();
+        m_startup->finish("balance");
+    });
+    m_startup->addStep("ui", {}, nullptr, 0); // QML or the headless reel, finished by start()
+    m_startup->addStep("power", {"balance", "i2c link"}, [this]() {
+        applyPowerState();
+        startHealthcheck();
+        m_startup->finish("power");
+    });
+    m_startup->addMilestone("playable", {"ui", "power"});
+
+    m_startup->start();
+}
+
+void ApplicationController::setupFrameTiming() {
+    auto *window = qobject_cast<QQuickWindow *>(m_engine->rootObjects().first());
+    if (!window) {
+        DebugLogger::instance().warning("Root object is not a window - input latency not measured");
+        return;
+    }
+
+    // Both are emitted on the render thread; handle them there so the
+    // swap is timed when it happens, not when the GUI thread gets to it
+    connect(window, &QQuickWindow::afterSynchronizing, this, [this]() {
+        m_input_latency.frameSynchronized();
+    }, Qt::DirectConnection);
+
+    // Quick only renders when something changed, so long intervals while
+    // idle are normal; the upper buckets matter during animations
+    MetricsRegistry::Histogram &frameInterval = MetricsRegistry::instance().histogram(
+        "allesspitze_frame_interval_seconds", "Time between swapped frames",
+        {0.008, 0.012, 0.017, 0.025, 0.033, 0.05, 0.1, 0.25, 1.0});
+    connect(window, &QQuickWindow::frameSwapped, this, [this, &frameInterval, lastSwapNs = int64_t{0}]() mutable {
+        m_input_latency.frameSwapped();
+
+        const int64_t now = InputLatency::nowNs();
+        if (lastSwapNs != 0) {
+            frameInterval.observe(static_cast<double>(now - lastSwapNs) / 1e9);
+        }
+        lastSwapNs = now;
+    }, Qt::DirectConnection);
+}
+
+void ApplicationController::setupTracing() {
+    Trace::setThreadName("GUI");
+    Trace::watchProperties(m_slotMachine.data());
+    Trace::watchProperties(this);
+
+    // ALLESSPITZE_TRACE=1 records from startup, e.g. to trace the boot
+    if (qEnvironmentVariable("ALLESSPITZE_TRACE") == "1") {
+        setTracing(true);
+    }
+}
+
+void ApplicationController::setupFlightRecorder() {
+    // Always on; decode with tools/flight_decode after a crash
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+
+    FlightRecorder &recorder = FlightRecorder::instance();
+    QString error;
+    if (!recorder.open(dataDir + "/flight.ring", error)) {
+        DebugLogger::instance().warning("Flight recorder disabled: " + error);
+        return;
+    }
+
+    if (!recorder.previousSessionCopy().isEmpty()) {
+        DebugLogger::instance().warning(
+            QString("Previous session did not shut down cleanly; its flight record is in %1")
+            .arg(recorder.previousSessionCopy()));
+    }
+}
+
+void ApplicationController::setupLogArchiver() {
+    // Compression and pruning are never urgent; keep them off the cores the
+    // GUI and I2C threads need
+    connect(&DebugLogger::instance(), &DebugLogger::logSegmentClosed,
+            m_logArchiver.data(), &LogArchiver::segmentClosed);
+
+    m_logArchiver->moveToThread(m_logThread.data());
+    connect(m_logThread.data(), &QThread::started,
+            m_logArchiver.data(), &LogArchiver::initialize);
+    m_logThread->start(QThread::IdlePriority);
+}
+
+void ApplicationController::setupMetrics() {
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+
+    // Read at exposition time, on this thread, from counters that already exist
+    metrics.addCollector([this](MetricsRegistry::Collection &out) {
+        for (const I2CTelemetry::OpcodeStats &stats: m_worker->telemetry().snapshot()) {
+            const QString labels = QString("opcode=\"%1\"").arg(I2CTelemetry::opcodeName(stats.command));
+            out.counter("allesspitze_i2c_commands_total", "I2C commands issued", labels,
+                        static_cast<double>(stats.sent));
+            out.counter("allesspitze_i2c_command_failures_total", "I2C commands that ran out of retries", labels,
+                        static_cast<double>(stats.failed));
+            out.counter("allesspitze_i2c_retries_total", "I2C frames resent after a failed attempt", labels,
+                        static_cast<double>(stats.retries));
+            out.counter("allesspitze_i2c_checksum_failures_total", "I2C replies with a bad checksum", labels,
+                        static_cast<double>(stats.checksumFailures));
+        }
+
+        const I2CWorker::BusStatistics bus = m_worker->busStatistics();
+        out.gauge("allesspitze_i2c_max_lock_hold_seconds", "Longest the I2C bus lock was held", QString(),
+                  static_cast<double>(bus.maxLockHoldNs) / 1e9);
+        out.counter("allesspitze_i2c_command_overflows_total", "Output commands that spilled past the ring",
+                    QString(), static_cast<double>(m_worker->commandOverflows()));
+
+        const InputLatency::Report latency = m_input_latency.report();
+        out.counter("allesspitze_input_ignored_presses_total", "Button presses that changed nothing", QString(),
+                    static_cast<double>(latency.ignored));
+
+        out.gauge("allesspitze_powered_on", "1 while the machine is powered on", QString(), m_powered_on ? 1 : 0);
+        out.gauge("allesspitze_balance", "Current credit balance", QString(), m_slotMachine->balance());
+    });
+
+    // ALLESSPITZE_METRICS_FILE points the snapshot at node_exporter's
+    // textfile collector directory; 0 turns it off
+    m_metrics_path = qEnvironmentVariable("ALLESSPITZE_METRICS_FILE");
+    if (m_metrics_path == "0") {
+        return;
+    }
+    if (m_metrics_path.isEmpty()) {
+        const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dataDir);
+        m_metrics_path = dataDir + "/allesspitze.prom";
+    }
+
+    connect(m_metricsTimer.data(), &QTimer::timeout,
+            this, &ApplicationController::writeMetricsFile);
+    m_metricsTimer->start();
+}
+
+void ApplicationController::setupStallWatchdog() {
+    // ALLESSPITZE_STALL_MS sets the threshold; 0 turns the watchdog off
+    int thresholdMs = StallWatchdog::DEFAULT_THRESHOLD_MS;
+    const QString setting = qEnvironmentVariable("ALLESSPITZE_STALL_MS");
+    if (!setting.isEmpty()) {
+        bool ok = false;
+        thresholdMs = setting.toInt(&ok);
+        if (!ok || thresholdMs < 0) {
+            DebugLogger::instance().warning("Ignoring ALLESSPITZE_STALL_MS=" + setting);
+            thresholdMs = StallWatchdog::DEFAULT_THRESHOLD_MS;
+        }
+    }
+    if (thresholdMs == 0) {
+        return;
+    }
+
+    // After setupConnections(), so the counts drop once the real handlers ran
+    m_stallWatchdog->trackQueue("button batches", m_worker.data(), &I2CWorker::buttonEventsReceived);
+    m_stallWatchdog->trackQueue("I2C responses", m_worker.data(), &I2CWorker::rawCommandResponse);
+    m_stallWatchdog->trackQueue("healthchecks", m_worker.data(), &I2CWorker::healthCheckComplete);
+    m_stallWatchdog->trackQueue("serial commands", m_serialWorker.data(), &SerialWorker::commandReceived);
+
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    m_stallWatchdog->start(thresholdMs, dataDir + "/stalls.log");
+    DebugLogger::instance().info(QString("Stall watchdog: reporting GUI stalls over %1 ms").arg(thresholdMs));
+}
+
+void ApplicationController::writeMetricsFile() const {
+    QString error;
+    if (!MetricsRegistry::instance().writeTextfile(m_metrics_path, error)) {
+        DebugLogger::instance().warning("Metrics: " + error);
+    }
+}
+
 void ApplicationController::setupQmlEngine() const {
     qmlRegisterSingletonInstance("DebugTools", 1, 0, "DebugLogger",
                                  &DebugLogger::instance());
@@ -88,44 +323,110 @@ void ApplicationController::setupQmlEngine() const {
 }
 
 void ApplicationController::setupI2CWorker() {
+    // ALLESSPITZE_I2C=sim[:latency=20,jitter=5,drop=0.01,...] swaps the bus
+    // for the in-process Arduino simulator (see SimulatedArduino::Config)
+    if (const QString transport = qEnvironmentVariable("ALLESSPITZE_I2C");
+        transport.startsWith("sim")) {
+        QString error;
+        const auto config = SimulatedArduino::Config::fromString(transport.section(':', 1), error);
+        if (!error.isEmpty()) {
+            DebugLogger::instance().warning("I2C simulator: " + error);
+        }
+
+        auto simulator = std::make_unique<SimulatedArduino>(config);
+        m_worker->setDataReadySource(simulator->dataReadySource());
+        m_worker->setTransport(std::move(simulator));
+    }
+
+    // Optional data-ready line, e.g. ALLESSPITZE_DATA_READY_GPIO=gpiochip0:17.
+    // Without it the worker falls back to fixed-interval polling.
+    if (const QString gpioSpec = qEnvironmentVariable("ALLESSPITZE_DATA_READY_GPIO");
+        !gpioSpec.isEmpty()) {
+        QString error;
+        if (auto source = GpioDataReadySource::open(gpioSpec, error)) {
+            m_worker->setDataReadySource(std::move(source));
+        } else {
+            DebugLogger::instance().warning(error + " - using button polling");
+        }
+    }
+
+    // Boards on the bus; without i2c_devices.json a single board at 0x42
+    // owns every button, tower and the display
+    {
+        const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+                             "/i2c_devices.json";
+        QString error;
+        const I2CDeviceMap deviceMap = I2CDeviceMap::load(path, error);
+        if (!error.isEmpty()) {
+            DebugLogger::instance().warning(error + " - using a single board at 0x42");
+        }
+        DebugLogger::instance().info(QString("I2C devices: %1").arg(deviceMap.describe()));
+        m_worker->setDeviceMap(deviceMap);
+    }
+
+    // Always-on bus capture for field diagnosis (decode with tools/i2c_replay).
+    // ALLESSPITZE_I2C_RECORD=0 turns it off.
+    if (qEnvironmentVariable("ALLESSPITZE_I2C_RECORD") != "0") {
+        const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dataDir);
+
+        QString error;
+        if (auto recorder = I2CBusRecorder::open(dataDir + "/i2c_bus.ring", error)) {
+            m_worker->setBusRecorder(std::move(recorder));
+        } else {
+            DebugLogger::instance().warning("I2C bus recorder disabled: " + error);
+        }
+    }
+
     m_worker->moveToThread(m_workerThread.data());
     connect(m_workerThread.data(), &QThread::started,
             m_worker.data(), &I2CWorker::initialize);
-    m_workerThread->start();
 }
 
 void ApplicationController::setupSerialWorker() {
+    // ALLESSPITZE_SERIAL_OVERFLOW=block|drop-telemetry|keep-replies picks
+    // what happens to output the link cannot keep up with
+    if (const QString policyName = qEnvironmentVariable("ALLESSPITZE_SERIAL_OVERFLOW");
+        !policyName.isEmpty()) {
+        SerialOutputQueue::OverflowPolicy policy;
+        if (SerialOutputQueue::policyFromString(policyName, policy)) {
+            m_serialWorker->setOverflowPolicy(policy);
+        } else {
+            DebugLogger::instance().warning("Unknown serial overflow policy '" + policyName +
+                                            "' - using keep-replies");
+        }
+    }
+
     m_serialWorker->moveToThread(m_serialThread.data());
     connect(m_serialThread.data(), &QThread::started,
             m_serialWorker.data(), &SerialWorker::initialize);
-    m_serialThread->start();
 }
 
 void ApplicationController::setupSlotMachine() const {
-    loadBalance();
     m_slotMachine->setI2CWorker(m_worker.data());
 }
 
 void ApplicationController::setupConnections() {
     // Connect button events with proper cross-thread invocation
     connect(m_worker.data(), &I2CWorker::buttonEventsReceived,
-            this, [this](const QVector<uint8_t> &buttons) {
+            this, [this](const QVector<uint8_t> &buttons, const quint32 traceFlow, const qint64 decodedAtNs) {
+                Trace::FlowScope flow(traceFlow);
+                Trace::Span span("input", "buttonEventsReceived");
                 if (!m_powered_on) {
                     return;  // Ignore button events when powered off
                 }
                 for (const uint8_t buttonId : buttons) {
-                    handleButtonPress(buttonId);
+                    handleButtonPress(buttonId, decodedAtNs);
                 }
             });
 
     //send balance on init complete
     connect(m_worker.data(), &I2CWorker::initialization_complete,
             this, [this]() {
-                QMetaObject::invokeMethod(m_worker.data(), "updateUserBalance",
-                                          Qt::QueuedConnection,
-                                          Q_ARG(double, m_slotMachine->balance()));
+                m_worker->post(I2CCommand::updateBalance(m_slotMachine->balance()));
                 // Initialize button states
                 updateButtonStates();
+                defineLedAnimations();
             });
 
     // Update button highlights when risk mode changes
@@ -158,6 +459,24 @@ void ApplicationController::setupConnections() {
                 updateButtonStates();
             });
 
+    // Effects run on the boards themselves: one PLAY/STOP per event
+    // instead of streaming tower frames
+    connect(m_slotMachine.data(), &SlotMachine::jackpotWon,
+            this, [this]() {
+                if (m_powered_on) {
+                    m_worker->post(I2CCommand::playAnimation(LedAnimations::SLOT_JACKPOT));
+                }
+            });
+
+    connect(m_slotMachine.data(), &SlotMachine::riskAnimatingChanged,
+            this, [this]() {
+                if (m_slotMachine->riskAnimating() && m_powered_on) {
+                    m_worker->post(I2CCommand::playAnimation(LedAnimations::SLOT_RISK));
+                } else if (!m_slotMachine->riskAnimating()) {
+                    m_worker->post(I2CCommand::stopAnimation());
+                }
+            });
+
     // Connect healthcheck response
     connect(m_worker.data(), &I2CWorker::healthCheckComplete,
             this, &ApplicationController::handleHealthcheckResponse);
@@ -166,11 +485,21 @@ void ApplicationController::setupConnections() {
     connect(m_worker.data(), &I2CWorker::rawCommandResponse,
             this, &ApplicationController::handleRawCommandResponse);
 
+    // Track the worker's link state for the UI
+    connect(m_worker.data(), &I2CWorker::connectionStateChanged,
+            this, &ApplicationController::handleConnectionStateChanged);
+
+    // Bus counters are atomics owned by the worker; sample them from here
+    // instead of queueing a signal per transaction
+    connect(m_telemetryTimer.data(), &QTimer::timeout,
+            this, &ApplicationController::refreshI2CStats);
+    connect(m_telemetryTimer.data(), &QTimer::timeout,
+            this, &ApplicationController::refreshInputLatency);
+    m_telemetryTimer->start();
+
     connect(m_slotMachine.data(), &SlotMachine::balanceChanged,
             this, [this]() {
-                QMetaObject::invokeMethod(m_worker.data(), "updateUserBalance",
-                                          Qt::QueuedConnection,
-                                          Q_ARG(double, m_slotMachine->balance()));
+                m_worker->post(I2CCommand::updateBalance(m_slotMachine->balance()));
             });
 
     // Serial worker connections
@@ -187,9 +516,84 @@ void ApplicationController::setupConnections() {
             });
 }
 
+void ApplicationController::setupSerialEvents() {
+    // Records for SUBSCRIBE'd monitoring clients. Each handler checks the
+    // subscription first, so nothing is formatted while nobody listens.
+    using Event = SerialWorker::EventClass;
+    const auto money = [](const double amount) { return QString::number(amount, 'f', 2); };
+
+    connect(m_slotMachine.data(), &SlotMachine::spinComplete,
+            this, [this, money](const QString &result) {
+                if (m_serialWorker->isSubscribed(Event::Spin)) {
+                    publishSerialEvent(Event::Spin, QString("result=%1 balance=%2 prize=%3")
+                        .arg(result, money(m_slotMachine->balance()), money(m_slotMachine->currentPrize())));
+                }
+            });
+
+    connect(m_slotMachine.data(), &SlotMachine::balanceChanged,
+            this, [this, money]() {
+                if (m_serialWorker->isSubscribed(Event::Balance)) {
+                    publishSerialEvent(Event::Balance, "balance=" + money(m_slotMachine->balance()));
+                }
+            });
+
+    connect(m_slotMachine.data(), &SlotMachine::riskWon,
+            this, [this, money](const double newPrize) {
+                if (m_serialWorker->isSubscribed(Event::Risk)) {
+                    publishSerialEvent(Event::Risk, QString("outcome=won level=%1 prize=%2")
+                        .arg(m_slotMachine->riskLevel()).arg(money(newPrize)));
+                }
+            });
+
+    connect(m_slotMachine.data(), &SlotMachine::riskLost,
+            this, [this]() {
+                if (m_serialWorker->isSubscribed(Event::Risk)) {
+                    publishSerialEvent(Event::Risk, "outcome=lost");
+                }
+            });
+
+    connect(m_slotMachine.data(), &SlotMachine::riskCollected,
+            this, [this, money](const double amount) {
+                if (m_serialWorker->isSubscribed(Event::Risk)) {
+                    publishSerialEvent(Event::Risk, "outcome=collected prize=" + money(amount));
+                }
+            });
+
+    connect(this, &ApplicationController::poweredOnChanged,
+            this, [this]() {
+                if (m_serialWorker->isSubscribed(Event::Power)) {
+                    publishSerialEvent(Event::Power, m_powered_on ? "state=on" : "state=off");
+                }
+            });
+
+    connect(m_worker.data(), &I2CWorker::connectionStateChanged,
+            this, [this](const I2CWorker::ConnectionState state) {
+                if (m_serialWorker->isSubscribed(Event::I2CHealth)) {
+                    publishSerialEvent(Event::I2CHealth, "state=" + I2CWorker::connectionStateToString(state));
+                }
+            });
+
+    connect(m_worker.data(), &I2CWorker::deviceStateChanged,
+            this, [this](const uint8_t address, const I2CWorker::ConnectionState state) {
+                if (m_serialWorker->isSubscribed(Event::I2CHealth)) {
+                    publishSerialEvent(Event::I2CHealth, QString("device=0x%1 state=%2")
+                        .arg(address, 2, 16, QChar('0'))
+                        .arg(I2CWorker::connectionStateToString(state)));
+                }
+            });
+}
+
+void ApplicationController::publishSerialEvent(const SerialWorker::EventClass eventClass,
+                                               const QString &fields) const {
+    SerialWorker *worker = m_serialWorker.data();
+    QMetaObject::invokeMethod(worker, [worker, eventClass, fields]() {
+        worker->publishEvent(eventClass, fields);
+    }, Qt::QueuedConnection);
+}
+
 void ApplicationController::startHealthcheck() {
     // Use QMetaObject::invokeMethod for cross-thread call
-    connect(m_healthcheckTimer.data(), &QTimer::timeout,
+    connect(m_healthcheckTimer.data(), &ClockTimer::timeout,
             this, [this]() {
                 QMetaObject::invokeMethod(m_worker.data(), "sendHealthCheck",
                                           Qt::QueuedConnection);
@@ -197,6 +601,16 @@ void ApplicationController::startHealthcheck() {
     m_healthcheckTimer->start();
 }
 
+void ApplicationController::refreshI2CStats() {
+    m_i2c_stats = I2CTelemetry::toVariantList(m_worker->telemetry().snapshot());
+    emit i2cStatsChanged();
+}
+
+void ApplicationController::refreshInputLatency() {
+    m_input_latency_report = InputLatency::toVariantMap(m_input_latency.report());
+    emit inputLatencyChanged();
+}
+
 void ApplicationController::handleHealthcheckResponse(const bool success, const uint8_t status) {
     DebugLogger::instance().verbose(QString("Healthcheck response received. Success: %1, Status: 0x%2")
         .arg(success)
@@ -204,10 +618,15 @@ void ApplicationController::handleHealthcheckResponse(const bool success, const
 
     if (success && status == 0) {
         m_consecutiveFailures = 0;
+        m_healthcheckFailuresGauge.set(0);
         return;
     }
 
+    static MetricsRegistry::Counter &failures = MetricsRegistry::instance().counter(
+        "allesspitze_healthcheck_failures_total", "Failed I2C healthchecks");
+    failures.increment();
     m_consecutiveFailures++;
+    m_healthcheckFailuresGauge.set(m_consecutiveFailures);
     DebugLogger::instance().warning(
         QString("I2C Healthcheck failed. Status: 0x%1, Consecutive failures: %2")
         .arg(status, 2, 16, QChar('0'))
@@ -218,30 +637,32 @@ void ApplicationController::handleHealthcheckResponse(const bool success, const
         DebugLogger::instance().error(
             "Too many consecutive I2C failures. Attempting recovery..."
         );
-        m_healthcheckTimer->stop();
 
-        QMetaObject::invokeMethod(m_worker.data(), "cleanup",
-                                  Qt::QueuedConnection);
-
-        // Attempt reinitialization after delay
-        QTimer::singleShot(2000, this, [this]() {
-            QMetaObject::invokeMethod(m_worker.data(), "initialize",
-                                      Qt::QueuedConnection);
-
-            QTimer::singleShot(500, this, [this]() {
-                QMetaObject::invokeMethod(m_worker.data(), "openDevice",
-                                          Qt::QueuedConnection,
-                                          Q_ARG(uint8_t, 0x42));
-                m_consecutiveFailures = 0;
-                m_healthcheckTimer->start();
-            });
-        });
+        // The worker reopens the device on its own backoff schedule and
+        // stops answering healthchecks until INIT succeeds again
+        QMetaObject::invokeMethod(m_worker.data(), "requestRecovery",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QString, QString("Healthcheck failed %1 times")
+                                      .arg(m_consecutiveFailures)));
+        m_consecutiveFailures = 0;
+        m_healthcheckFailuresGauge.set(0);
     }
 }
 
+void ApplicationController::handleConnectionStateChanged(const I2CWorker::ConnectionState state) {
+    if (m_i2c_state == state) {
+        return;
+    }
+
+    m_i2c_state = state;
+    emit i2cStateChanged();
+}
+
 void ApplicationController::setupCleanup() {
-    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
         m_healthcheckTimer->stop();
+        // Shutdown blocks the loop on purpose
+        m_stallWatchdog->stop();
 
         QMetaObject::invokeMethod(m_worker.data(), "stopPolling",
                                   Qt::BlockingQueuedConnection);
@@ -256,6 +677,11 @@ void ApplicationController::setupCleanup() {
 
         m_serialThread->quit();
         m_serialThread->wait();
+
+        m_logThread->quit();
+        m_logThread->wait();
+
+        FlightRecorder::instance().record(FlightRecorder::Type::SessionEnd, 0);
     });
 }
 
@@ -304,21 +730,27 @@ void ApplicationController::loadBalance() const {
     }
 }
 
-void ApplicationController::handleButtonPress(uint8_t buttonId) {
+void ApplicationController::handleButtonPress(uint8_t buttonId, const qint64 decodedAtNs) {
+    FlightRecorder::instance().record(FlightRecorder::Type::Button, buttonId, m_powered_on);
     if (!m_powered_on) {
         return;  // Ignore button presses when powered off
     }
 
+    Trace::Span span("input", "handleButtonPress");
+    span.setArg("button", buttonId);
+
     DebugLogger::instance().info(QString("Button %1 pressed").arg(buttonId));
 
     if (m_slotMachine->riskModeActive()) {
         // Risk mode active
         if (buttonId == 0) {
             // Button 0: Risk Higher (if not animating)
-            if (!m_slotMachine->riskAnimating()) {
+            const bool wasAnimating = m_slotMachine->riskAnimating();
+            if (!wasAnimating) {
                 m_slotMachine->riskHigher();
                 DebugLogger::instance().info("Risk Higher triggered by button 0");
             }
+            notePressOutcome(!wasAnimating && m_slotMachine->riskAnimating(), decodedAtNs);
         } else if (buttonId == 1) {
             // Button 1: Collect Prize (if not animating)
             if (!m_slotMachine->riskAnimating()) {
@@ -330,10 +762,12 @@ void ApplicationController::handleButtonPress(uint8_t buttonId) {
         // Normal slot machine mode
         if (buttonId == 0) {
             // Button 0: Spin
+            const bool wasSpinning = m_slotMachine->isSpinning();
             if (m_slotMachine->canSpin()) {
                 m_slotMachine->spin();
                 DebugLogger::instance().info("Spin triggered by button 0");
             }
+            notePressOutcome(!wasSpinning && m_slotMachine->isSpinning(), decodedAtNs);
         } else if (buttonId == 1) {
             // Button 1: Cashout
             if (m_slotMachine->currentPrize() > 0) {
@@ -344,22 +778,40 @@ void ApplicationController::handleButtonPress(uint8_t buttonId) {
     }
 
     // Update button states after action
-    QTimer::singleShot(100, this, [this]() {
+    ClockTimer::singleShot(100, this, [this]() {
         updateButtonStates();
     });
 }
 
+void ApplicationController::notePressOutcome(const bool animationStarted, const qint64 decodedAtNs) {
+    // A press while the previous spin or risk step is still running does
+    // nothing visible either; both count as ignored. animationStarted must
+    // mean this press started it, not that an animation is running. Without frames there
+    // is no press-to-frame latency to measure.
+    if (animationStarted && decodedAtNs > 0 && !m_headless) {
+        m_input_latency.pressAccepted(decodedAtNs);
+    } else if (!animationStarted) {
+        m_input_latency.pressIgnored();
+    }
+}
+
+void ApplicationController::defineLedAnimations() const {
+    // Uploaded once; the worker's shadow re-sends them after every INIT
+    QMetaObject::invokeMethod(m_worker.data(), "defineAnimation",
+                              Qt::QueuedConnection,
+                              Q_ARG(uint8_t, LedAnimations::SLOT_JACKPOT),
+                              Q_ARG(LedAnimation, LedAnimations::jackpot()));
+    QMetaObject::invokeMethod(m_worker.data(), "defineAnimation",
+                              Qt::QueuedConnection,
+                              Q_ARG(uint8_t, LedAnimations::SLOT_RISK),
+                              Q_ARG(LedAnimation, LedAnimations::riskSweep()));
+}
+
 void ApplicationController::updateButtonStates() const {
     if (!m_powered_on) {
         // Power off - disable all buttons
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 0),
-                                  Q_ARG(bool, false));
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 1),
-                                  Q_ARG(bool, false));
+        m_worker->post(I2CCommand::highlightButton(0, false));
+        m_worker->post(I2CCommand::highlightButton(1, false));
         return;
     }
 
@@ -369,16 +821,10 @@ void ApplicationController::updateButtonStates() const {
         const bool canCollect = !m_slotMachine->riskAnimating();
 
         // Button 0: Risk Higher (orange/active when can risk)
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 0),
-                                  Q_ARG(bool, canRisk));
+        m_worker->post(I2CCommand::highlightButton(0, canRisk));
 
         // Button 1: Collect Prize (green/active when can collect)
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 1),
-                                  Q_ARG(bool, canCollect));
+        m_worker->post(I2CCommand::highlightButton(1, canCollect));
 
         DebugLogger::instance().verbose(QString("Risk mode buttons updated: Risk=%1, Collect=%2")
             .arg(canRisk).arg(canCollect));
@@ -388,16 +834,10 @@ void ApplicationController::updateButtonStates() const {
         const bool canCashout = m_slotMachine->currentPrize() > 0 && !m_slotMachine->isSpinning() && m_slotMachine->canSpin();
 
         // Button 0: Spin (active when can spin)
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 0),
-                                  Q_ARG(bool, canSpin));
+        m_worker->post(I2CCommand::highlightButton(0, canSpin));
 
         // Button 1: Cashout (active when has prize)
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 1),
-                                  Q_ARG(bool, canCashout));
+        m_worker->post(I2CCommand::highlightButton(1, canCashout));
 
         DebugLogger::instance().verbose(QString("Slot mode buttons updated: Spin=%1, Cashout=%2")
             .arg(canSpin).arg(canCashout));
@@ -410,6 +850,7 @@ void ApplicationController::setPowerOn(bool on) {
     }
 
     m_powered_on = on;
+    FlightRecorder::instance().record(FlightRecorder::Type::Power, on ? 1 : 0);
     DebugLogger::instance().info(QString("Power state changed to: %1").arg(on ? "ON" : "OFF"));
 
     applyPowerState();
@@ -423,49 +864,38 @@ void ApplicationController::applyPowerState() {
 
         // Turn off all tower LEDs first
         for (int t = 0; t < 3; t++) {
-            QMetaObject::invokeMethod(m_worker.data(), "highlightTower",
-                                      Qt::QueuedConnection,
-                                      Q_ARG(uint8_t, t),
-                                      Q_ARG(uint8_t, 0));
+            m_worker->post(I2CCommand::highlightTower(static_cast<uint8_t>(t), 0));
         }
 
         // Update button states based on current game state
         updateButtonStates();
 
         // Update balance on display
-        QMetaObject::invokeMethod(m_worker.data(), "updateUserBalance",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(double, m_slotMachine->balance()));
+        m_worker->post(I2CCommand::updateBalance(m_slotMachine->balance()));
     } else {
         // Power OFF
         DebugLogger::instance().info("Applying POWER OFF state");
 
+        // A running effect would keep the LEDs lit
+        m_worker->post(I2CCommand::stopAnimation());
+
         // Turn off all buttons
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 0),
-                                  Q_ARG(bool, false));
-        QMetaObject::invokeMethod(m_worker.data(), "highlightButton",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(uint8_t, 1),
-                                  Q_ARG(bool, false));
+        m_worker->post(I2CCommand::highlightButton(0, false));
+        m_worker->post(I2CCommand::highlightButton(1, false));
 
         // Turn off all tower LEDs
         for (int t = 0; t < 3; t++) {
-            QMetaObject::invokeMethod(m_worker.data(), "highlightTower",
-                                      Qt::QueuedConnection,
-                                      Q_ARG(uint8_t, t),
-                                      Q_ARG(uint8_t, 0));
+            m_worker->post(I2CCommand::highlightTower(static_cast<uint8_t>(t), 0));
         }
 
         // Clear display (set balance to 0 or send blank)
-        QMetaObject::invokeMethod(m_worker.data(), "updateUserBalance",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(double, 0.0));
+        m_worker->post(I2CCommand::updateBalance(0.0));
     }
 }
 
 void ApplicationController::handleSerialCommand(SerialWorker::Command cmd, const QVariantMap &params) {
+    FlightRecorder::instance().record(FlightRecorder::Type::SerialCommand, static_cast<uint8_t>(cmd), 0, 0,
+                                      QMetaEnum::fromType<SerialWorker::Command>().valueToKey(static_cast<int>(cmd)));
     switch (cmd) {
         case SerialWorker::Command::PowerOn:
             DebugLogger::instance().info("Serial: POWER_ON command received");
@@ -490,25 +920,36 @@ void ApplicationController::handleSerialCommand(SerialWorker::Command cmd, const
             if (params.contains("probabilities")) {
                 const QVariantMap probMap = params["probabilities"].toMap();
                 DebugLogger::instance().info(QString("Serial: SET_PROBABILITIES command received"));
-
-                // Find the reel in QML and update probabilities
-                if (m_engine && !m_engine->rootObjects().isEmpty()) {
-                    QObject *root = m_engine->rootObjects().first();
-                    QObject *reel = root->findChild<QObject*>("mainReel");
-                    if (reel) {
-                        QMetaObject::invokeMethod(reel, "set_probabilities",
-                                                  Q_ARG(QVariantMap, probMap));
-                        DebugLogger::instance().info("Probabilities updated on reel");
-                    } else {
-                        DebugLogger::instance().warning("Could not find reel object");
-                    }
-                }
+                m_slotMachine->setProbabilities(probMap);
             }
             break;
 
         case SerialWorker::Command::GetStatus:
             DebugLogger::instance().verbose("Serial: STATUS command received");
-            sendSerialStatus();
+            sendSerialStatus(params.value("requestId", -1).toInt());
+            break;
+
+        case SerialWorker::Command::GetI2CStats:
+            DebugLogger::instance().verbose("Serial: I2C_STATS command received");
+            sendSerialI2CStats();
+            break;
+
+        case SerialWorker::Command::GetLatency:
+            DebugLogger::instance().verbose("Serial: LATENCY command received");
+            QMetaObject::invokeMethod(m_serialWorker.data(), "sendResponse",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(QString, InputLatency::formatReport(m_input_latency.report())));
+            break;
+
+        case SerialWorker::Command::GetMetrics:
+            DebugLogger::instance().verbose("Serial: METRICS command received");
+            QMetaObject::invokeMethod(m_serialWorker.data(), "sendResponse",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(QString, QString::fromUtf8(MetricsRegistry::instance().exposition())));
+            break;
+
+        case SerialWorker::Command::Trace:
+            handleSerialTraceCommand(params.value("action").toString());
             break;
 
         default:
@@ -517,29 +958,69 @@ void ApplicationController::handleSerialCommand(SerialWorker::Command cmd, const
     }
 }
 
-void ApplicationController::sendSerialStatus() const {
-    QString status = QString(
-        "=== AllesSpitze Status ===\n"
-        "Power: %1\n"
-        "Balance: %2\n"
-        "Bet: %3\n"
-        "Current Prize: %4\n"
-        "Session Active: %5\n"
-        "Risk Mode: %6\n"
-        "Risk Level: %7\n"
-        "Risk Prize: %8\n"
-        "==========================\n"
-    ).arg(m_powered_on ? "ON" : "OFF")
-     .arg(m_slotMachine->balance())
-     .arg(m_slotMachine->bet())
-     .arg(m_slotMachine->currentPrize())
-     .arg(m_slotMachine->sessionActive() ? "YES" : "NO")
-     .arg(m_slotMachine->riskModeActive() ? "YES" : "NO")
-     .arg(m_slotMachine->riskLevel())
-     .arg(m_slotMachine->riskPrize());
-
-    // Send via serial worker - use a direct call with the captured status
+void ApplicationController::sendSerialStatus(const int requestId) const {
+    SerialWorker::StatusReport report;
+    report.poweredOn = m_powered_on;
+    report.balance = m_slotMachine->balance();
+    report.bet = m_slotMachine->bet();
+    report.currentPrize = m_slotMachine->currentPrize();
+    report.sessionActive = m_slotMachine->sessionActive();
+    report.riskModeActive = m_slotMachine->riskModeActive();
+    report.riskLevel = m_slotMachine->riskLevel();
+    report.riskPrize = m_slotMachine->riskPrize();
+
+    // Formatted on the serial thread, as text or as a binary reply
+    SerialWorker *worker = m_serialWorker.data();
+    QMetaObject::invokeMethod(worker, [worker, requestId, report]() {
+        worker->sendStatusReport(requestId, report);
+    }, Qt::QueuedConnection);
+}
+
+void ApplicationController::sendSerialI2CStats() const {
+    const QString report = I2CTelemetry::formatReport(m_worker->telemetry().snapshot());
+
     QMetaObject::invokeMethod(m_serialWorker.data(), "sendResponse",
                               Qt::QueuedConnection,
-                              Q_ARG(QString, status));
+                              Q_ARG(QString, report));
+}
+
+void ApplicationController::handleSerialTraceCommand(const QString &action) {
+    QString response;
+    if (action == "on" || action == "off") {
+        setTracing(action == "on");
+        response = QString("OK: Tracing %1\n").arg(action);
+    } else if (action == "dump") {
+        response = dumpTrace() + "\n";
+    } else {
+        response = QString("OK: Tracing is %1\n").arg(tracing() ? "on" : "off");
+    }
+
+    QMetaObject::invokeMethod(m_serialWorker.data(), "sendResponse",
+                              Qt::QueuedConnection,
+                              Q_ARG(QString, response));
+}
+
+void ApplicationController::setTracing(const bool on) {
+    if (Trace::enabled() == on) {
+        return;
+    }
+
+    Trace::setEnabled(on);
+    DebugLogger::instance().info(QString("Tracing %1").arg(on ? "enabled" : "disabled"));
+    emit tracingChanged();
+}
+
+QString ApplicationController::dumpTrace() const {
+    const QString path = Trace::defaultDumpPath();
+    Trace::DumpResult result;
+    QString error;
+    if (!Trace::dumpChromeJson(path, result, error)) {
+        DebugLogger::instance().error("Trace dump failed: " + error);
+        return "ERROR: " + error;
+    }
+
+    const QString message = QString("OK: Trace written to %1 (%2 events, %3 threads)")
+        .arg(path).arg(result.events).arg(result.threads);
+    DebugLogger::instance().info(message);
+    return message;
 }
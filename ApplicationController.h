@@ -5,22 +5,36 @@
 #include <QQmlApplicationEngine>
 #include <QTimer>
 #include <QVariantList>
+#include "Clock.h"
+#include "HeadlessReel.h"
 #include "I2CWorker.h"
+#include "InputLatency.h"
+#include "LogArchiver.h"
+#include "MetricsRegistry.h"
 #include "SlotMachine.h"
 #include "SerialWorker.h"
+#include "StallWatchdog.h"
+#include "StartupPipeline.h"
+#include "Trace.h"
 
 class ApplicationController : public QObject {
     Q_OBJECT
     Q_PROPERTY(bool poweredOn READ poweredOn NOTIFY poweredOnChanged)
+    Q_PROPERTY(QString i2cState READ i2cState NOTIFY i2cStateChanged)
+    Q_PROPERTY(QVariantList i2cStats READ i2cStats NOTIFY i2cStatsChanged)
+    Q_PROPERTY(bool tracing READ tracing NOTIFY tracingChanged)
+    Q_PROPERTY(QVariantMap inputLatency READ inputLatency NOTIFY inputLatencyChanged)
 
 public:
-    explicit ApplicationController(QObject *parent = nullptr);
+    // headless: no QML engine; the game runs on the cabinet hardware alone
+    // with HeadlessReel (needs only a QCoreApplication)
+    explicit ApplicationController(bool headless = false, QObject *parent = nullptr);
 
     ~ApplicationController() override;
 
     void initialize();
 
-    [[nodiscard]] bool start() const;
+    [[nodiscard]] bool start();
 
     // Debug interface - callable from QML
     Q_INVOKABLE void sendRawI2CCommand(int command, const QVariantList &data) const;
@@ -29,10 +43,28 @@ public:
     Q_INVOKABLE void setPowerOn(bool on);
     [[nodiscard]] bool poweredOn() const { return m_powered_on; }
 
+    [[nodiscard]] QString i2cState() const { return I2CWorker::connectionStateToString(m_i2c_state); }
+
+    // Per-opcode bus counters, refreshed once per second
+    [[nodiscard]] QVariantList i2cStats() const { return m_i2c_stats; }
+
+    // Button-to-frame percentiles (see InputLatency), refreshed once per second
+    [[nodiscard]] QVariantMap inputLatency() const { return m_input_latency_report; }
+
+    // Cross-thread tracing (see Trace.h)
+    Q_INVOKABLE void setTracing(bool on);
+    [[nodiscard]] bool tracing() const { return Trace::enabled(); }
+    // Writes the trace to the app data directory; returns a status line
+    Q_INVOKABLE QString dumpTrace() const;
+
 signals:
     // Signal to forward response to QML
     void i2cCommandResponse(int command, bool success, const QVariantList &response);
     void poweredOnChanged();
+    void i2cStateChanged();
+    void i2cStatsChanged();
+    void tracingChanged();
+    void inputLatencyChanged();
 
 private:
     void setupQmlEngine() const;
@@ -47,34 +79,81 @@ private:
 
     void setupCleanup();
 
+    void setupTracing();
+
+    void setupFlightRecorder();
+
+    void setupLogArchiver();
+
+    void setupMetrics();
+
+    void setupStallWatchdog();
+
+    void setupStartup();
+
+    void writeMetricsFile() const;
+
     void startHealthcheck();
 
+    void refreshI2CStats();
+
+    void refreshInputLatency();
+
+    void setupFrameTiming();
+
     void loadBalance() const;
 
     void handleHealthcheckResponse(bool success, uint8_t status);
 
     void handleRawCommandResponse(uint8_t command, bool success, const QByteArray &response);
 
+    void handleConnectionStateChanged(I2CWorker::ConnectionState state);
+
     // Button handling
-    void handleButtonPress(uint8_t buttonId);
+    void handleButtonPress(uint8_t buttonId, qint64 decodedAtNs);
+    void notePressOutcome(bool animationStarted, qint64 decodedAtNs);
     void updateButtonStates() const;
 
+    void defineLedAnimations() const;
+
     // Serial command handling
     void handleSerialCommand(SerialWorker::Command cmd, const QVariantMap &params);
-    void sendSerialStatus() const;
+    void sendSerialStatus(int requestId) const;
+    void sendSerialI2CStats() const;
+    void setupSerialEvents();
+    void publishSerialEvent(SerialWorker::EventClass eventClass, const QString &fields) const;
+    void handleSerialTraceCommand(const QString &action);
 
     // Power state management
     void applyPowerState();
 
 private:
-    QScopedPointer<QQmlApplicationEngine> m_engine;
+    bool m_headless;
+    QScopedPointer<QQmlApplicationEngine> m_engine;  // Null when headless
     QScopedPointer<QThread> m_workerThread;
     QScopedPointer<I2CWorker> m_worker;
     QScopedPointer<QThread> m_serialThread;
     QScopedPointer<SerialWorker> m_serialWorker;
+    QScopedPointer<QThread> m_logThread;
+    QScopedPointer<LogArchiver> m_logArchiver;
     QScopedPointer<SlotMachine> m_slotMachine;
-    QScopedPointer<QTimer> m_healthcheckTimer;
+    QScopedPointer<HeadlessReel> m_headlessReel;
+    QScopedPointer<ClockTimer> m_healthcheckTimer;
+    QScopedPointer<QTimer> m_telemetryTimer;
+    QScopedPointer<QTimer> m_metricsTimer;
+    QScopedPointer<StallWatchdog> m_stallWatchdog;
+    QScopedPointer<StartupPipeline> m_startup;
+    QString m_metrics_path;
+    MetricsRegistry::Gauge &m_healthcheckFailuresGauge;
     int m_consecutiveFailures{0};
     bool m_powered_on{true};  // Default to powered on
+    I2CWorker::ConnectionState m_i2c_state{I2CWorker::ConnectionState::Closed};
+    QVariantList m_i2c_stats;
+    InputLatency m_input_latency;
+    QVariantMap m_input_latency_report;
     static constexpr int MAX_CONSECUTIVE_FAILURES = 3;
+    // node_exporter reads the textfile on every scrape; 15 s matches its default interval
+    static constexpr int METRICS_INTERVAL_MS = 15000;
+    // Without a board answering INIT by then the game starts anyway
+    static constexpr int I2C_LINK_TIMEOUT_MS = 3000;
 };
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "Clock.h"
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+namespace {
+    std::unique_ptr<Clock> &installedClock() {
+        static std::unique_ptr<Clock> clock = std::make_unique<RealClock>();
+        return clock;
+    }
+
+    std::atomic<Clock *> currentClock{nullptr};
+}
+
+Clock &Clock::instance() {
+    if (Clock *clock = currentClock.load(std::memory_order_acquire)) {
+        return *clock;
+    }
+
+    Clock *clock = installedClock().get();
+    currentClock.store(clock, std::memory_order_release);
+    return *clock;
+}
+
+void Clock::install(std::unique_ptr<Clock> clock) {
+    currentClock.store(clock.get(), std::memory_order_release);
+    installedClock() = std::move(clock);
+}
+
+int64_t RealClock::nowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RealClock::sleepMs(const int ms) {
+    if (ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+int64_t SimulatedClock::nowNs() const {
+    std::lock_guard lock(m_mutex);
+    return m_now_ns;
+}
+
+void SimulatedClock::sleepMs(const int ms) {
+    std::lock_guard lock(m_mutex);
+    m_now_ns += static_cast<int64_t>(std::max(ms, 0)) * 1'000'000;
+}
+
+uint64_t SimulatedClock::advance(const int64_t ms) {
+    int64_t target;
+    {
+        std::lock_guard lock(m_mutex);
+        target = m_now_ns + ms * 1'000'000;
+    }
+
+    uint64_t fired = 0;
+    while (fireNext(target)) {
+        ++fired;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_now_ns = std::max(m_now_ns, target);
+    return fired;
+}
+
+bool SimulatedClock::advanceToNext() {
+    return fireNext(std::numeric_limits<int64_t>::max());
+}
+
+std::optional<int64_t> SimulatedClock::nextDueNs() const {
+    std::lock_guard lock(m_mutex);
+    if (m_queue.empty()) {
+        return std::nullopt;
+    }
+    return m_queue.begin()->first.first;
+}
+
+SimulatedClock *SimulatedClock::current() {
+    return dynamic_cast<SimulatedClock *>(&Clock::instance());
+}
+
+void SimulatedClock::schedule(ClockTimer *timer, const int64_t dueNs) {
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_scheduled.find(timer); it != m_scheduled.end()) {
+        m_queue.erase(it->second);
+        m_scheduled.erase(it);
+    }
+
+    const Key key{dueNs, m_sequence++};
+    m_queue.emplace(key, timer);
+    m_scheduled.emplace(timer, key);
+}
+
+void SimulatedClock::cancel(ClockTimer *timer) {
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_scheduled.find(timer); it != m_scheduled.end()) {
+        m_queue.erase(it->second);
+        m_scheduled.erase(it);
+    }
+}
+
+std::optional<int64_t> SimulatedClock::dueNs(const ClockTimer *timer) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_scheduled.find(timer);
+    if (it == m_scheduled.end()) {
+        return std::nullopt;
+    }
+    return it->second.first;
+}
+
+bool SimulatedClock::fireNext(const int64_t limitNs) {
+    ClockTimer *timer;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_queue.empty() || m_queue.begin()->first.first > limitNs) {
+            return false;
+        }
+
+        const auto it = m_queue.begin();
+        timer = it->second;
+        m_now_ns = std::max(m_now_ns, it->first.first);
+        m_scheduled.erase(timer);
+        m_queue.erase(it);
+    }
+
+    Q_ASSERT(timer->thread() == QThread::currentThread());
+    timer->expire();
+    return true;
+}
+
+ClockTimer::ClockTimer(QObject *parent)
+    : QObject(parent)
+      , m_simulated(SimulatedClock::current()) {
+    if (!m_simulated) {
+        m_timer = new QTimer(this);
+        connect(m_timer, &QTimer::timeout, this, &ClockTimer::timeout);
+    }
+}
+
+ClockTimer::~ClockTimer() {
+    if (m_simulated) {
+        m_simulated->cancel(this);
+    }
+}
+
+void ClockTimer::setInterval(const int ms) {
+    m_interval_ms = ms;
+    if (m_timer) {
+        m_timer->setInterval(ms);
+    } else if (m_active) {
+        start(); // QTimer restarts an active timer too
+    }
+}
+
+void ClockTimer::setSingleShot(const bool singleShot) {
+    m_single_shot = singleShot;
+    if (m_timer) {
+        m_timer->setSingleShot(singleShot);
+    }
+}
+
+bool ClockTimer::isActive() const {
+    return m_timer ? m_timer->isActive() : m_active;
+}
+
+int ClockTimer::remainingTime() const {
+    if (m_timer) {
+        return m_timer->remainingTime();
+    }
+
+    const auto due = m_active ? m_simulated->dueNs(this) : std::nullopt;
+    if (!due) {
+        return -1;
+    }
+    return static_cast<int>(std::max<int64_t>(*due - m_simulated->nowNs(), 0) / 1'000'000);
+}
+
+void ClockTimer::start() {
+    if (m_timer) {
+        m_timer->start();
+        return;
+    }
+
+    m_active = true;
+    m_simulated->schedule(this, m_simulated->nowNs() + static_cast<int64_t>(std::max(m_interval_ms, 1)) * 1'000'000);
+}
+
+void ClockTimer::start(const int ms) {
+    m_interval_ms = ms;
+    if (m_timer) {
+        m_timer->start(ms);
+        return;
+    }
+    start();
+}
+
+void ClockTimer::stop() {
+    if (m_timer) {
+        m_timer->stop();
+        return;
+    }
+
+    m_active = false;
+    m_simulated->cancel(this);
+}
+
+void ClockTimer::expire() {
+    if (!m_active) {
+        return;
+    }
+
+    // Rescheduled before the slots run so they can stop or restart it
+    if (m_single_shot) {
+        m_active = false;
+    } else {
+        start();
+    }
+    emit timeout();
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+class ClockTimer;
+
+// Time source for game and hardware behaviour: timers, timeouts and the
+// waits of the I2C protocol. The process clock is RealClock (steady_clock
+// and QTimer). Installing a SimulatedClock before any component is created
+// makes that behaviour run on virtual time instead, so hours of cabinet
+// operation, I2C recovery included, can be driven in seconds.
+//
+// Measurements (telemetry, tracing, input latency) stay on steady_clock:
+// they describe the host, not the game.
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    static Clock &instance();
+
+    // Replaces the process clock. Only before the first ClockTimer or
+    // nowNs() call; the previous clock must not be in use any more.
+    static void install(std::unique_ptr<Clock> clock);
+
+    // Monotonic, arbitrary epoch
+    [[nodiscard]] virtual int64_t nowNs() const = 0;
+
+    [[nodiscard]] int64_t nowMs() const { return nowNs() / 1'000'000; }
+
+    // Blocks the calling thread; a simulated clock only moves time forward
+    virtual void sleepMs(int ms) = 0;
+
+    [[nodiscard]] virtual bool isSimulated() const { return false; }
+};
+
+class RealClock final : public Clock {
+public:
+    [[nodiscard]] int64_t nowNs() const override;
+
+    void sleepMs(int ms) override;
+};
+
+// Virtual time that only moves when told to. advance() fires every timer
+// that falls due, in order, directly from the calling thread, so the
+// simulation is deterministic. Every timer must therefore live on that
+// thread: simulations keep the workers there instead of starting their
+// QThreads. Queued work a slot posts runs once the caller processes
+// events, e.g. QCoreApplication::processEvents() between advances.
+//
+// sleepMs() moves time forward without firing anything: a sleeping thread
+// could not have run its timers either.
+class SimulatedClock final : public Clock {
+public:
+    explicit SimulatedClock(int64_t startNs = 0) : m_now_ns(startNs) {}
+
+    [[nodiscard]] int64_t nowNs() const override;
+
+    void sleepMs(int ms) override;
+
+    [[nodiscard]] bool isSimulated() const override { return true; }
+
+    // Returns the number of timeouts delivered
+    uint64_t advance(int64_t ms);
+
+    // Fires the earliest timer, moving time to it; false if none is active
+    bool advanceToNext();
+
+    [[nodiscard]] std::optional<int64_t> nextDueNs() const;
+
+    // Installed as the process clock, or nullptr
+    static SimulatedClock *current();
+
+private:
+    friend class ClockTimer;
+
+    using Key = std::pair<int64_t, uint64_t>; // Due time, then FIFO among equals
+
+    void schedule(ClockTimer *timer, int64_t dueNs);
+
+    void cancel(ClockTimer *timer);
+
+    [[nodiscard]] std::optional<int64_t> dueNs(const ClockTimer *timer) const;
+
+    // Fires the earliest timer due by limitNs
+    bool fireNext(int64_t limitNs);
+
+    mutable std::mutex m_mutex;
+    int64_t m_now_ns;
+    uint64_t m_sequence = 0;
+    std::map<Key, ClockTimer *> m_queue;
+    std::map<const ClockTimer *, Key> m_scheduled;
+};
+
+// QTimer's interface on top of Clock: a QTimer under RealClock, an entry
+// in the simulated queue under SimulatedClock. A zero interval fires on
+// the next event loop pass in real time and after 1 ms of virtual time.
+class ClockTimer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClockTimer(QObject *parent = nullptr);
+
+    ~ClockTimer() override;
+
+    void setInterval(int ms);
+
+    [[nodiscard]] int interval() const { return m_interval_ms; }
+
+    void setSingleShot(bool singleShot);
+
+    [[nodiscard]] bool isSingleShot() const { return m_single_shot; }
+
+    [[nodiscard]] bool isActive() const;
+
+    // Milliseconds until the next timeout, -1 if inactive
+    [[nodiscard]] int remainingTime() const;
+
+    // Like QTimer::singleShot: functor runs on context's thread unless
+    // context is destroyed first
+    template<typename Functor>
+    static void singleShot(const int ms, QObject *context, Functor functor) {
+        if (!SimulatedClock::current()) {
+            QTimer::singleShot(ms, context, std::move(functor));
+            return;
+        }
+
+        auto *timer = new ClockTimer(context);
+        timer->setSingleShot(true);
+        connect(timer, &ClockTimer::timeout, context, [timer, functor = std::move(functor)]() mutable {
+            timer->deleteLater();
+            functor();
+        });
+        timer->start(ms);
+    }
+
+public slots:
+    void start();
+
+    void start(int ms);
+
+    void stop();
+
+signals:
+    void timeout();
+
+private:
+    friend class SimulatedClock;
+
+    // Called by SimulatedClock when the timer falls due
+    void expire();
+
+    QTimer *m_timer = nullptr;               // Real time
+    SimulatedClock *m_simulated = nullptr;   // Virtual time
+    int m_interval_ms = 0;
+    bool m_single_shot = false;
+    bool m_active = false;                   // Virtual time only
+};
@@ -0,0 +1,103 @@
+#include "DataReadySource.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/gpio.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+
+// GPIO character device
+
+GpioDataReadySource::GpioDataReadySource(const int fd, QString description)
+    : m_fd(fd), m_description(std::move(description)) {
+}
+
+GpioDataReadySource::~GpioDataReadySource() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+std::unique_ptr<GpioDataReadySource> GpioDataReadySource::open(const QString &spec, QString &error) {
+    const int separator = spec.lastIndexOf(':');
+    bool ok = false;
+    const unsigned line = separator > 0 ? spec.mid(separator + 1).toUInt(&ok) : 0;
+    if (!ok) {
+        error = QString("Invalid data-ready GPIO '%1' (expected <chip>:<line>)").arg(spec);
+        return nullptr;
+    }
+
+    QString chipPath = spec.left(separator);
+    if (!chipPath.startsWith('/')) {
+        chipPath.prepend("/dev/");
+    }
+
+    const int chipFd = ::open(chipPath.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (chipFd < 0) {
+        error = QString("Failed to open %1: %2").arg(chipPath, strerror(errno));
+        return nullptr;
+    }
+
+    gpio_v2_line_request request{};
+    request.offsets[0] = line;
+    request.num_lines = 1;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT |
+                           GPIO_V2_LINE_FLAG_EDGE_FALLING |
+                           GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+    std::strncpy(request.consumer, "AllesSpitzeQt", sizeof(request.consumer) - 1);
+
+    const int result = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request);
+    const int savedErrno = errno;
+    close(chipFd);
+
+    if (result < 0) {
+        error = QString("Failed to request %1 line %2: %3")
+                .arg(chipPath)
+                .arg(line)
+                .arg(strerror(savedErrno));
+        return nullptr;
+    }
+
+    fcntl(request.fd, F_SETFL, fcntl(request.fd, F_GETFL) | O_NONBLOCK);
+
+    return std::unique_ptr<GpioDataReadySource>(new GpioDataReadySource(
+        request.fd, QString("%1 line %2 (falling edge)").arg(chipPath).arg(line)));
+}
+
+int GpioDataReadySource::acknowledge() {
+    gpio_v2_line_event events[16];
+    int drained = 0;
+
+    ssize_t bytesRead;
+    while ((bytesRead = read(m_fd, events, sizeof(events))) > 0) {
+        drained += static_cast<int>(bytesRead / static_cast<ssize_t>(sizeof(gpio_v2_line_event)));
+    }
+
+    return drained;
+}
+
+// Fake source
+
+FakeDataReadySource::FakeDataReadySource()
+    : m_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+}
+
+FakeDataReadySource::~FakeDataReadySource() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void FakeDataReadySource::trigger() const {
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(m_fd, &one, sizeof(one));
+}
+
+int FakeDataReadySource::acknowledge() {
+    uint64_t count = 0;
+    if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+    return static_cast<int>(count);
+}
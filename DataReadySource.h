@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QString>
+#include <memory>
+
+// A pollable "device has input pending" signal. I2CWorker watches fd() with
+// a QSocketNotifier and polls the device only after it becomes readable.
+class DataReadySource {
+public:
+    virtual ~DataReadySource() = default;
+
+    [[nodiscard]] virtual int fd() const = 0;
+
+    // Consume the pending notifications after fd() became readable.
+    // Returns the number of notifications drained.
+    virtual int acknowledge() = 0;
+
+    [[nodiscard]] virtual QString description() const = 0;
+};
+
+// Falling edge on a GPIO line via the Linux GPIO character device (v2 uAPI).
+// The Arduino pulls the line low whenever it has button events queued.
+class GpioDataReadySource final : public DataReadySource {
+public:
+    ~GpioDataReadySource() override;
+
+    // spec is "<chip>:<line>", e.g. "gpiochip0:17" or "/dev/gpiochip0:17"
+    static std::unique_ptr<GpioDataReadySource> open(const QString &spec, QString &error);
+
+    [[nodiscard]] int fd() const override { return m_fd; }
+
+    int acknowledge() override;
+
+    [[nodiscard]] QString description() const override { return m_description; }
+
+private:
+    GpioDataReadySource(int fd, QString description);
+
+    int m_fd = -1;
+    QString m_description;
+};
+
+// In-process source backed by an eventfd, for the simulator and tests.
+// trigger() may be called from any thread.
+class FakeDataReadySource final : public DataReadySource {
+public:
+    FakeDataReadySource();
+
+    ~FakeDataReadySource() override;
+
+    void trigger() const;
+
+    [[nodiscard]] int fd() const override { return m_fd; }
+
+    int acknowledge() override;
+
+    [[nodiscard]] QString description() const override { return "fake (eventfd)"; }
+
+private:
+    int m_fd = -1;
+};
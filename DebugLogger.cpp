@@ -15,6 +15,7 @@ DebugLogger::DebugLogger(QObject *parent) : QObject(parent) {
 }
 
 DebugLogger::~DebugLogger() {
+    std::lock_guard lock(m_file_mutex);
     if (m_logFile.isOpen()) {
         m_logFile.close();
     }
@@ -33,40 +34,101 @@ void DebugLogger::setVerbosity(LogVerbosity verbosity) {
 }
 
 void DebugLogger::openLogFile() {
-    QString logDir = QStandardPaths::writableLocation(
+    m_log_directory = QStandardPaths::writableLocation(
         QStandardPaths::AppDataLocation
     );
 
-    QDir().mkpath(logDir);
+    QDir().mkpath(m_log_directory);
 
-    QString timestamp = QDateTime::currentDateTime()
+    m_session_stamp = QDateTime::currentDateTime()
         .toString("yyyy-MM-dd_HH-mm-ss");
-    QString logFileName = QString("%1/debug_%2.log")
-        .arg(logDir)
-        .arg(timestamp);
+    m_segment = 0;
 
-    m_logFile.setFileName(logFileName);
-    if (m_logFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QString openMsg = QString("Log file opened: %1").arg(logFileName);
+    if (openSegment()) {
+        QString openMsg = QString("Log file opened: %1").arg(m_logFile.fileName());
         logMessage(openMsg, LogLevel::Debug);
         qDebug() << openMsg;
-    } else {
+    }
+}
+
+// debug_<session>.log, then debug_<session>.1.log, .2.log, ... so a
+// session's segments sort together and in order
+bool DebugLogger::openSegment() {
+    QString logFileName = m_segment == 0
+        ? QString("%1/debug_%2.log").arg(m_log_directory, m_session_stamp)
+        : QString("%1/debug_%2.%3.log").arg(m_log_directory, m_session_stamp)
+              .arg(m_segment);
+
+    m_logFile.setFileName(logFileName);
+    m_segment_bytes = 0;
+    m_segment_opened = QDateTime::currentDateTime();
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
         qWarning() << "Failed to open log file:" << logFileName;
+        return false;
+    }
+    return true;
+}
+
+QString DebugLogger::currentLogFile() const {
+    std::lock_guard lock(m_file_mutex);
+    return m_logFile.fileName();
+}
+
+// Called with m_file_mutex held
+void DebugLogger::rotateLogFile() {
+    const QString closedPath = m_logFile.fileName();
+    m_logFile.close();
+
+    ++m_segment;
+    if (openSegment()) {
+        appendToLogFile(QString("Log continues from %1").arg(closedPath),
+                        QDateTime::currentDateTime());
     }
 }
 
 void DebugLogger::writeToLogFile(const QString& message) {
-    if (m_logFile.isOpen()) {
-        QString timestamp = QDateTime::currentDateTime()
-            .toString("yyyy-MM-dd HH:mm:ss.zzz");
-        QString logEntry = QString("[%1] %2\n")
-            .arg(timestamp)
-            .arg(message);
-        m_logFile.write(logEntry.toUtf8());
-        m_logFile.flush();
+    QString closedPath;
+    QString currentPath;
+    {
+        std::lock_guard lock(m_file_mutex);
+        const QDateTime now = QDateTime::currentDateTime();
+        if (!appendToLogFile(message, now)) {
+            return;
+        }
+
+        if (m_segment_bytes >= MAX_SEGMENT_BYTES ||
+            m_segment_opened.secsTo(now) >= MAX_SEGMENT_AGE_S) {
+            closedPath = m_logFile.fileName();
+            rotateLogFile();
+            currentPath = m_logFile.fileName();
+        }
+    }
+
+    // Outside the lock: a directly connected receiver may log or ask for
+    // currentLogFile()
+    if (!closedPath.isEmpty()) {
+        emit logSegmentClosed(closedPath, currentPath);
     }
 }
 
+// Called with m_file_mutex held
+bool DebugLogger::appendToLogFile(const QString& message, const QDateTime& now) {
+    if (!m_logFile.isOpen()) {
+        return false;
+    }
+
+    QString timestamp = now.toString("yyyy-MM-dd HH:mm:ss.zzz");
+    QString logEntry = QString("[%1] %2\n")
+        .arg(timestamp)
+        .arg(message);
+    const QByteArray bytes = logEntry.toUtf8();
+    m_logFile.write(bytes);
+    m_logFile.flush();
+
+    m_segment_bytes += bytes.size();
+    return true;
+}
+
 bool DebugLogger::shouldLog(LogLevel level, bool verboseOnly) const {
     // Verbose messages only shown in Verbose mode
     if (verboseOnly && m_verbosity != LogVerbosity::Verbose) {
@@ -99,6 +161,14 @@ void DebugLogger::logMessage(const QString& message, LogLevel level,
     // Add to in-memory log
     m_log_text += formattedMessage + "\n";
 
+    {
+        std::lock_guard lock(m_recent_mutex);
+        m_recent_lines.append(formattedMessage);
+        if (m_recent_lines.size() > RECENT_LINES) {
+            m_recent_lines.removeFirst();
+        }
+    }
+
     // Keep only last 10000 characters in memory
     if (m_log_text.length() > 10000) {
         m_log_text = m_log_text.right(10000);
@@ -168,6 +238,11 @@ void DebugLogger::clearLog() {
     emit logTextChanged();
 }
 
+QStringList DebugLogger::recentLines() const {
+    std::lock_guard lock(m_recent_mutex);
+    return m_recent_lines;
+}
+
 QString DebugLogger::formatHexDump(const QByteArray& data) {
     return formatHexDump(reinterpret_cast<const uint8_t*>(data.data()),
                          data.size());
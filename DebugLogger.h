@@ -2,7 +2,10 @@
 
 #include <QObject>
 #include <QString>
+#include <QDateTime>
 #include <QFile>
+#include <QStringList>
+#include <mutex>
 
 class DebugLogger : public QObject {
     Q_OBJECT
@@ -44,24 +47,56 @@ public:
     Q_INVOKABLE void log(const QString& message); // Legacy, maps to info
     Q_INVOKABLE void clearLog();
 
+    // Directory holding the debug_<session>[.<n>].log segments
+    QString logDirectory() const { return m_log_directory; }
+    // The segment being written; safe from any thread
+    QString currentLogFile() const;
+
+    // Last lines logged, oldest first. Safe from any thread, e.g. the
+    // stall watchdog while the GUI thread is blocked.
+    QStringList recentLines() const;
+
     // Helper for formatting hex dumps
     static QString formatHexDump(const QByteArray& data);
     static QString formatHexDump(const uint8_t* data, int length);
 
+    // A segment is closed and a new one started once it reaches either
+    static constexpr qint64 MAX_SEGMENT_BYTES = 4 * 1024 * 1024;
+    static constexpr qint64 MAX_SEGMENT_AGE_S = 24 * 60 * 60;
+
 signals:
     void logTextChanged();
     void verbosityChanged();
 
+    // closedPath is complete and will not be written again; emitted from
+    // whichever thread logged the line that filled it, after the file lock
+    // is released
+    void logSegmentClosed(const QString &closedPath, const QString &currentPath);
+
 private:
     explicit DebugLogger(QObject *parent = nullptr);
     ~DebugLogger() override;
 
     QString m_log_text;
+    // Guards m_logFile and the segment state below: any thread may log,
+    // and rotation swaps the file underneath concurrent writers
+    mutable std::mutex m_file_mutex;
     QFile m_logFile;
+    QString m_log_directory;
+    QString m_session_stamp;
+    int m_segment = 0;
+    qint64 m_segment_bytes = 0;
+    QDateTime m_segment_opened;
+    mutable std::mutex m_recent_mutex;
+    QStringList m_recent_lines;
+    static constexpr int RECENT_LINES = 20;
     LogVerbosity m_verbosity = LogVerbosity::Normal;
 
     void openLogFile();
+    bool openSegment();
+    void rotateLogFile();
     void writeToLogFile(const QString& message);
+    bool appendToLogFile(const QString& message, const QDateTime& now);
     void logMessage(const QString& message, LogLevel level,
                     bool verboseOnly = false);
     static QString levelToString(LogLevel level);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "LedAnimation.h"
+
+// Host-side copy of what the Arduino should be showing. Every output field
+// keeps the value the game wants (desired) next to the value the device last
+// acknowledged, so only changed fields go over the bus and everything can be
+// replayed after the device comes back from a reset.
+class DeviceShadow {
+public:
+    static constexpr int MAX_BUTTONS = 8;
+    static constexpr int MAX_TOWERS = 8;
+
+    template<typename T>
+    struct Field {
+        T desired{};
+        T acked{};
+        bool hasDesired = false;
+        bool ackValid = false;
+
+        void set(const T value) {
+            desired = value;
+            hasDesired = true;
+        }
+
+        void acknowledge() {
+            acked = desired;
+            ackValid = true;
+        }
+
+        [[nodiscard]] bool dirty() const {
+            return hasDesired && (!ackValid || desired != acked);
+        }
+    };
+
+    std::array<Field<bool>, MAX_BUTTONS> buttons;
+    std::array<Field<uint8_t>, MAX_TOWERS> towers;
+    Field<int32_t> balanceCents;
+    std::array<Field<LedAnimation>, LedAnimation::MAX_SLOTS> animations;
+
+    // Forget everything the device acknowledged, e.g. after RSP_INIT
+    void invalidate() {
+        for (auto &button: buttons) button.ackValid = false;
+        for (auto &tower: towers) tower.ackValid = false;
+        balanceCents.ackValid = false;
+        for (auto &animation: animations) animation.ackValid = false;
+    }
+
+    [[nodiscard]] bool dirty() const {
+        for (const auto &button: buttons) {
+            if (button.dirty()) return true;
+        }
+        for (const auto &tower: towers) {
+            if (tower.dirty()) return true;
+        }
+        for (const auto &animation: animations) {
+            if (animation.dirty()) return true;
+        }
+        return balanceCents.dirty();
+    }
+};
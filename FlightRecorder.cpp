@@ -0,0 +1,292 @@
+#include "FlightRecorder.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <link.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+    constexpr uint32_t SLOT_SIZE = MappedRingFile::SLOT_HEADER_SIZE + sizeof(FlightRecorder::Event);
+    constexpr int CRASH_SIGNALS[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+    constexpr int MAX_BACKTRACE = 48;
+
+    uint64_t monotonicNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    uint32_t threadId() {
+#ifdef Q_OS_LINUX
+        thread_local const auto tid = static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+        thread_local const auto tid = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pthread_self()));
+#endif
+        return tid;
+    }
+
+    void setLabel(FlightRecorder::Event &event, const char *label) {
+        if (!label) {
+            return;
+        }
+        auto *bytes = reinterpret_cast<char *>(&event.words[2]);
+        std::size_t length = 0;
+        while (length < FlightRecorder::LABEL_SIZE - 1 && label[length]) {
+            bytes[length] = label[length];
+            ++length;
+        }
+    }
+
+    const char *signalName(const int signal) {
+        switch (signal) {
+            case SIGSEGV: return "SIGSEGV";
+            case SIGBUS:  return "SIGBUS";
+            case SIGILL:  return "SIGILL";
+            case SIGFPE:  return "SIGFPE";
+            case SIGABRT: return "SIGABRT";
+            default:      return "signal";
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    // The main executable is the first object dl_iterate_phdr reports
+    int findExecutable(dl_phdr_info *info, std::size_t, void *data) {
+        auto *range = static_cast<std::pair<uint64_t, uint64_t> *>(data);
+        uint64_t end = 0;
+        for (int i = 0; i < info->dlpi_phnum; ++i) {
+            const ElfW(Phdr) &header = info->dlpi_phdr[i];
+            if (header.p_type == PT_LOAD) {
+                end = std::max<uint64_t>(end, header.p_vaddr + header.p_memsz);
+            }
+        }
+        range->first = info->dlpi_addr;
+        range->second = info->dlpi_addr + end;
+        return 1;
+    }
+#endif
+
+    // Stack for the crash handler on the thread that opened the recorder, so
+    // a stack overflow there is still recorded
+    alignas(16) std::array<uint8_t, 64 * 1024> g_signal_stack;
+}
+
+double FlightRecorder::Event::firstAmount() const {
+    return std::bit_cast<double>(words[0]);
+}
+
+double FlightRecorder::Event::secondAmount() const {
+    return std::bit_cast<double>(words[1]);
+}
+
+QString FlightRecorder::Event::label() const {
+    const auto *bytes = reinterpret_cast<const char *>(&words[2]);
+    return QString::fromUtf8(bytes, static_cast<qsizetype>(strnlen(bytes, LABEL_SIZE)));
+}
+
+FlightRecorder &FlightRecorder::instance() {
+    // Never destroyed: the crash handler may run during static teardown
+    static auto *recorder = new FlightRecorder;
+    return *recorder;
+}
+
+bool FlightRecorder::open(const QString &path, QString &error, const uint32_t capacity) {
+    if (isOpen()) {
+        error = QString("Flight recorder already open at %1").arg(m_ring.load()->path());
+        return false;
+    }
+
+    // A previous session without a SessionEnd crashed, was killed or lost
+    // power; keep its record before this session starts overwriting it
+    std::vector<Event> previous;
+    QString loadError;
+    if (QFile::exists(path) && load(path, previous, loadError) && !previous.empty() &&
+        previous.back().type != Type::SessionEnd) {
+        const QFileInfo info(path);
+        const QString copy = info.absolutePath() + "/flight-" +
+                             QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".ring";
+        if (QFile::copy(path, copy)) {
+            m_previous_session_copy = copy;
+        }
+    }
+
+    m_ring_storage = MappedRingFile::open(path, RING_TAG, SLOT_SIZE, capacity, error);
+    if (!m_ring_storage) {
+        return false;
+    }
+    m_ring.store(m_ring_storage.get(), std::memory_order_release);
+
+    // Left at 0 elsewhere; the decoder then prints absolute addresses only
+    std::pair<uint64_t, uint64_t> executable{0, 0};
+#ifdef Q_OS_LINUX
+    dl_iterate_phdr(findExecutable, &executable);
+#endif
+    const QByteArray name = QFileInfo(QCoreApplication::applicationFilePath()).fileName().toUtf8();
+    record(Type::SessionStart, 0, static_cast<int64_t>(executable.first),
+           static_cast<int64_t>(executable.second), name.constData());
+
+    installCrashHandler();
+    return true;
+}
+
+void FlightRecorder::append(const Event &event) {
+    MappedRingFile *ring = m_ring.load(std::memory_order_acquire);
+    if (ring) {
+        ring->append(std::span(reinterpret_cast<const uint8_t *>(&event), sizeof(event)));
+    }
+}
+
+void FlightRecorder::record(const Type type, const uint8_t code, const int64_t first, const int64_t second,
+                            const char *label) {
+    if (!isOpen()) {
+        return;
+    }
+
+    Event event;
+    event.timestampNs = monotonicNs();
+    event.thread = threadId();
+    event.type = type;
+    event.code = code;
+    event.words[0] = static_cast<uint64_t>(first);
+    event.words[1] = static_cast<uint64_t>(second);
+    setLabel(event, label);
+    append(event);
+}
+
+void FlightRecorder::record(const Type type, const uint8_t code, const int64_t first, const int64_t second,
+                            const QString &label) {
+    if (isOpen()) {
+        record(type, code, first, second, label.toUtf8().constData());
+    }
+}
+
+void FlightRecorder::recordMoney(const MoneyKind kind, const double amount, const double balanceAfter) {
+    record(Type::Money, static_cast<uint8_t>(kind), std::bit_cast<int64_t>(amount),
+           std::bit_cast<int64_t>(balanceAfter));
+}
+
+void FlightRecorder::recordRisk(const RiskOutcome outcome, const int levelAfter, const double prizeAfter) {
+    record(Type::Risk, static_cast<uint8_t>(outcome), levelAfter, std::bit_cast<int64_t>(prizeAfter));
+}
+
+void FlightRecorder::installCrashHandler() {
+    // backtrace() loads libgcc on first use, which allocates; do that now
+    // rather than inside the handler
+    void *warmUp[1];
+    backtrace(warmUp, 1);
+
+    stack_t stack{};
+    stack.ss_sp = g_signal_stack.data();
+    stack.ss_size = g_signal_stack.size();
+    sigaltstack(&stack, nullptr);
+
+    struct sigaction action{};
+    action.sa_sigaction = &FlightRecorder::crashHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (const int signal: CRASH_SIGNALS) {
+        sigaction(signal, &action, nullptr);
+    }
+}
+
+void FlightRecorder::crashHandler(const int signal, siginfo_t *info, void *) {
+    FlightRecorder &recorder = instance();
+
+    Event crash;
+    crash.timestampNs = monotonicNs();
+    crash.thread = threadId();
+    crash.type = Type::Crash;
+    crash.code = static_cast<uint8_t>(signal);
+    crash.words[0] = reinterpret_cast<uint64_t>(info ? info->si_addr : nullptr);
+    setLabel(crash, signalName(signal));
+    recorder.append(crash);
+
+    void *frames[MAX_BACKTRACE];
+    const int count = backtrace(frames, MAX_BACKTRACE);
+    for (int i = 0; i < count; i += static_cast<int>(FRAMES_PER_RECORD)) {
+        Event trace = crash;
+        trace.type = Type::Backtrace;
+        trace.code = static_cast<uint8_t>(i);
+        trace.words = {};
+        for (std::size_t j = 0; j < FRAMES_PER_RECORD && i + static_cast<int>(j) < count; ++j) {
+            trace.words[j] = reinterpret_cast<uint64_t>(frames[i + static_cast<int>(j)]);
+        }
+        recorder.append(trace);
+    }
+
+    // SA_RESETHAND restored the default action: die as we would have,
+    // with the same exit status and core dump
+    raise(signal);
+}
+
+bool FlightRecorder::load(const QString &path, std::vector<Event> &events, QString &error) {
+    QString tag;
+    std::vector<MappedRingFile::Record> records;
+    if (!MappedRingFile::readRecords(path, tag, records, error)) {
+        return false;
+    }
+
+    if (tag != RING_TAG) {
+        error = QString("%1 holds '%2' records, not a flight record").arg(path, tag);
+        return false;
+    }
+
+    events.clear();
+    events.reserve(records.size());
+    for (const auto &record: records) {
+        if (record.bytes.size() != sizeof(Event)) {
+            continue;
+        }
+
+        Event event;
+        std::memcpy(&event, record.bytes.data(), sizeof(event));
+        events.push_back(event);
+    }
+    return true;
+}
+
+QString FlightRecorder::typeName(const Type type) {
+    switch (type) {
+        case Type::SessionStart: return "session-start";
+        case Type::SessionEnd: return "session-end";
+        case Type::Crash: return "CRASH";
+        case Type::Backtrace: return "backtrace";
+        case Type::Power: return "power";
+        case Type::LinkState: return "link";
+        case Type::Button: return "button";
+        case Type::Money: return "money";
+        case Type::SpinResult: return "spin-result";
+        case Type::Risk: return "risk";
+        case Type::SerialCommand: return "serial";
+        default: return "unknown";
+    }
+}
+
+QString FlightRecorder::moneyKindName(const MoneyKind kind) {
+    switch (kind) {
+        case MoneyKind::Bet: return "bet";
+        case MoneyKind::Deposit: return "deposit";
+        case MoneyKind::SetBalance: return "set-balance";
+        case MoneyKind::Cashout: return "cashout";
+        case MoneyKind::RiskCollect: return "risk-collect";
+        default: return "unknown";
+    }
+}
+
+QString FlightRecorder::riskOutcomeName(const RiskOutcome outcome) {
+    switch (outcome) {
+        case RiskOutcome::Won: return "won";
+        case RiskOutcome::FellBack: return "fell-back";
+        case RiskOutcome::Lost: return "lost";
+        default: return "unknown";
+    }
+}
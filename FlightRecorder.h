@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QString>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MappedRingFile.h"
+
+// Always-on crash flight recorder. Game and link state changes, button
+// presses and every movement of money become fixed-size records in a
+// MappedRingFile (flight.ring), so recording costs a memcpy and the newest
+// events survive a crash of the process. A handler for SIGSEGV, SIGBUS,
+// SIGILL, SIGFPE and SIGABRT adds the signal, the faulting address and a
+// backtrace before letting the process die as it would have.
+//
+// I2C frames are not repeated here: I2CBusRecorder already keeps them with
+// the same clock, and tools/flight_decode interleaves both rings.
+//
+// record() is a no-op until open() and may be called from any thread.
+class FlightRecorder {
+public:
+    static constexpr const char *RING_TAG = "flight/1";
+    static constexpr uint32_t DEFAULT_CAPACITY = 8192;
+    static constexpr std::size_t LABEL_SIZE = 32;
+    static constexpr std::size_t FRAMES_PER_RECORD = 6;
+
+    // first/second are the two numbers of a record; label its text
+    enum class Type : uint8_t {
+        SessionStart = 0,  // first/second: start/end of the executable's mapping,
+                           // label: executable name
+        SessionEnd = 1,    // Clean shutdown
+        Crash = 2,         // code: signal, first: fault address, label: signal name
+        Backtrace = 3,     // code: index of the first frame; all six words are return addresses
+        Power = 4,         // code: 1 on, 0 off
+        LinkState = 5,     // code: I2CWorker::ConnectionState, first: board address, label: state
+        Button = 6,        // code: button id
+        Money = 7,         // code: MoneyKind, first/second: amount/balance after as doubles
+        SpinResult = 8,    // code: Symbol::Type, label: symbol or "miss"
+        Risk = 9,          // code: RiskOutcome, first: level after, second: prize after as double
+        SerialCommand = 10 // code: SerialWorker::Command
+    };
+
+    enum class MoneyKind : uint8_t {
+        Bet = 0,
+        Deposit = 1,       // addBalance()
+        SetBalance = 2,    // Loaded at start or set over serial
+        Cashout = 3,
+        RiskCollect = 4
+    };
+
+    enum class RiskOutcome : uint8_t {
+        Won = 0,
+        FellBack = 1,      // Back to the checkpoint level
+        Lost = 2
+    };
+
+    // On-disk record, host byte order
+    struct Event {
+        uint64_t timestampNs = 0;  // CLOCK_MONOTONIC, same clock as I2CBusRecorder
+        uint32_t thread = 0;       // Kernel thread id
+        Type type = Type::SessionStart;
+        uint8_t code = 0;
+        uint16_t reserved = 0;
+        std::array<uint64_t, 6> words{}; // first, second, then the label (see Type)
+
+        [[nodiscard]] int64_t first() const { return static_cast<int64_t>(words[0]); }
+        [[nodiscard]] int64_t second() const { return static_cast<int64_t>(words[1]); }
+        [[nodiscard]] double firstAmount() const;
+        [[nodiscard]] double secondAmount() const;
+        [[nodiscard]] QString label() const;
+    };
+    static_assert(sizeof(Event) == 64);
+
+    static FlightRecorder &instance();
+
+    // Opens (or continues) the ring at path, records a SessionStart and
+    // installs the crash handler. If the previous session did not end
+    // cleanly its ring is first copied next to it; see previousSessionCopy().
+    bool open(const QString &path, QString &error, uint32_t capacity = DEFAULT_CAPACITY);
+
+    [[nodiscard]] bool isOpen() const { return m_ring.load(std::memory_order_acquire) != nullptr; }
+
+    // Copy of the ring left by a session that crashed or was killed, empty
+    // if it shut down cleanly
+    [[nodiscard]] QString previousSessionCopy() const { return m_previous_session_copy; }
+
+    // label is truncated to LABEL_SIZE - 1 bytes
+    void record(Type type, uint8_t code, int64_t first = 0, int64_t second = 0,
+                const char *label = nullptr);
+
+    void record(Type type, uint8_t code, int64_t first, int64_t second, const QString &label);
+
+    void recordMoney(MoneyKind kind, double amount, double balanceAfter);
+
+    void recordRisk(RiskOutcome outcome, int levelAfter, double prizeAfter);
+
+    // Offline decoding
+    static bool load(const QString &path, std::vector<Event> &events, QString &error);
+
+    static QString typeName(Type type);
+
+    static QString moneyKindName(MoneyKind kind);
+
+    static QString riskOutcomeName(RiskOutcome outcome);
+
+private:
+    FlightRecorder() = default;
+
+    void append(const Event &event);
+
+    void installCrashHandler();
+
+    // Async-signal-safe: stores only, no locks or allocation
+    static void crashHandler(int signal, siginfo_t *info, void *context);
+
+    std::unique_ptr<MappedRingFile> m_ring_storage;
+    std::atomic<MappedRingFile *> m_ring{nullptr};
+    QString m_previous_session_copy;
+};
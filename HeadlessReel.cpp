@@ -0,0 +1,66 @@
+#include "HeadlessReel.h"
+#include <QRandomGenerator>
+#include "DebugLogger.h"
+
+HeadlessReel::HeadlessReel(QObject *parent)
+    : QObject(parent)
+      , m_spin_timer(new ClockTimer(this)) {
+    for (const SymbolOdds &odds: DEFAULT_SYMBOLS) {
+        m_weights.append({odds.type, odds.weight});
+        m_total_weight += odds.weight;
+    }
+
+    m_spin_timer->setSingleShot(true);
+    m_spin_timer->setInterval(SPIN_DURATION_MS);
+    connect(m_spin_timer, &ClockTimer::timeout, this, &HeadlessReel::finishSpin);
+}
+
+void HeadlessReel::spin() {
+    if (m_spinning) {
+        return;
+    }
+
+    // Decided up front, like SlotReel's animation target
+    m_target_miss = m_total_weight <= 0 ||
+                    QRandomGenerator::global()->generateDouble() < m_miss_probability;
+    m_target_symbol_type = Symbol::Type::Unknown;
+    if (!m_target_miss) {
+        int pick = static_cast<int>(QRandomGenerator::global()->bounded(m_total_weight));
+        for (const Weight &weight: std::as_const(m_weights)) {
+            if (pick < weight.weight) {
+                m_target_symbol_type = weight.type;
+                break;
+            }
+            pick -= weight.weight;
+        }
+    }
+
+    m_spinning = true;
+    emit spinning_changed();
+    m_spin_timer->start();
+}
+
+void HeadlessReel::set_probabilities(const QVariantMap &probabilities) {
+    m_weights.clear();
+    m_total_weight = 0;
+    for (const SymbolOdds &odds: DEFAULT_SYMBOLS) {
+        const int weight = probabilities.contains(odds.key)
+                               ? probabilities[odds.key].toInt()
+                               : UNSPECIFIED_WEIGHT;
+        if (weight > 0) {
+            m_weights.append({odds.type, weight});
+            m_total_weight += weight;
+        }
+    }
+}
+
+void HeadlessReel::finishSpin() {
+    m_is_miss = m_target_miss;
+    m_current_symbol_type = m_target_symbol_type;
+    m_spinning = false;
+
+    DebugLogger::instance().info(QString("Spin result: %1")
+        .arg(m_is_miss ? QString("MISS") : Symbol::typeToString(m_current_symbol_type)));
+
+    emit spinning_changed();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include "Clock.h"
+#include "ReelBackend.h"
+
+// Reel for cabinets without a display: decides each spin with SlotReel's
+// odds and reports it after the same SPIN_DURATION_MS, so tower lights and
+// button timing feel the same, but loads no images and needs no scene
+// graph. Works under QCoreApplication.
+class HeadlessReel : public QObject, public ReelBackend {
+    Q_OBJECT
+
+public:
+    explicit HeadlessReel(QObject *parent = nullptr);
+
+    void spin() override;
+
+    [[nodiscard]] bool spinning() const override { return m_spinning; }
+
+    [[nodiscard]] Symbol::Type currentSymbolType() const override { return m_current_symbol_type; }
+
+    [[nodiscard]] bool isMiss() const override { return m_is_miss; }
+
+    void set_probabilities(const QVariantMap &probabilities) override;
+
+signals:
+    void spinning_changed();
+
+private:
+    struct Weight {
+        Symbol::Type type;
+        int weight;
+    };
+
+    void finishSpin();
+
+    QVector<Weight> m_weights;
+    int m_total_weight = 0;
+    double m_miss_probability = DEFAULT_MISS_PROBABILITY;
+    bool m_spinning = false;
+    Symbol::Type m_current_symbol_type = Symbol::Type::Unknown;
+    bool m_is_miss = false;
+    Symbol::Type m_target_symbol_type = Symbol::Type::Unknown;
+    bool m_target_miss = false;
+    ClockTimer *m_spin_timer;
+};
@@ -0,0 +1,83 @@
+#include "I2CBusRecorder.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    uint64_t monotonicNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    constexpr uint32_t SLOT_SIZE = MappedRingFile::SLOT_HEADER_SIZE + sizeof(I2CBusRecorder::Frame);
+}
+
+I2CBusRecorder::I2CBusRecorder(std::unique_ptr<MappedRingFile> ring)
+    : m_ring(std::move(ring)) {
+}
+
+std::unique_ptr<I2CBusRecorder> I2CBusRecorder::open(const QString &path, QString &error,
+                                                     const uint32_t capacity) {
+    auto ring = MappedRingFile::open(path, RING_TAG, SLOT_SIZE, capacity, error);
+    if (!ring) {
+        return nullptr;
+    }
+    return std::unique_ptr<I2CBusRecorder>(new I2CBusRecorder(std::move(ring)));
+}
+
+void I2CBusRecorder::record(const uint8_t address, const Direction direction,
+                            const Outcome outcome, const uint8_t command,
+                            const uint8_t attempt, const std::span<const uint8_t> bytes) {
+    Frame frame;
+    frame.timestampNs = monotonicNs();
+    frame.address = address;
+    frame.direction = direction;
+    frame.outcome = outcome;
+    frame.command = command;
+    frame.attempt = attempt;
+    frame.length = static_cast<uint16_t>(bytes.size());
+    frame.captured = static_cast<uint8_t>(std::min(bytes.size(), MAX_CAPTURED_BYTES));
+    std::memcpy(frame.data.data(), bytes.data(), frame.captured);
+
+    m_ring->append(std::span(reinterpret_cast<const uint8_t *>(&frame), sizeof(frame)));
+}
+
+bool I2CBusRecorder::load(const QString &path, std::vector<Frame> &frames, QString &error) {
+    QString tag;
+    std::vector<MappedRingFile::Record> records;
+    if (!MappedRingFile::readRecords(path, tag, records, error)) {
+        return false;
+    }
+
+    if (tag != RING_TAG) {
+        error = QString("%1 holds '%2' records, not an I2C bus capture").arg(path, tag);
+        return false;
+    }
+
+    frames.clear();
+    frames.reserve(records.size());
+    for (const auto &record: records) {
+        if (record.bytes.size() != sizeof(Frame)) {
+            continue;
+        }
+
+        Frame frame;
+        std::memcpy(&frame, record.bytes.data(), sizeof(frame));
+        frame.captured = std::min<uint8_t>(frame.captured, MAX_CAPTURED_BYTES);
+        frames.push_back(frame);
+    }
+    return true;
+}
+
+QString I2CBusRecorder::outcomeName(const Outcome outcome) {
+    switch (outcome) {
+        case Outcome::Sent: return "sent";
+        case Outcome::WriteFailed: return "write-failed";
+        case Outcome::Ok: return "ok";
+        case Outcome::NoResponse: return "no-response";
+        case Outcome::ChecksumFailure: return "checksum";
+        case Outcome::Mismatch: return "mismatch";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "MappedRingFile.h"
+
+// Always-on capture of every frame I2CWorker puts on or reads from the bus.
+// Each frame becomes one fixed-size record in a MappedRingFile, so
+// recording costs a memcpy and the newest frames survive a crash. Frames
+// longer than MAX_CAPTURED_BYTES (only long user names) are truncated; the
+// original length is kept.
+class I2CBusRecorder {
+public:
+    static constexpr const char *RING_TAG = "i2c-bus/1";
+    static constexpr uint32_t DEFAULT_CAPACITY = 16384;
+    static constexpr std::size_t MAX_CAPTURED_BYTES = 48;
+
+    enum class Direction : uint8_t {
+        Tx = 0,
+        Rx = 1
+    };
+
+    enum class Outcome : uint8_t {
+        Sent = 0,            // TX written to the bus
+        WriteFailed = 1,     // TX write() failed
+        Ok = 2,              // RX accepted
+        NoResponse = 3,      // RX empty or too short
+        ChecksumFailure = 4,
+        Mismatch = 5         // RX for a different opcode
+    };
+
+    // On-disk record, host byte order
+    struct Frame {
+        uint64_t timestampNs = 0;     // CLOCK_MONOTONIC
+        Direction direction = Direction::Tx;
+        Outcome outcome = Outcome::Sent;
+        uint8_t command = 0;          // Command the transaction was for
+        uint8_t attempt = 0;          // 0 = first try
+        uint16_t length = 0;          // Original frame length
+        uint8_t captured = 0;         // Bytes stored in data
+        uint8_t address = 0;          // 7-bit slave address
+        std::array<uint8_t, MAX_CAPTURED_BYTES> data{};
+
+        [[nodiscard]] bool truncated() const { return captured < length; }
+        [[nodiscard]] std::span<const uint8_t> bytes() const { return {data.data(), captured}; }
+    };
+    static_assert(sizeof(Frame) == 64);
+
+    // Opens (or continues) the capture at path
+    static std::unique_ptr<I2CBusRecorder> open(const QString &path, QString &error,
+                                                uint32_t capacity = DEFAULT_CAPACITY);
+
+    void record(uint8_t address, Direction direction, Outcome outcome, uint8_t command,
+                uint8_t attempt, std::span<const uint8_t> bytes);
+
+    [[nodiscard]] QString path() const { return m_ring->path(); }
+
+    // Offline decoding
+    static bool load(const QString &path, std::vector<Frame> &frames, QString &error);
+
+    static QString outcomeName(Outcome outcome);
+
+private:
+    explicit I2CBusRecorder(std::unique_ptr<MappedRingFile> ring);
+
+    std::unique_ptr<MappedRingFile> m_ring;
+};
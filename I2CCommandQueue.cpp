@@ -0,0 +1,41 @@
+#include "I2CCommandQueue.h"
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+I2CCommandQueue::I2CCommandQueue()
+    : m_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+}
+
+I2CCommandQueue::~I2CCommandQueue() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void I2CCommandQueue::push(const I2CCommand &command) {
+    if (m_spilled.load(std::memory_order_acquire) || !m_queue.tryPush(command)) {
+        std::lock_guard lock(m_spill_mutex);
+        m_spill.push_back(command);
+        m_spilled.store(true, std::memory_order_release);
+        m_overflows.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    wake();
+}
+
+void I2CCommandQueue::wake() {
+    // Only the first push after the consumer drained pays for the syscall
+    if (!m_wake_pending.exchange(true)) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(m_fd, &one, sizeof(one));
+    }
+}
+
+void I2CCommandQueue::acknowledge() {
+    uint64_t count = 0;
+    [[maybe_unused]] const ssize_t bytesRead = ::read(m_fd, &count, sizeof(count));
+
+    // Cleared before draining: anything pushed from here on either gets
+    // drained by the caller or writes the eventfd again
+    m_wake_pending.store(false);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "SpscQueue.h"
+
+// Output request from the GUI thread to the I2C worker. Plain data so it can
+// travel through SpscQueue without allocating.
+struct I2CCommand {
+    enum class Type : uint8_t {
+        HighlightButton,
+        HighlightTower,
+        UpdateBalance,
+        PlayAnimation,
+        StopAnimation
+    };
+
+    Type type = Type::StopAnimation;
+    uint8_t id = 0;     // Button, tower or animation slot
+    uint8_t value = 0;  // Button state or tower row
+    int32_t balanceCents = 0;
+    uint32_t traceFlow = 0; // Trace flow of whoever posted it, see Trace.h
+
+    [[nodiscard]] static constexpr I2CCommand highlightButton(const uint8_t buttonId, const bool state) {
+        return {Type::HighlightButton, buttonId, static_cast<uint8_t>(state ? 1 : 0), 0};
+    }
+
+    [[nodiscard]] static constexpr I2CCommand highlightTower(const uint8_t towerId, const uint8_t row) {
+        return {Type::HighlightTower, towerId, row, 0};
+    }
+
+    [[nodiscard]] static constexpr I2CCommand updateBalance(const double balance) {
+        return {Type::UpdateBalance, 0, 0, static_cast<int32_t>(balance * 100.0)};
+    }
+
+    [[nodiscard]] static constexpr I2CCommand playAnimation(const uint8_t slot) {
+        return {Type::PlayAnimation, slot, 0, 0};
+    }
+
+    [[nodiscard]] static constexpr I2CCommand stopAnimation() {
+        return {Type::StopAnimation, 0, 0, 0};
+    }
+};
+static_assert(std::is_trivially_copyable_v<I2CCommand>);
+
+// SpscQueue of I2CCommand plus an eventfd the worker watches with a
+// QSocketNotifier. The eventfd is only written when the consumer may be
+// asleep, so a burst of commands costs one wake-up.
+//
+// Commands are output state and must not be lost or reordered, so when the
+// ring is full (the worker is stuck in a long retry) push() spills into a
+// locked vector and keeps spilling until the consumer has caught up.
+//
+// Single producer: only the GUI thread may push().
+class I2CCommandQueue {
+public:
+    static constexpr std::size_t CAPACITY = 256;
+
+    I2CCommandQueue();
+
+    ~I2CCommandQueue();
+
+    I2CCommandQueue(const I2CCommandQueue &) = delete;
+
+    I2CCommandQueue &operator=(const I2CCommandQueue &) = delete;
+
+    // Producer. Never blocks on the consumer.
+    void push(const I2CCommand &command);
+
+    // Consumer: call after fd() became readable. Runs execute for every
+    // queued command in the order they were pushed.
+    template<typename Execute>
+    void drain(Execute &&execute) {
+        acknowledge();
+
+        I2CCommand command;
+        while (m_queue.tryPop(command)) {
+            execute(command);
+        }
+
+        if (m_spilled.load(std::memory_order_acquire)) {
+            // While spilling the producer leaves the ring alone, so whatever
+            // is in it now predates the spill and has to run first
+            std::vector<I2CCommand> spill;
+            std::size_t older = 0;
+            {
+                std::lock_guard lock(m_spill_mutex);
+                spill.swap(m_spill);
+                older = m_queue.size();
+                m_spilled.store(false, std::memory_order_release);
+            }
+            for (; older > 0 && m_queue.tryPop(command); --older) {
+                execute(command);
+            }
+            for (const I2CCommand &spilled: spill) {
+                execute(spilled);
+            }
+        }
+    }
+
+    [[nodiscard]] int fd() const { return m_fd; }
+
+    // Commands that went through the spill path
+    [[nodiscard]] uint64_t overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+
+private:
+    void wake();
+
+    void acknowledge();
+
+    SpscQueue<I2CCommand, CAPACITY> m_queue;
+    int m_fd = -1;
+    std::atomic<bool> m_wake_pending{false};
+    std::atomic<uint64_t> m_overflows{0};
+
+    std::mutex m_spill_mutex;
+    std::vector<I2CCommand> m_spill;
+    std::atomic<bool> m_spilled{false};
+};
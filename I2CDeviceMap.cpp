@@ -0,0 +1,182 @@
+#include "I2CDeviceMap.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QStringList>
+#include "DeviceShadow.h"
+
+namespace {
+    // Addresses may be written as numbers or "0x43" strings
+    bool parseAddress(const QJsonValue &value, uint8_t &address) {
+        bool ok = false;
+        int parsed = -1;
+        if (value.isDouble()) {
+            parsed = value.toInt(-1);
+            ok = true;
+        } else if (value.isString()) {
+            parsed = value.toString().toInt(&ok, 0);
+        }
+        if (!ok || parsed < 0x08 || parsed > 0x77) {
+            return false;
+        }
+        address = static_cast<uint8_t>(parsed);
+        return true;
+    }
+
+    bool parseIds(const QJsonValue &value, QVector<uint8_t> &ids) {
+        if (value.isUndefined()) {
+            return true;
+        }
+        if (!value.isArray()) {
+            return false;
+        }
+        for (const QJsonValue &id: value.toArray()) {
+            const int parsed = id.toInt(-1);
+            if (parsed < 0 || parsed > 255) {
+                return false;
+            }
+            ids.append(static_cast<uint8_t>(parsed));
+        }
+        return true;
+    }
+}
+
+I2CDeviceMap I2CDeviceMap::singleDevice(const uint8_t address) {
+    I2CDeviceConfig device;
+    device.name = "main";
+    device.address = address;
+    device.display = true;
+    for (uint8_t id = 0; id < DeviceShadow::MAX_BUTTONS; ++id) {
+        device.buttons.append(id);
+    }
+    for (uint8_t id = 0; id < DeviceShadow::MAX_TOWERS; ++id) {
+        device.towers.append(id);
+    }
+
+    I2CDeviceMap map;
+    map.m_devices.append(device);
+    return map;
+}
+
+I2CDeviceMap I2CDeviceMap::load(const QString &path, QString &error) {
+    QFile file(path);
+    if (!file.exists()) {
+        return singleDevice();
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot read %1: %2").arg(path, file.errorString());
+        return singleDevice();
+    }
+
+    I2CDeviceMap map;
+    if (!fromJson(file.readAll(), map, error)) {
+        error = QString("%1: %2").arg(path, error);
+        return singleDevice();
+    }
+    return map;
+}
+
+bool I2CDeviceMap::fromJson(const QByteArray &json, I2CDeviceMap &map, QString &error) {
+    QJsonParseError parseError{};
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (!doc.isObject()) {
+        error = parseError.error != QJsonParseError::NoError
+                    ? parseError.errorString()
+                    : QString("expected a JSON object");
+        return false;
+    }
+
+    I2CDeviceMap result;
+    for (const QJsonValue &entry: doc.object().value("devices").toArray()) {
+        const QJsonObject obj = entry.toObject();
+
+        I2CDeviceConfig device;
+        if (!parseAddress(obj.value("address"), device.address)) {
+            error = "device without a valid 7-bit address";
+            return false;
+        }
+        device.name = obj.value("name").toString(
+            QString("0x%1").arg(device.address, 2, 16, QChar('0')));
+        device.display = obj.value("display").toBool(false);
+
+        if (!parseIds(obj.value("buttons"), device.buttons) ||
+            !parseIds(obj.value("towers"), device.towers)) {
+            error = QString("invalid button or tower list for %1").arg(device.name);
+            return false;
+        }
+
+        result.m_devices.append(device);
+    }
+
+    if (!result.validate(error)) {
+        return false;
+    }
+
+    map = result;
+    return true;
+}
+
+bool I2CDeviceMap::validate(QString &error) const {
+    if (m_devices.isEmpty()) {
+        error = "no devices configured";
+        return false;
+    }
+    if (m_devices.size() > MAX_DEVICES) {
+        error = QString("at most %1 devices are supported").arg(MAX_DEVICES);
+        return false;
+    }
+
+    QSet<uint8_t> addresses;
+    QSet<uint8_t> buttons;
+    QSet<uint8_t> towers;
+
+    for (const I2CDeviceConfig &device: m_devices) {
+        if (addresses.contains(device.address)) {
+            error = QString("address 0x%1 used twice").arg(device.address, 2, 16, QChar('0'));
+            return false;
+        }
+        addresses.insert(device.address);
+
+        if (device.buttons.size() > DeviceShadow::MAX_BUTTONS ||
+            device.towers.size() > DeviceShadow::MAX_TOWERS) {
+            error = QString("%1 has more than %2 buttons or %3 towers")
+                    .arg(device.name)
+                    .arg(DeviceShadow::MAX_BUTTONS)
+                    .arg(DeviceShadow::MAX_TOWERS);
+            return false;
+        }
+
+        for (const uint8_t id: device.buttons) {
+            if (buttons.contains(id)) {
+                error = QString("button %1 routed to more than one device").arg(id);
+                return false;
+            }
+            buttons.insert(id);
+        }
+        for (const uint8_t id: device.towers) {
+            if (towers.contains(id)) {
+                error = QString("tower %1 routed to more than one device").arg(id);
+                return false;
+            }
+            towers.insert(id);
+        }
+    }
+
+    return true;
+}
+
+QString I2CDeviceMap::describe() const {
+    QStringList parts;
+    for (const I2CDeviceConfig &device: m_devices) {
+        parts.append(QString("%1@0x%2 (%3 buttons, %4 towers%5)")
+                     .arg(device.name)
+                     .arg(device.address, 2, 16, QChar('0'))
+                     .arg(device.buttons.size())
+                     .arg(device.towers.size())
+                     .arg(device.display ? ", display" : ""));
+    }
+    return parts.join(", ");
+}
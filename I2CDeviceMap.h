@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+// One peripheral board on the I2C bus and the game outputs/inputs it owns.
+// Boards speak the same protocol and number their buttons and towers from
+// zero; the lists map those local ids to the game's global ids.
+struct I2CDeviceConfig {
+    QString name;
+    uint8_t address = 0;
+    QVector<uint8_t> buttons; // buttons[localId] = global button id
+    QVector<uint8_t> towers;  // towers[localId] = global tower id
+    bool display = false;     // Shows the user name and balance
+};
+
+// Which boards exist and how buttons, towers and displays are routed to
+// them. Loaded from i2c_devices.json in the app data directory:
+//
+//   { "devices": [
+//       { "name": "main",   "address": "0x42", "buttons": [0,1,2,3],
+//         "towers": [0,1,2,3,4], "display": true },
+//       { "name": "towers", "address": "0x43", "towers": [5,6,7] } ] }
+//
+// Without a file the cabinet has a single board at 0x42 that owns
+// everything, which is the original wiring.
+class I2CDeviceMap {
+public:
+    static constexpr int MAX_DEVICES = 8;
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x42;
+
+    // Every button, tower and the display on one board
+    static I2CDeviceMap singleDevice(uint8_t address = DEFAULT_ADDRESS);
+
+    // Falls back to singleDevice() if the file is missing; error is only
+    // set if the file exists but is invalid
+    static I2CDeviceMap load(const QString &path, QString &error);
+
+    static bool fromJson(const QByteArray &json, I2CDeviceMap &map, QString &error);
+
+    [[nodiscard]] const QVector<I2CDeviceConfig> &devices() const { return m_devices; }
+
+    [[nodiscard]] QString describe() const;
+
+private:
+    bool validate(QString &error) const;
+
+    QVector<I2CDeviceConfig> m_devices;
+};
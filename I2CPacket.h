@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Wire format shared with the Arduino firmware:
+//
+//   [command][length][payload ... length bytes][xor checksum]
+//
+// Responses use the same layout with command | 0x80 and the status byte as
+// the first payload byte. Everything here works on fixed-size storage and
+// non-owning views so a transaction never touches the heap.
+namespace I2CPacket {
+    inline constexpr std::size_t HEADER_SIZE = 2;
+    inline constexpr std::size_t CHECKSUM_SIZE = 1;
+    inline constexpr std::size_t MAX_PAYLOAD_SIZE = 255;
+    inline constexpr std::size_t MAX_PACKET_SIZE =
+            HEADER_SIZE + MAX_PAYLOAD_SIZE + CHECKSUM_SIZE;
+    inline constexpr std::size_t MIN_RESPONSE_SIZE = 4; // cmd, len, status, xor
+
+    [[nodiscard]] constexpr uint8_t checksum(const std::span<const uint8_t> bytes) {
+        uint8_t result = 0;
+        for (const uint8_t byte: bytes) {
+            result ^= byte;
+        }
+        return result;
+    }
+
+    // Little-endian int32, as used by CMD_UPDATE_USER_BALANCE
+    [[nodiscard]] constexpr std::array<uint8_t, 4> encodeInt32(const int32_t value) {
+        const auto raw = static_cast<uint32_t>(value);
+        return {
+            static_cast<uint8_t>(raw & 0xFF),
+            static_cast<uint8_t>((raw >> 8) & 0xFF),
+            static_cast<uint8_t>((raw >> 16) & 0xFF),
+            static_cast<uint8_t>((raw >> 24) & 0xFF)
+        };
+    }
+
+    // Outgoing frame built in place
+    class TxPacket {
+    public:
+        constexpr TxPacket() = default;
+
+        constexpr TxPacket(const uint8_t command, const std::span<const uint8_t> payload) {
+            build(command, payload);
+        }
+
+        // Returns false (and leaves the packet empty) if the payload is too long
+        constexpr bool build(const uint8_t command, const std::span<const uint8_t> payload) {
+            if (payload.size() > MAX_PAYLOAD_SIZE) {
+                m_size = 0;
+                return false;
+            }
+
+            m_bytes[0] = command;
+            m_bytes[1] = static_cast<uint8_t>(payload.size());
+            for (std::size_t i = 0; i < payload.size(); ++i) {
+                m_bytes[HEADER_SIZE + i] = payload[i];
+            }
+
+            const std::size_t checksumPos = HEADER_SIZE + payload.size();
+            m_bytes[checksumPos] = checksum(std::span(m_bytes.data(), checksumPos));
+            m_size = checksumPos + CHECKSUM_SIZE;
+            return true;
+        }
+
+        [[nodiscard]] constexpr bool empty() const { return m_size == 0; }
+        [[nodiscard]] constexpr std::size_t size() const { return m_size; }
+        [[nodiscard]] constexpr uint8_t command() const { return m_bytes[0]; }
+
+        [[nodiscard]] constexpr std::span<const uint8_t> bytes() const {
+            return {m_bytes.data(), m_size};
+        }
+
+    private:
+        std::array<uint8_t, MAX_PACKET_SIZE> m_bytes{};
+        std::size_t m_size = 0;
+    };
+
+    // Non-owning view of a received frame
+    class ResponseView {
+    public:
+        constexpr ResponseView() = default;
+
+        constexpr explicit ResponseView(const std::span<const uint8_t> bytes)
+            : m_bytes(bytes) {
+        }
+
+        [[nodiscard]] constexpr bool empty() const { return m_bytes.empty(); }
+        [[nodiscard]] constexpr std::size_t size() const { return m_bytes.size(); }
+        [[nodiscard]] constexpr uint8_t operator[](const std::size_t i) const { return m_bytes[i]; }
+        [[nodiscard]] constexpr std::span<const uint8_t> bytes() const { return m_bytes; }
+
+        [[nodiscard]] constexpr bool isComplete() const {
+            return m_bytes.size() >= MIN_RESPONSE_SIZE;
+        }
+
+        [[nodiscard]] constexpr uint8_t command() const { return m_bytes[0]; }
+        [[nodiscard]] constexpr uint8_t length() const { return m_bytes[1]; }
+        [[nodiscard]] constexpr uint8_t status() const { return m_bytes[2]; }
+
+        // Payload bytes between the length byte and the checksum
+        [[nodiscard]] constexpr std::span<const uint8_t> payload() const {
+            if (m_bytes.size() < HEADER_SIZE + CHECKSUM_SIZE) {
+                return {};
+            }
+            return m_bytes.subspan(HEADER_SIZE, m_bytes.size() - HEADER_SIZE - CHECKSUM_SIZE);
+        }
+
+        [[nodiscard]] constexpr uint8_t receivedChecksum() const {
+            return m_bytes[m_bytes.size() - 1];
+        }
+
+        // XOR over everything but the trailing checksum byte, no copy
+        [[nodiscard]] constexpr uint8_t expectedChecksum() const {
+            return checksum(m_bytes.first(m_bytes.size() - CHECKSUM_SIZE));
+        }
+
+        [[nodiscard]] constexpr bool checksumValid() const {
+            return m_bytes.size() >= HEADER_SIZE + CHECKSUM_SIZE &&
+                   expectedChecksum() == receivedChecksum();
+        }
+
+    private:
+        std::span<const uint8_t> m_bytes;
+    };
+
+    // Receive storage that a ResponseView points into
+    class RxBuffer {
+    public:
+        [[nodiscard]] std::span<uint8_t> storage() { return m_bytes; }
+
+        // Trims the raw read to the frame length announced in byte 1
+        ResponseView commit(std::size_t bytesRead) {
+            if (bytesRead >= HEADER_SIZE) {
+                const std::size_t expected = HEADER_SIZE + m_bytes[1] + CHECKSUM_SIZE;
+                if (bytesRead > expected) {
+                    bytesRead = expected;
+                }
+            }
+            m_size = bytesRead;
+            return view();
+        }
+
+        void clear() { m_size = 0; }
+
+        [[nodiscard]] ResponseView view() const {
+            return ResponseView(std::span(m_bytes.data(), m_size));
+        }
+
+    private:
+        std::array<uint8_t, MAX_PACKET_SIZE> m_bytes{};
+        std::size_t m_size = 0;
+    };
+}
@@ -0,0 +1,204 @@
+#include "I2CTelemetry.h"
+#include <QVariantMap>
+#include <algorithm>
+
+namespace {
+    void increment(std::atomic<uint64_t> &counter, const uint64_t amount = 1) {
+        // Single writer: a relaxed load/store pair is enough and avoids a
+        // locked read-modify-write on every frame
+        counter.store(counter.load(std::memory_order_relaxed) + amount,
+                      std::memory_order_relaxed);
+    }
+}
+
+uint64_t I2CTelemetry::OpcodeStats::percentileUs(const double quantile) const {
+    if (sent == 0) {
+        return 0;
+    }
+
+    const auto target = static_cast<uint64_t>(quantile * static_cast<double>(sent) + 0.5);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += histogram[i];
+        if (seen >= target && seen > 0) {
+            return i < static_cast<int>(BUCKET_LIMITS_US.size()) ? BUCKET_LIMITS_US[i] : latencyMaxUs;
+        }
+    }
+    return latencyMaxUs;
+}
+
+I2CTelemetry::Counters *I2CTelemetry::slot(const uint8_t command) {
+    // Raw debug commands outside the protocol's opcode range are not tracked
+    return command < MAX_OPCODES ? &m_counters[command] : nullptr;
+}
+
+int I2CTelemetry::bucketFor(const uint64_t latencyUs) {
+    for (int i = 0; i < static_cast<int>(BUCKET_LIMITS_US.size()); ++i) {
+        if (latencyUs <= BUCKET_LIMITS_US[i]) {
+            return i;
+        }
+    }
+    return BUCKET_COUNT - 1;
+}
+
+void I2CTelemetry::recordFrame(const uint8_t command) {
+    if (Counters *counters = slot(command)) {
+        increment(counters->frames);
+    }
+}
+
+void I2CTelemetry::recordRetry(const uint8_t command) {
+    if (Counters *counters = slot(command)) {
+        increment(counters->retries);
+    }
+}
+
+void I2CTelemetry::recordNoResponse(const uint8_t command) {
+    if (Counters *counters = slot(command)) {
+        increment(counters->noResponse);
+    }
+}
+
+void I2CTelemetry::recordChecksumFailure(const uint8_t command) {
+    if (Counters *counters = slot(command)) {
+        increment(counters->checksumFailures);
+    }
+}
+
+void I2CTelemetry::recordMismatch(const uint8_t command) {
+    if (Counters *counters = slot(command)) {
+        increment(counters->mismatches);
+    }
+}
+
+void I2CTelemetry::recordResult(const uint8_t command, const bool success, const uint64_t latencyUs) {
+    Counters *counters = slot(command);
+    if (!counters) {
+        return;
+    }
+
+    increment(success ? counters->succeeded : counters->failed);
+    increment(counters->latencyTotalUs, latencyUs);
+    increment(counters->histogram[bucketFor(latencyUs)]);
+    if (latencyUs > counters->latencyMaxUs.load(std::memory_order_relaxed)) {
+        counters->latencyMaxUs.store(latencyUs, std::memory_order_relaxed);
+    }
+    // Bumped last so a reader never sees more commands than results
+    increment(counters->sent);
+}
+
+I2CTelemetry::OpcodeStats I2CTelemetry::load(const uint8_t command, const Counters &counters) {
+    OpcodeStats stats;
+    stats.command = command;
+    stats.sent = counters.sent.load(std::memory_order_relaxed);
+    stats.succeeded = counters.succeeded.load(std::memory_order_relaxed);
+    stats.failed = counters.failed.load(std::memory_order_relaxed);
+    stats.frames = counters.frames.load(std::memory_order_relaxed);
+    stats.retries = counters.retries.load(std::memory_order_relaxed);
+    stats.noResponse = counters.noResponse.load(std::memory_order_relaxed);
+    stats.checksumFailures = counters.checksumFailures.load(std::memory_order_relaxed);
+    stats.mismatches = counters.mismatches.load(std::memory_order_relaxed);
+    stats.latencyTotalUs = counters.latencyTotalUs.load(std::memory_order_relaxed);
+    stats.latencyMaxUs = counters.latencyMaxUs.load(std::memory_order_relaxed);
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        stats.histogram[i] = counters.histogram[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+QVector<I2CTelemetry::OpcodeStats> I2CTelemetry::snapshot() const {
+    QVector<OpcodeStats> result;
+    for (int command = 0; command < MAX_OPCODES; ++command) {
+        const Counters &counters = m_counters[command];
+        if (counters.sent.load(std::memory_order_relaxed) == 0 &&
+            counters.frames.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        result.append(load(static_cast<uint8_t>(command), counters));
+    }
+    return result;
+}
+
+I2CTelemetry::OpcodeStats I2CTelemetry::totals() const {
+    OpcodeStats total;
+    for (const OpcodeStats &stats: snapshot()) {
+        total.sent += stats.sent;
+        total.succeeded += stats.succeeded;
+        total.failed += stats.failed;
+        total.frames += stats.frames;
+        total.retries += stats.retries;
+        total.noResponse += stats.noResponse;
+        total.checksumFailures += stats.checksumFailures;
+        total.mismatches += stats.mismatches;
+        total.latencyTotalUs += stats.latencyTotalUs;
+        total.latencyMaxUs = std::max(total.latencyMaxUs, stats.latencyMaxUs);
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            total.histogram[i] += stats.histogram[i];
+        }
+    }
+    return total;
+}
+
+QString I2CTelemetry::opcodeName(const uint8_t command) {
+    switch (command) {
+        case 0x01: return "INIT";
+        case 0x02: return "HEALTHCHECK";
+        case 0x03: return "POLL_BUTTONS";
+        case 0x04: return "HIGHLIGHT_BTN";
+        case 0x05: return "HIGHLIGHT_TOWER";
+        case 0x06: return "UPDATE_NAME";
+        case 0x07: return "UPDATE_BALANCE";
+        case 0x08: return "ANIM_UPLOAD";
+        case 0x09: return "ANIM_PLAY";
+        case 0x0A: return "ANIM_STOP";
+        default: return QString("0x%1").arg(command, 2, 16, QChar('0'));
+    }
+}
+
+QVariantList I2CTelemetry::toVariantList(const QVector<OpcodeStats> &stats) {
+    QVariantList result;
+    for (const OpcodeStats &s: stats) {
+        QVariantMap row;
+        row["command"] = s.command;
+        row["name"] = opcodeName(s.command);
+        row["sent"] = static_cast<qulonglong>(s.sent);
+        row["succeeded"] = static_cast<qulonglong>(s.succeeded);
+        row["failed"] = static_cast<qulonglong>(s.failed);
+        row["retries"] = static_cast<qulonglong>(s.retries);
+        row["noResponse"] = static_cast<qulonglong>(s.noResponse);
+        row["checksumFailures"] = static_cast<qulonglong>(s.checksumFailures);
+        row["mismatches"] = static_cast<qulonglong>(s.mismatches);
+        row["meanMs"] = s.meanLatencyUs() / 1000.0;
+        row["p50Ms"] = static_cast<double>(s.percentileUs(0.50)) / 1000.0;
+        row["p99Ms"] = static_cast<double>(s.percentileUs(0.99)) / 1000.0;
+        row["maxMs"] = static_cast<double>(s.latencyMaxUs) / 1000.0;
+
+        QVariantList histogram;
+        for (const uint64_t count: s.histogram) {
+            histogram.append(static_cast<qulonglong>(count));
+        }
+        row["histogram"] = histogram;
+        result.append(row);
+    }
+    return result;
+}
+
+QString I2CTelemetry::formatReport(const QVector<OpcodeStats> &stats) {
+    QString report = "=== I2C Statistics ===\n";
+    report += QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+            .arg("OPCODE", -16)
+            .arg("SENT", 8).arg("OK", 8).arg("RETRY", 6).arg("NORSP", 6)
+            .arg("CRC", 6).arg("MISM", 6).arg("P50ms", 7).arg("P99ms", 7);
+
+    for (const OpcodeStats &s: stats) {
+        report += QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+                .arg(opcodeName(s.command), -16)
+                .arg(s.sent, 8).arg(s.succeeded, 8).arg(s.retries, 6)
+                .arg(s.noResponse, 6).arg(s.checksumFailures, 6).arg(s.mismatches, 6)
+                .arg(static_cast<double>(s.percentileUs(0.50)) / 1000.0, 7, 'f', 1)
+                .arg(static_cast<double>(s.percentileUs(0.99)) / 1000.0, 7, 'f', 1);
+    }
+
+    report += "======================\n";
+    return report;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Per-opcode bus counters. The I2C worker thread is the only writer and
+// updates plain relaxed atomics, so recording never blocks; any thread may
+// take a snapshot() at its own pace.
+class I2CTelemetry {
+public:
+    static constexpr int MAX_OPCODES = 16;
+
+    // Upper bounds of the latency buckets in microseconds; the last bucket
+    // catches everything slower
+    static constexpr std::array<uint32_t, 11> BUCKET_LIMITS_US = {
+        250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000
+    };
+    static constexpr int BUCKET_COUNT = static_cast<int>(BUCKET_LIMITS_US.size()) + 1;
+
+    struct OpcodeStats {
+        uint8_t command = 0;
+        uint64_t sent = 0;              // Commands issued
+        uint64_t succeeded = 0;
+        uint64_t failed = 0;            // Ran out of retries
+        uint64_t frames = 0;            // Frames written, including retries
+        uint64_t retries = 0;
+        uint64_t noResponse = 0;
+        uint64_t checksumFailures = 0;
+        uint64_t mismatches = 0;        // Reply opcode did not match
+        uint64_t latencyTotalUs = 0;
+        uint64_t latencyMaxUs = 0;
+        std::array<uint64_t, BUCKET_COUNT> histogram{};
+
+        // Upper bound of the bucket holding the given quantile, in µs
+        [[nodiscard]] uint64_t percentileUs(double quantile) const;
+
+        [[nodiscard]] double meanLatencyUs() const {
+            return sent > 0 ? static_cast<double>(latencyTotalUs) / static_cast<double>(sent) : 0.0;
+        }
+    };
+
+    void recordFrame(uint8_t command);
+
+    void recordRetry(uint8_t command);
+
+    void recordNoResponse(uint8_t command);
+
+    void recordChecksumFailure(uint8_t command);
+
+    void recordMismatch(uint8_t command);
+
+    // One completed command, latency measured across all of its attempts
+    void recordResult(uint8_t command, bool success, uint64_t latencyUs);
+
+    // Opcodes that have seen traffic, in opcode order
+    [[nodiscard]] QVector<OpcodeStats> snapshot() const;
+
+    // Sum over all opcodes
+    [[nodiscard]] OpcodeStats totals() const;
+
+    static QString opcodeName(uint8_t command);
+
+    // One map per opcode for QML
+    static QVariantList toVariantList(const QVector<OpcodeStats> &stats);
+
+    // Plain-text table for the serial console
+    static QString formatReport(const QVector<OpcodeStats> &stats);
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> succeeded{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> retries{0};
+        std::atomic<uint64_t> noResponse{0};
+        std::atomic<uint64_t> checksumFailures{0};
+        std::atomic<uint64_t> mismatches{0};
+        std::atomic<uint64_t> latencyTotalUs{0};
+        std::atomic<uint64_t> latencyMaxUs{0};
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> histogram{};
+    };
+
+    [[nodiscard]] Counters *slot(uint8_t command);
+
+    static OpcodeStats load(uint8_t command, const Counters &counters);
+
+    static int bucketFor(uint64_t latencyUs);
+
+    std::array<Counters, MAX_OPCODES> m_counters;
+};
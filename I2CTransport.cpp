@@ -0,0 +1,93 @@
+#include "I2CTransport.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+
+LinuxI2CTransport::LinuxI2CTransport(QString devicePath)
+    : m_device_path(std::move(devicePath)) {
+}
+
+LinuxI2CTransport::~LinuxI2CTransport() {
+    close();
+}
+
+bool LinuxI2CTransport::open(const uint8_t address, QString &error) {
+    close();
+
+    m_fd = ::open(m_device_path.toLocal8Bit().constData(), O_RDWR);
+    if (m_fd < 0) {
+        m_last_errno = errno;
+        error = QString("Failed to open %1: %2").arg(m_device_path, strerror(m_last_errno));
+        return false;
+    }
+
+    if (!selectAddress(address, error)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void LinuxI2CTransport::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_address = -1;
+}
+
+bool LinuxI2CTransport::selectAddress(const uint8_t address, QString &error) {
+    // One ioctl per switch; back-to-back transfers to the same board skip it
+    if (m_address == address) {
+        return true;
+    }
+
+    if (ioctl(m_fd, I2C_SLAVE, address) < 0) {
+        m_last_errno = errno;
+        m_address = -1;
+        error = QString("Failed to set I2C slave address 0x%1: %2")
+                .arg(address, 2, 16, QChar('0'))
+                .arg(strerror(m_last_errno));
+        return false;
+    }
+
+    m_address = address;
+    return true;
+}
+
+ssize_t LinuxI2CTransport::write(const std::span<const uint8_t> bytes) {
+    const ssize_t written = ::write(m_fd, bytes.data(), bytes.size());
+    if (written < 0) {
+        m_last_errno = errno;
+    }
+    return written;
+}
+
+ssize_t LinuxI2CTransport::read(const std::span<uint8_t> buffer) {
+    const ssize_t bytesRead = ::read(m_fd, buffer.data(), buffer.size());
+    if (bytesRead < 0) {
+        m_last_errno = errno;
+    }
+    return bytesRead;
+}
+
+void LinuxI2CTransport::flush() {
+    if (m_fd < 0) return;
+
+    // Simple flush - try to read any pending data. A responsive slave
+    // answers every read, so bound the loop instead of draining forever.
+    uint8_t dummy[256];
+    fcntl(m_fd, F_SETFL, O_NONBLOCK);
+    for (int i = 0; i < 4 && ::read(m_fd, dummy, sizeof(dummy)) > 0; ++i) {
+        // Discard pending data
+    }
+    fcntl(m_fd, F_SETFL, 0); // Back to blocking
+}
+
+QString LinuxI2CTransport::errorString() const {
+    return QString::fromLocal8Bit(strerror(m_last_errno));
+}
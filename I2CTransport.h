@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include <span>
+#include <sys/types.h>
+
+// Byte-level link to the Arduino. I2CWorker owns one and runs the protocol,
+// retries and polling on top of it, so the same logic works against the
+// real bus or the in-process simulator.
+class I2CTransport {
+public:
+    virtual ~I2CTransport() = default;
+
+    virtual bool open(uint8_t address, QString &error) = 0;
+
+    virtual void close() = 0;
+
+    [[nodiscard]] virtual bool isOpen() const = 0;
+
+    // Point following transfers at another slave on the same bus
+    virtual bool selectAddress(uint8_t address, QString &error) = 0;
+
+    // Both return the byte count, or -1 with errorString() describing why
+    virtual ssize_t write(std::span<const uint8_t> bytes) = 0;
+
+    virtual ssize_t read(std::span<uint8_t> buffer) = 0;
+
+    // Discard anything stale after a reopen
+    virtual void flush() = 0;
+
+    // Time the device needs between a request and a readable reply
+    [[nodiscard]] virtual int responseDelayMs() const = 0;
+
+    [[nodiscard]] virtual QString errorString() const = 0;
+
+    [[nodiscard]] virtual QString description() const = 0;
+};
+
+// /dev/i2c-N through the Linux i2c-dev interface
+class LinuxI2CTransport final : public I2CTransport {
+public:
+    explicit LinuxI2CTransport(QString devicePath = "/dev/i2c-1");
+
+    ~LinuxI2CTransport() override;
+
+    bool open(uint8_t address, QString &error) override;
+
+    void close() override;
+
+    [[nodiscard]] bool isOpen() const override { return m_fd >= 0; }
+
+    bool selectAddress(uint8_t address, QString &error) override;
+
+    ssize_t write(std::span<const uint8_t> bytes) override;
+
+    ssize_t read(std::span<uint8_t> buffer) override;
+
+    void flush() override;
+
+    [[nodiscard]] int responseDelayMs() const override { return RESPONSE_DELAY_MS; }
+
+    [[nodiscard]] QString errorString() const override;
+
+    [[nodiscard]] QString description() const override { return m_device_path; }
+
+private:
+    QString m_device_path;
+    int m_fd = -1;
+    int m_last_errno = 0;
+    int m_address = -1;
+
+    // The Arduino answers from its onRequest handler; give it time to
+    // process the command before clocking the reply out
+    static constexpr int RESPONSE_DELAY_MS = 150;
+};
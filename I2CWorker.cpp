@@ -1,32 +1,99 @@
 #include "I2CWorker.h"
-#include <cerrno>
-#include <cstring>
-#include <fcntl.h>
 #include <QDebug>
-#include <unistd.h>
-#include <linux/i2c-dev.h>
-#include <sys/ioctl.h>
+#include <algorithm>
 #include "DebugLogger.h"
+#include "FlightRecorder.h"
+
+namespace {
+    const char *traceName(const I2CCommand::Type type) {
+        switch (type) {
+            case I2CCommand::Type::HighlightButton: return "highlightButton";
+            case I2CCommand::Type::HighlightTower: return "highlightTower";
+            case I2CCommand::Type::UpdateBalance: return "updateBalance";
+            case I2CCommand::Type::PlayAnimation: return "playAnimation";
+            case I2CCommand::Type::StopAnimation: return "stopAnimation";
+        }
+        return "command";
+    }
+}
 
-I2CWorker::I2CWorker(QObject *parent) : QObject(parent) {
+I2CWorker::I2CWorker(QObject *parent)
+    : QObject(parent)
+      , m_transport(std::make_unique<LinuxI2CTransport>()) {
+    qRegisterMetaType<LedAnimation>();
+    setDeviceMap(I2CDeviceMap::singleDevice());
 }
 
 I2CWorker::~I2CWorker() {
     cleanup();
 }
 
+I2CWorker::BusLock::BusLock(I2CWorker *worker)
+    : m_worker(worker) {
+    m_worker->m_i2c_mutex.lock();
+    m_acquired = std::chrono::steady_clock::now();
+}
+
+I2CWorker::BusLock::~BusLock() {
+    const auto held = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_acquired).count());
+    m_worker->m_i2c_mutex.unlock();
+
+    m_worker->m_stat_lock_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    m_worker->m_stat_lock_hold_ns.fetch_add(held, std::memory_order_relaxed);
+    uint64_t max = m_worker->m_stat_max_lock_hold_ns.load(std::memory_order_relaxed);
+    while (held > max && !m_worker->m_stat_max_lock_hold_ns.compare_exchange_weak(
+               max, held, std::memory_order_relaxed)) {
+    }
+}
+
+I2CWorker::BusStatistics I2CWorker::busStatistics() const {
+    const I2CTelemetry::OpcodeStats totals = m_telemetry.totals();
+
+    BusStatistics stats;
+    stats.transactions = totals.sent;
+    stats.attempts = totals.frames;
+    stats.failures = totals.failed;
+    stats.lockAcquisitions = m_stat_lock_acquisitions.load(std::memory_order_relaxed);
+    stats.lockHoldNs = m_stat_lock_hold_ns.load(std::memory_order_relaxed);
+    stats.maxLockHoldNs = m_stat_max_lock_hold_ns.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void I2CWorker::initialize() {
     if (m_is_initialized) {
         return;
     }
 
     qDebug() << "I2C Thread ID:" << QThread::currentThreadId();
+    Trace::setThreadName("I2C worker");
     DebugLogger::instance().info(
         QString("I2C Worker initialized on thread: %1 (using Linux I2C + "
             "Protocol)")
         .arg(reinterpret_cast<qulonglong>(QThread::currentThreadId()))
     );
 
+    if (m_data_ready && !m_data_ready_notifier) {
+        m_data_ready_notifier = new QSocketNotifier(
+            m_data_ready->fd(), QSocketNotifier::Read, this);
+        connect(m_data_ready_notifier, &QSocketNotifier::activated,
+                this, &I2CWorker::onDataReady);
+        DebugLogger::instance().info(
+            QString("Button input driven by data-ready line: %1")
+            .arg(m_data_ready->description())
+        );
+    }
+
+    if (!m_command_notifier) {
+        m_command_notifier = new QSocketNotifier(
+            m_commands.fd(), QSocketNotifier::Read, this);
+        connect(m_command_notifier, &QSocketNotifier::activated,
+                this, &I2CWorker::onCommandsReady);
+    }
+
+    createStateTimers();
+
     m_is_initialized = true;
     emit initialization_complete();
 }
@@ -36,213 +103,690 @@ void I2CWorker::cleanup() {
         return;
     }
 
-    if (m_i2c_fd >= 0) {
-        close(m_i2c_fd);
-        m_i2c_fd = -1;
+    stopPolling();
+    for (const auto &device: m_devices) {
+        if (device->stateTimer) {
+            device->stateTimer->stop();
+        }
+    }
+
+    if (m_transport->isOpen()) {
+        closeHandle();
         DebugLogger::instance().info("I2C device released");
     }
 
+    for (const auto &device: m_devices) {
+        setDeviceState(*device, ConnectionState::Closed);
+    }
     m_is_initialized = false;
 }
 
+void I2CWorker::setDeviceMap(const I2CDeviceMap &map) {
+    for (const auto &device: m_devices) {
+        delete device->stateTimer;
+    }
+    m_devices.clear();
+    m_button_routes.fill({});
+    m_tower_routes.fill({});
+    m_next_device = 0;
+
+    for (const I2CDeviceConfig &config: map.devices()) {
+        const auto index = static_cast<int8_t>(m_devices.size());
+        for (qsizetype local = 0; local < config.buttons.size(); ++local) {
+            m_button_routes[config.buttons[local]] = {index, static_cast<uint8_t>(local)};
+        }
+        for (qsizetype local = 0; local < config.towers.size(); ++local) {
+            m_tower_routes[config.towers[local]] = {index, static_cast<uint8_t>(local)};
+        }
+
+        auto device = std::make_unique<Device>();
+        device->config = config;
+        const QString labels = QString("device=\"0x%1\"").arg(config.address, 2, 16, QChar('0'));
+        MetricsRegistry &metrics = MetricsRegistry::instance();
+        device->errorsGauge = &metrics.gauge("allesspitze_i2c_consecutive_errors",
+                                             "Failed transactions in a row per I2C board", labels);
+        device->stateGauge = &metrics.gauge("allesspitze_i2c_device_state",
+                                            "I2C board link state: 0 closed, 1 opening, 2 initializing, "
+                                            "3 ready, 4 degraded, 5 recovering", labels);
+        device->errorsGauge->set(0);
+        device->stateGauge->set(static_cast<double>(device->state));
+        m_devices.push_back(std::move(device));
+    }
+
+    if (m_is_initialized) {
+        createStateTimers();
+    }
+}
+
+void I2CWorker::createStateTimers() {
+    for (const auto &device: m_devices) {
+        if (device->stateTimer) {
+            continue;
+        }
+
+        device->stateTimer = new ClockTimer(this);
+        device->stateTimer->setSingleShot(true);
+        Device *target = device.get();
+        connect(device->stateTimer, &ClockTimer::timeout,
+                this, [this, target] { onStateTimeout(*target); });
+    }
+}
+
 void I2CWorker::openDevice(const uint8_t deviceAddress) {
-    auto i2cDevice = "/dev/i2c-1";
+    setDeviceMap(I2CDeviceMap::singleDevice(deviceAddress));
+    openDevices();
+}
 
-    m_i2c_fd = open(i2cDevice, O_RDWR);
-    if (m_i2c_fd < 0) {
-        const QString error = QString("Failed to open %1: %2")
-                .arg(i2cDevice, strerror(errno));
-        DebugLogger::instance().error(error);
+void I2CWorker::openDevices() {
+    for (const auto &device: m_devices) {
+        device->backoffMs = INITIAL_BACKOFF_MS;
+        setDeviceState(*device, ConnectionState::Opening);
+    }
+
+    QString error;
+    if (!m_transport->isOpen() && !openHandle(error)) {
         emit deviceOpened(false, error);
+        for (const auto &device: m_devices) {
+            scheduleRecovery(*device, error);
+        }
         return;
     }
 
-    if (ioctl(m_i2c_fd, I2C_SLAVE, deviceAddress) < 0) {
-        const QString error =
-                QString("Failed to set I2C slave address 0x%1: %2")
-                .arg(deviceAddress, 2, 16, QChar('0'))
-                .arg(strerror(errno));
-        DebugLogger::instance().error(error);
-        close(m_i2c_fd);
-        m_i2c_fd = -1;
-        emit deviceOpened(false, error);
+    for (const auto &device: m_devices) {
+        const QString success =
+                QString("I2C device opened successfully at address: 0x%1")
+                .arg(device->config.address, 2, 16, QChar('0'));
+        DebugLogger::instance().info(logPrefix(*device) + success);
+        emit deviceOpened(true, success);
+
+        // INIT right away: a board still booting does not answer, and
+        // INIT's own retries and backoff wait for it
+        device->initAttempts = 0;
+        setDeviceState(*device, ConnectionState::Initializing);
+        scheduleStateTimer(*device, 0);
+    }
+}
+
+void I2CWorker::setDataReadySource(std::shared_ptr<DataReadySource> source) {
+    m_data_ready = std::move(source);
+}
+
+void I2CWorker::setTransport(std::unique_ptr<I2CTransport> transport) {
+    m_transport = std::move(transport);
+    DebugLogger::instance().info(
+        QString("I2C transport: %1").arg(m_transport->description())
+    );
+}
+
+void I2CWorker::setBusRecorder(std::unique_ptr<I2CBusRecorder> recorder) {
+    m_recorder = std::move(recorder);
+    if (m_recorder) {
+        DebugLogger::instance().info(
+            QString("Recording I2C traffic to %1").arg(m_recorder->path())
+        );
+    }
+}
+
+QString I2CWorker::connectionStateToString(const ConnectionState state) {
+    switch (state) {
+        case ConnectionState::Closed:       return "Closed";
+        case ConnectionState::Opening:      return "Opening";
+        case ConnectionState::Initializing: return "Initializing";
+        case ConnectionState::Ready:        return "Ready";
+        case ConnectionState::Degraded:     return "Degraded";
+        case ConnectionState::Recovering:   return "Recovering";
+        default:                            return "Unknown";
+    }
+}
+
+void I2CWorker::requestRecovery(const QString &reason) {
+    if (!m_is_initialized || m_state == ConnectionState::Closed) {
+        return;
+    }
+
+    for (const auto &device: m_devices) {
+        if (device->state != ConnectionState::Recovering) {
+            scheduleRecovery(*device, reason);
+        }
+    }
+}
+
+// Connection State Machine
+
+void I2CWorker::setState(const ConnectionState state) {
+    if (m_state == state) {
+        return;
+    }
+
+    DebugLogger::instance().info(
+        QString("I2C state: %1 -> %2")
+        .arg(connectionStateToString(m_state), connectionStateToString(state))
+    );
+
+    m_state = state;
+    emit connectionStateChanged(state);
+}
+
+void I2CWorker::setDeviceState(Device &device, const ConnectionState state) {
+    if (device.state == state) {
+        return;
+    }
+
+    // With one board the overall state line says the same thing
+    if (m_devices.size() > 1) {
+        DebugLogger::instance().info(
+            QString("%1I2C state: %2 -> %3")
+            .arg(logPrefix(device),
+                 connectionStateToString(device.state),
+                 connectionStateToString(state))
+        );
+    }
+
+    device.state = state;
+    device.stateGauge->set(static_cast<double>(state));
+    FlightRecorder::instance().record(FlightRecorder::Type::LinkState, static_cast<uint8_t>(state),
+                                      device.config.address, 0, connectionStateToString(state));
+    emit deviceStateChanged(device.config.address, state);
+    updateAggregateState();
+}
+
+void I2CWorker::updateAggregateState() {
+    if (m_devices.empty()) {
+        setState(ConnectionState::Closed);
+        return;
+    }
+
+    const auto ready = std::ranges::count_if(m_devices, [](const auto &device) {
+        return device->state == ConnectionState::Ready;
+    });
+    const auto operational = std::ranges::count_if(m_devices, [](const auto &device) {
+        return isOperational(*device);
+    });
+
+    if (ready == static_cast<std::ptrdiff_t>(m_devices.size())) {
+        setState(ConnectionState::Ready);
+    } else if (operational > 0) {
+        setState(ConnectionState::Degraded);
+    } else {
+        setState(primaryDevice().state);
+    }
+}
+
+void I2CWorker::scheduleStateTimer(const Device &device, const int delayMs) {
+    if (!device.stateTimer) {
+        return;
+    }
+
+    device.stateTimer->start(delayMs);
+}
+
+void I2CWorker::scheduleRecovery(Device &device, const QString &reason) {
+    // The handle is shared: only drop it once no other board is using it
+    const bool busInUse = std::ranges::any_of(m_devices, [&device](const auto &other) {
+        return other.get() != &device &&
+               (isOperational(*other) || other->state == ConnectionState::Initializing);
+    });
+    if (!busInUse) {
+        stopPolling();
+        closeHandle();
+    }
+
+    DebugLogger::instance().warning(
+        QString("%1I2C recovery in %2 ms: %3")
+        .arg(logPrefix(device)).arg(device.backoffMs).arg(reason)
+    );
+
+    static MetricsRegistry::Counter &recoveries = MetricsRegistry::instance().counter(
+        "allesspitze_i2c_recoveries_total", "I2C board recoveries scheduled after errors");
+    recoveries.increment();
+
+    setDeviceState(device, ConnectionState::Recovering);
+    scheduleStateTimer(device, device.backoffMs);
+    device.backoffMs = qMin(device.backoffMs * 2, MAX_BACKOFF_MS);
+}
+
+void I2CWorker::onStateTimeout(Device &device) {
+    switch (device.state) {
+        case ConnectionState::Initializing:
+            initDevice(device);
+            break;
+
+        case ConnectionState::Recovering: {
+            setDeviceState(device, ConnectionState::Opening);
+
+            QString error;
+            if (!m_transport->isOpen() && !openHandle(error)) {
+                scheduleRecovery(device, error);
+                return;
+            }
+
+            if (selectDevice(device)) {
+                flushI2CBuffers();
+            }
+            DebugLogger::instance().info(logPrefix(device) + "I2C reopened, re-sending INIT");
+
+            device.initAttempts = 0;
+            setDeviceState(device, ConnectionState::Initializing);
+            scheduleStateTimer(device, SETTLE_DELAY_MS);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void I2CWorker::noteTransactionResult(Device &device, const bool success) {
+    if (success) {
+        device.consecutiveErrors = 0;
+        device.errorsGauge->set(0);
+        if (device.state == ConnectionState::Degraded) {
+            setDeviceState(device, ConnectionState::Ready);
+        }
         return;
     }
 
-    m_device_address = deviceAddress;
-    const QString success =
-            QString("I2C device opened successfully at address: 0x%1")
-            .arg(deviceAddress, 2, 16, QChar('0'));
-    DebugLogger::instance().info(success);
-    emit deviceOpened(true, success);
+    device.consecutiveErrors++;
+    device.errorsGauge->set(device.consecutiveErrors);
+
+    if (device.state == ConnectionState::Ready &&
+        device.consecutiveErrors >= DEGRADED_ERROR_THRESHOLD) {
+        setDeviceState(device, ConnectionState::Degraded);
+    }
 
-    // Wait longer before INIT to let Arduino stabilize
-    QTimer::singleShot(500, this, &I2CWorker::sendInit);
+    if (device.consecutiveErrors >= MAX_CONSECUTIVE_ERRORS) {
+        DebugLogger::instance().error(
+            logPrefix(device) + "Too many consecutive errors, attempting recovery..."
+        );
+        device.consecutiveErrors = 0;
+        device.errorsGauge->set(0);
+        scheduleRecovery(
+            device,
+            QString("%1 consecutive transaction failures")
+            .arg(MAX_CONSECUTIVE_ERRORS)
+        );
+    }
 }
 
 // Protocol Implementation
 
 void I2CWorker::sendInit() {
-    if (!checkInitialized()) return;
+    for (const auto &device: m_devices) {
+        initDevice(*device);
+    }
+}
 
-    QMutexLocker locker(&m_i2c_mutex);
+void I2CWorker::initDevice(Device &device) {
+    if (!checkInitialized()) {
+        scheduleRecovery(device, "I2C bus not open");
+        return;
+    }
 
-    DebugLogger::instance().info("Sending INIT command...");
+    BusLock locker(this);
 
-    QByteArray response;
+    DebugLogger::instance().info(logPrefix(device) + "Sending INIT command...");
 
-    if (const bool success = sendCommandWithRetry(CMD_INIT, QByteArray(), response);
-        success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
+    I2CPacket::ResponseView response;
+
+    if (const bool success = sendCommandWithRetry(device, CMD_INIT, {}, response);
+        success && response.isComplete()) {
+        const auto status = response.status();
         DebugLogger::instance().info(
-            QString("INIT complete with status: 0x%1")
+            QString("%1INIT complete with status: 0x%2")
+            .arg(logPrefix(device))
             .arg(status, 2, 16, QChar('0'))
         );
-        m_is_ready = true;
+        device.initAttempts = 0;
+        device.consecutiveErrors = 0;
+        device.errorsGauge->set(0);
+        device.backoffMs = INITIAL_BACKOFF_MS;
+        setDeviceState(device, ConnectionState::Ready);
         emit initComplete(status == 0x00, status);
 
-        startPolling(200);
+        // With a data-ready line the timer only catches missed edges
+        if (!m_poll_timer || !m_poll_timer->isActive()) {
+            startPolling(m_data_ready ? FALLBACK_POLL_INTERVAL_MS : POLL_INTERVAL_MS);
+        }
+
+        // A fresh INIT means the Arduino came up blank: replay everything
+        device.shadow.invalidate();
+        flushShadow(device);
     } else {
-        DebugLogger::instance().error("INIT failed - retrying in 2 seconds");
-        m_is_ready = false;
+        device.initAttempts++;
         emit initComplete(false, 0xFF);
 
-        QTimer::singleShot(2000, this, &I2CWorker::sendInit);
+        if (device.initAttempts >= MAX_INIT_ATTEMPTS) {
+            scheduleRecovery(
+                device,
+                QString("INIT not acknowledged after %1 attempts")
+                .arg(device.initAttempts)
+            );
+            return;
+        }
+
+        DebugLogger::instance().error(
+            QString("%1INIT failed - retrying in %2 ms")
+            .arg(logPrefix(device)).arg(device.backoffMs)
+        );
+        setDeviceState(device, ConnectionState::Initializing);
+        scheduleStateTimer(device, device.backoffMs);
+        device.backoffMs = qMin(device.backoffMs * 2, MAX_BACKOFF_MS);
     }
 }
 
 void I2CWorker::sendHealthCheck() {
-    if (!checkInitialized() || !m_is_ready) return;
+    if (!checkInitialized() || !isOperational()) return;
 
-    QMutexLocker locker(&m_i2c_mutex);
+    BusLock locker(this);
 
-    QByteArray response;
+    // One result for the whole bus: the first failure or non-zero status wins
+    bool allSucceeded = true;
+    uint8_t worstStatus = 0x00;
 
-    if (const bool success = sendCommandWithRetry(CMD_HEALTHCHECK, QByteArray(), response);
-        success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
-        emit healthCheckComplete(status == 0x00, status);
+    for (const auto &device: m_devices) {
+        if (!checkInitialized() || !isOperational(*device)) {
+            continue;
+        }
+
+        I2CPacket::ResponseView response;
+
+        if (const bool success = sendCommandWithRetry(*device, CMD_HEALTHCHECK, {}, response);
+            success && response.isComplete()) {
+            if (worstStatus == 0x00) {
+                worstStatus = response.status();
+            }
+            noteTransactionResult(*device, true);
+        } else {
+            DebugLogger::instance().error(logPrefix(*device) + "HEALTHCHECK failed");
+            noteTransactionResult(*device, false);
+            allSucceeded = false;
+        }
+    }
+
+    if (allSucceeded) {
+        emit healthCheckComplete(worstStatus == 0x00, worstStatus);
     } else {
-        DebugLogger::instance().error("HEALTHCHECK failed");
         emit healthCheckComplete(false, 0xFF);
     }
 }
 
 void I2CWorker::pollButtonEvents() {
-    if (!checkInitialized() || !m_is_ready) {
-        return;
-    }
+    pollRound();
+}
 
-    QMutexLocker locker(&m_i2c_mutex);
+void I2CWorker::onDataReady() {
+    m_data_ready->acknowledge();
 
-    QByteArray response;
-    const bool success = sendCommandWithRetry(
-        CMD_POLL_BUTTON_EVENTS,
-        QByteArray(),
-        response
-    );
+    // The poll reply carries every queued event, but presses can land while
+    // it is in flight; keep reading until the Arduinos report nothing new
+    for (int i = 0; i < MAX_DATA_READY_POLLS; ++i) {
+        if (pollRound() <= 0) {
+            break;
+        }
+    }
+}
 
-    if (success && response.size() >= 4) {
-        const auto count = static_cast<uint8_t>(response[2]);
-        QVector<uint8_t> buttonIds;
+void I2CWorker::onCommandsReady() {
+    if (const uint64_t overflows = m_commands.overflows(); overflows != m_reported_overflows) {
+        DebugLogger::instance().warning(
+            QString("I2C command ring full, %1 command(s) spilled so far").arg(overflows)
+        );
+        m_reported_overflows = overflows;
+    }
 
-        for (int i = 0; i < count && (3 + i) < response.size() - 1; ++i) {
-            buttonIds.append(static_cast<uint8_t>(response[3 + i]));
+    m_commands.drain([this](const I2CCommand &command) {
+        // Continues the flow of the GUI-thread action that posted it
+        Trace::FlowScope flow(command.traceFlow);
+        Trace::Span span("i2c", traceName(command.type));
+        switch (command.type) {
+            case I2CCommand::Type::HighlightButton:
+                highlightButton(command.id, command.value != 0);
+                break;
+            case I2CCommand::Type::HighlightTower:
+                highlightTower(command.id, command.value);
+                break;
+            case I2CCommand::Type::UpdateBalance:
+                setUserBalance(command.balanceCents);
+                break;
+            case I2CCommand::Type::PlayAnimation:
+                playAnimation(command.id);
+                break;
+            case I2CCommand::Type::StopAnimation:
+                stopAnimation();
+                break;
         }
+    });
+}
 
-        // Only log when buttons are actually pressed
-        if (count > 0) {
-            DebugLogger::instance().info(
-                QString("Button events: %1 button(s) pressed").arg(count)
-            );
+int I2CWorker::pollRound() {
+    if (!checkInitialized() || !isOperational()) {
+        return -1;
+    }
+
+    Trace::Span span("i2c", "pollRound");
+    BusLock locker(this);
+
+    using SteadyClock = std::chrono::steady_clock;
+    struct PendingPoll {
+        Device *device = nullptr;
+        bool written = false;
+    };
+
+    // Boards take their turn first in rotation so none is always served last
+    const std::size_t deviceCount = m_devices.size();
+    const std::size_t first = m_next_device % deviceCount;
+    m_next_device = (first + 1) % deviceCount;
+
+    // Every board gets its POLL before we wait, so a round costs one
+    // response window however many boards are on the bus
+    const I2CPacket::TxPacket packet(CMD_POLL_BUTTON_EVENTS, {});
+    const SteadyClock::time_point started = SteadyClock::now();
+    std::array<PendingPoll, I2CDeviceMap::MAX_DEVICES> pending{};
+    std::size_t pendingCount = 0;
+
+    for (std::size_t n = 0; n < deviceCount && pendingCount < pending.size(); ++n) {
+        Device &device = *m_devices[(first + n) % deviceCount];
+        if (!isOperational(device)) {
+            continue;
         }
 
-        m_consecutive_errors = 0;
-        emit buttonEventsReceived(buttonIds);
-    } else {
-        m_consecutive_errors++;
+        PendingPoll &poll = pending[pendingCount++];
+        poll.device = &device;
 
-        // Only log errors occasionally
-        if (m_consecutive_errors % 10 == 1) {
-            DebugLogger::instance().warning(
-                QString("Button polling failed (consecutive errors: %1)")
-                .arg(m_consecutive_errors)
-            );
+        m_telemetry.recordFrame(CMD_POLL_BUTTON_EVENTS);
+        poll.written = selectDevice(device) && sendPacket(packet.bytes());
+        captureFrame(device, I2CBusRecorder::Direction::Tx,
+                     poll.written ? I2CBusRecorder::Outcome::Sent : I2CBusRecorder::Outcome::WriteFailed,
+                     CMD_POLL_BUTTON_EVENTS, 0, packet.bytes());
+    }
+
+    if (pendingCount == 0) {
+        return -1;
+    }
+
+    waitForResponse();
+
+    QVector<uint8_t> buttonIds;
+    qint64 decodedAtNs = 0;
+    int eventCount = 0;
+    bool anySucceeded = false;
+
+    for (std::size_t n = 0; n < pendingCount; ++n) {
+        Device &device = *pending[n].device;
+
+        I2CPacket::ResponseView response;
+        bool success = false;
+        if (pending[n].written && selectDevice(device)) {
+            response = receivePacket();
+            success = checkResponse(device, CMD_POLL_BUTTON_EVENTS, 0, response);
+            if (success) {
+                m_telemetry.recordResult(
+                    CMD_POLL_BUTTON_EVENTS, true,
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                        SteadyClock::now() - started).count()));
+            }
+        }
+        if (!success) {
+            // Fall back to stop-and-wait for this board only
+            success = runTransaction(device, packet, 1, started, response);
         }
 
-        if (m_consecutive_errors >= MAX_CONSECUTIVE_ERRORS) {
-            DebugLogger::instance().error(
-                "Too many consecutive errors, attempting reinit..."
-            );
-            m_is_ready = false;
-            if (reinitializeI2C()) {
-                m_consecutive_errors = 0;
-                QTimer::singleShot(500, this, &I2CWorker::sendInit);
+        if (!success || !response.isComplete()) {
+            // Only log errors occasionally
+            if (device.consecutiveErrors % 10 == 0) {
+                DebugLogger::instance().warning(
+                    QString("%1Button polling failed (consecutive errors: %2)")
+                    .arg(logPrefix(device))
+                    .arg(device.consecutiveErrors + 1)
+                );
             }
+            noteTransactionResult(device, false);
+            continue;
         }
 
-        emit buttonEventsReceived(QVector<uint8_t>());
+        anySucceeded = true;
+        noteTransactionResult(device, true);
+
+        // Idle polls end here without touching the heap; only actual
+        // presses build a list and cross the thread boundary
+        const auto count = response.status();
+        const auto ids = response.payload().subspan(1);
+        if (count > 0 && decodedAtNs == 0) {
+            decodedAtNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                SteadyClock::now().time_since_epoch()).count();
+        }
+        for (std::size_t i = 0; i < count && i < ids.size(); ++i) {
+            if (ids[i] >= device.config.buttons.size()) {
+                DebugLogger::instance().warning(
+                    QString("%1Button event for unmapped button %2")
+                    .arg(logPrefix(device)).arg(ids[i])
+                );
+                continue;
+            }
+            buttonIds.append(device.config.buttons[ids[i]]);
+        }
+        eventCount += count;
     }
+
+    if (!buttonIds.isEmpty()) {
+        DebugLogger::instance().info(
+            QString("Button events: %1 button(s) pressed").arg(buttonIds.size())
+        );
+        // A press is where the button-to-LED chain starts
+        const uint32_t flow = Trace::newFlow();
+        Trace::flowStart(flow);
+        emit buttonEventsReceived(buttonIds, flow, decodedAtNs);
+    }
+    span.setArg("events", eventCount);
+
+    // Retry anything a failed write left behind, a few fields per board per
+    // round so one board's backlog cannot hold up everyone's polls
+    for (std::size_t n = 0; n < deviceCount; ++n) {
+        Device &device = *m_devices[(first + n) % deviceCount];
+        if (checkInitialized() && isOperational(device) && device.shadow.dirty()) {
+            flushShadow(device, MAX_FLUSH_PER_ROUND);
+        }
+    }
+
+    return anySucceeded ? eventCount : -1;
 }
 
 void I2CWorker::highlightButton(const uint8_t buttonId, const bool state) {
-    if (!checkInitialized() || !m_is_ready) return;
+    const Route route = m_button_routes[buttonId];
+    if (route.device < 0) {
+        DebugLogger::instance().error(
+            QString("HIGHLIGHT_BUTTON: button 0x%1 is not routed to a device")
+            .arg(buttonId, 2, 16, QChar('0'))
+        );
+        emit highlightButtonComplete(false, 0xFF);
+        return;
+    }
+
+    Device &device = *m_devices[static_cast<std::size_t>(route.device)];
+    device.shadow.buttons[route.local].set(state);
+
+    if (!checkInitialized() || !isOperational(device)) return;
+
+    BusLock locker(this);
+    flushShadow(device);
+}
 
-    QMutexLocker locker(&m_i2c_mutex);
+void I2CWorker::highlightTower(const uint8_t towerId, const uint8_t row) {
+    const Route route = m_tower_routes[towerId];
+    if (route.device < 0) {
+        DebugLogger::instance().error(
+            QString("HIGHLIGHT_TOWER: tower 0x%1 is not routed to a device")
+            .arg(towerId, 2, 16, QChar('0'))
+        );
+        emit highlightTowerComplete(false, 0xFF);
+        return;
+    }
+
+    Device &device = *m_devices[static_cast<std::size_t>(route.device)];
+    device.shadow.towers[route.local].set(row);
+
+    if (!checkInitialized() || !isOperational(device)) return;
+
+    BusLock locker(this);
+    flushShadow(device);
+}
 
-    QByteArray data;
-    data.append(static_cast<char>(buttonId));
-    data.append(static_cast<char>(state ? 0x01 : 0x00));
+bool I2CWorker::sendHighlightButton(Device &device, const uint8_t buttonId, const bool state) {
+    const std::array<uint8_t, 2> data = {buttonId, static_cast<uint8_t>(state ? 0x01 : 0x00)};
 
-    QByteArray response;
+    I2CPacket::ResponseView response;
 
-    if (const bool success = sendCommandWithRetry(CMD_HIGHLIGHT_BUTTON, data, response);
-        success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
+    if (const bool success = sendCommandWithRetry(device, CMD_HIGHLIGHT_BUTTON, data, response);
+        success && response.isComplete()) {
+        const auto status = response.status();
         DebugLogger::instance().debug(
-            QString("HIGHLIGHT_BUTTON (ID: 0x%1, State: %2) status: 0x%3")
+            QString("%1HIGHLIGHT_BUTTON (ID: 0x%2, State: %3) status: 0x%4")
+            .arg(logPrefix(device))
             .arg(buttonId, 2, 16, QChar('0'))
             .arg(state)
             .arg(status, 2, 16, QChar('0'))
         );
+        noteTransactionResult(device, true);
         emit highlightButtonComplete(status == 0x00, status);
-    } else {
-        DebugLogger::instance().error("HIGHLIGHT_BUTTON failed");
-        emit highlightButtonComplete(false, 0xFF);
+        return true;
     }
-}
-
-void I2CWorker::highlightTower(const uint8_t towerId, const uint8_t row) {
-    if (!checkInitialized() || !m_is_ready) return;
 
-    QMutexLocker locker(&m_i2c_mutex);
+    DebugLogger::instance().error(logPrefix(device) + "HIGHLIGHT_BUTTON failed");
+    noteTransactionResult(device, false);
+    emit highlightButtonComplete(false, 0xFF);
+    return false;
+}
 
-    QByteArray data;
-    data.append(static_cast<char>(towerId));
-    data.append(static_cast<char>(row));
+bool I2CWorker::sendHighlightTower(Device &device, const uint8_t towerId, const uint8_t row) {
+    const std::array<uint8_t, 2> data = {towerId, row};
 
-    QByteArray response;
+    I2CPacket::ResponseView response;
 
-    if (const bool success = sendCommandWithRetry(CMD_HIGHLIGHT_TOWER, data, response);
-        success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
+    if (const bool success = sendCommandWithRetry(device, CMD_HIGHLIGHT_TOWER, data, response);
+        success && response.isComplete()) {
+        const auto status = response.status();
         DebugLogger::instance().debug(
-            QString("HIGHLIGHT_TOWER (ID: 0x%1, Row: %2) status: 0x%3")
+            QString("%1HIGHLIGHT_TOWER (ID: 0x%2, Row: %3) status: 0x%4")
+            .arg(logPrefix(device))
             .arg(towerId, 2, 16, QChar('0'))
             .arg(row)
             .arg(status, 2, 16, QChar('0'))
         );
+        noteTransactionResult(device, true);
         emit highlightTowerComplete(status == 0x00, status);
-    } else {
-        DebugLogger::instance().error("HIGHLIGHT_TOWER failed");
-        emit highlightTowerComplete(false, 0xFF);
+        return true;
     }
+
+    DebugLogger::instance().error(logPrefix(device) + "HIGHLIGHT_TOWER failed");
+    noteTransactionResult(device, false);
+    emit highlightTowerComplete(false, 0xFF);
+    return false;
 }
 
 void I2CWorker::updateUserName(const QString &username) {
-    if (!checkInitialized() || !m_is_ready) return;
+    if (!checkInitialized() || !isOperational()) return;
 
-    QMutexLocker locker(&m_i2c_mutex);
+    BusLock locker(this);
 
     const QByteArray data = username.toUtf8();
     if (data.size() > 255) {
@@ -253,116 +797,260 @@ void I2CWorker::updateUserName(const QString &username) {
         return;
     }
 
-    QByteArray response;
+    const std::span bytes(reinterpret_cast<const uint8_t *>(data.constData()),
+                          static_cast<std::size_t>(data.size()));
 
-    if (const bool success = sendCommandWithRetry(CMD_UPDATE_USER_NAME, data, response);
-        success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
-        DebugLogger::instance().info(
-            QString("UPDATE_USER_NAME (%1) status: 0x%2")
-            .arg(username)
-            .arg(status, 2, 16, QChar('0'))
-        );
-        emit userNameUpdated(status == 0x00, status);
-    } else {
-        DebugLogger::instance().error("UPDATE_USER_NAME failed");
-        emit userNameUpdated(false, 0xFF);
+    for (const auto &device: m_devices) {
+        if (!device->config.display || !checkInitialized() || !isOperational(*device)) {
+            continue;
+        }
+
+        I2CPacket::ResponseView response;
+
+        if (const bool success = sendCommandWithRetry(*device, CMD_UPDATE_USER_NAME, bytes, response);
+            success && response.isComplete()) {
+            const auto status = response.status();
+            DebugLogger::instance().info(
+                QString("%1UPDATE_USER_NAME (%2) status: 0x%3")
+                .arg(logPrefix(*device), username)
+                .arg(status, 2, 16, QChar('0'))
+            );
+            noteTransactionResult(*device, true);
+            emit userNameUpdated(status == 0x00, status);
+        } else {
+            DebugLogger::instance().error(logPrefix(*device) + "UPDATE_USER_NAME failed");
+            noteTransactionResult(*device, false);
+            emit userNameUpdated(false, 0xFF);
+        }
     }
 }
 
 void I2CWorker::updateUserBalance(double balance) {
-    if (!checkInitialized() || !m_is_ready) return;
+    // Convert to cents (multiply by 100) for transmission as int32
+    setUserBalance(static_cast<int32_t>(balance * 100.0));
+}
+
+void I2CWorker::setUserBalance(const int32_t balanceCents) {
+    for (const auto &device: m_devices) {
+        if (device->config.display) {
+            device->shadow.balanceCents.set(balanceCents);
+        }
+    }
 
-    QMutexLocker locker(&m_i2c_mutex);
+    if (!checkInitialized() || !isOperational()) return;
 
-    // Convert to cents (multiply by 100) for transmission as int32
-    int32_t balanceCents = static_cast<int32_t>(balance * 100.0);
+    BusLock locker(this);
+    for (const auto &device: m_devices) {
+        if (device->config.display && checkInitialized() && isOperational(*device)) {
+            flushShadow(*device);
+        }
+    }
+}
 
-    QByteArray data;
-    data.append(static_cast<char>(balanceCents & 0xFF));
-    data.append(static_cast<char>((balanceCents >> 8) & 0xFF));
-    data.append(static_cast<char>((balanceCents >> 16) & 0xFF));
-    data.append(static_cast<char>((balanceCents >> 24) & 0xFF));
+bool I2CWorker::sendUserBalance(Device &device, const int32_t balanceCents) {
+    const auto data = I2CPacket::encodeInt32(balanceCents);
 
-    QByteArray response;
+    I2CPacket::ResponseView response;
     const bool success =
-            sendCommandWithRetry(CMD_UPDATE_USER_BALANCE, data, response);
+            sendCommandWithRetry(device, CMD_UPDATE_USER_BALANCE, data, response);
 
-    if (success && response.size() >= 4) {
-        const auto status = static_cast<uint8_t>(response[2]);
+    if (success && response.isComplete()) {
+        const auto status = response.status();
         DebugLogger::instance().info(
-            QString("UPDATE_USER_BALANCE (%1) status: 0x%2")
-            .arg(balance, 0, 'f', 2)
+            QString("%1UPDATE_USER_BALANCE (%2) status: 0x%3")
+            .arg(logPrefix(device))
+            .arg(balanceCents / 100.0, 0, 'f', 2)
             .arg(status, 2, 16, QChar('0'))
         );
+        noteTransactionResult(device, true);
         emit userBalanceUpdated(status == 0x00, status);
-    } else {
-        DebugLogger::instance().error("UPDATE_USER_BALANCE failed");
-        emit userBalanceUpdated(false, 0xFF);
+        return true;
     }
+
+    DebugLogger::instance().error(logPrefix(device) + "UPDATE_USER_BALANCE failed");
+    noteTransactionResult(device, false);
+    emit userBalanceUpdated(false, 0xFF);
+    return false;
 }
 
-// Protocol Helper Methods
+void I2CWorker::defineAnimation(const uint8_t slot, const LedAnimation &animation) {
+    if (slot >= LedAnimation::MAX_SLOTS || !animation.valid()) {
+        DebugLogger::instance().error(
+            QString("UPLOAD_ANIMATION: invalid program for slot %1").arg(slot)
+        );
+        emit animationCommandComplete(CMD_UPLOAD_ANIMATION, false, 0xFF);
+        return;
+    }
 
-void I2CWorker::flushI2CBuffers() const {
-    if (m_i2c_fd < 0) return;
+    for (const auto &device: m_devices) {
+        device->shadow.animations[slot].set(animation);
+    }
+
+    if (!checkInitialized() || !isOperational()) return;
 
-    // Simple flush - try to read any pending data
-    uint8_t dummy[256];
-    fcntl(m_i2c_fd, F_SETFL, O_NONBLOCK);
-    while (read(m_i2c_fd, dummy, sizeof(dummy)) > 0) {
-        // Discard all pending data
+    BusLock locker(this);
+    for (const auto &device: m_devices) {
+        if (checkInitialized() && isOperational(*device)) {
+            flushShadow(*device);
+        }
     }
-    fcntl(m_i2c_fd, F_SETFL, 0); // Back to blocking
 }
 
-bool I2CWorker::reinitializeI2C() {
-    DebugLogger::instance().warning("Attempting to reinitialize I2C...");
+void I2CWorker::playAnimation(const uint8_t slot) {
+    if (slot >= LedAnimation::MAX_SLOTS || m_devices.empty() ||
+        !primaryDevice().shadow.animations[slot].hasDesired) {
+        DebugLogger::instance().error(
+            QString("PLAY_ANIMATION: slot %1 has no program").arg(slot)
+        );
+        emit animationCommandComplete(CMD_PLAY_ANIMATION, false, 0xFF);
+        return;
+    }
+
+    if (!checkInitialized() || !isOperational()) return;
+
+    BusLock locker(this);
+    const std::array<uint8_t, 1> data = {slot};
+    sendAnimationCommand(CMD_PLAY_ANIMATION, data);
+}
+
+void I2CWorker::stopAnimation() {
+    if (!checkInitialized() || !isOperational()) return;
+
+    BusLock locker(this);
+    sendAnimationCommand(CMD_STOP_ANIMATION, {});
+}
+
+bool I2CWorker::sendAnimation(Device &device, const uint8_t slot, const LedAnimation &animation) {
+    const auto data = animation.encode(slot);
+
+    I2CPacket::ResponseView response;
 
-    if (m_i2c_fd >= 0) {
-        close(m_i2c_fd);
-        m_i2c_fd = -1;
+    if (const bool success = sendCommandWithRetry(device, CMD_UPLOAD_ANIMATION, data, response);
+        success && response.isComplete()) {
+        const auto status = response.status();
+        DebugLogger::instance().debug(
+            QString("%1UPLOAD_ANIMATION (slot %2, effect %3) status: 0x%4")
+            .arg(logPrefix(device))
+            .arg(slot)
+            .arg(static_cast<int>(animation.effect))
+            .arg(status, 2, 16, QChar('0'))
+        );
+        noteTransactionResult(device, true);
+        emit animationCommandComplete(CMD_UPLOAD_ANIMATION, status == 0x00, status);
+        return true;
     }
 
-    QThread::msleep(1000); // Longer wait
+    DebugLogger::instance().error(logPrefix(device) + "UPLOAD_ANIMATION failed");
+    noteTransactionResult(device, false);
+    emit animationCommandComplete(CMD_UPLOAD_ANIMATION, false, 0xFF);
+    return false;
+}
 
-    const auto i2cDevice = "/dev/i2c-1";
-    m_i2c_fd = open(i2cDevice, O_RDWR);
-    if (m_i2c_fd < 0) {
-        DebugLogger::instance().error("Failed to reopen I2C device");
-        return false;
+void I2CWorker::sendAnimationCommand(const uint8_t command, const std::span<const uint8_t> data) {
+    // Called with m_i2c_mutex held. Pending uploads go first so a program
+    // changed just before playing is the one that runs.
+    for (const auto &device: m_devices) {
+        if (!checkInitialized() || !isOperational(*device)) {
+            continue;
+        }
+
+        flushShadow(*device);
+
+        I2CPacket::ResponseView response;
+
+        if (const bool success = sendCommandWithRetry(*device, command, data, response);
+            success && response.isComplete()) {
+            const auto status = response.status();
+            noteTransactionResult(*device, true);
+            emit animationCommandComplete(command, status == 0x00, status);
+        } else {
+            DebugLogger::instance().error(
+                QString("%1%2 failed").arg(logPrefix(*device), I2CTelemetry::opcodeName(command))
+            );
+            noteTransactionResult(*device, false);
+            emit animationCommandComplete(command, false, 0xFF);
+        }
+    }
+}
+
+void I2CWorker::flushShadow(Device &device, int budget) {
+    // Called with m_i2c_mutex held. A reply with a non-zero status still
+    // counts as acknowledged (resending would only be rejected again); a
+    // failed transaction stops the flush and whatever is left dirty goes
+    // out on the next change, poll or INIT. Only ids the board owns are
+    // sent.
+    DeviceShadow &shadow = device.shadow;
+
+    const auto buttonCount = static_cast<uint8_t>(device.config.buttons.size());
+    for (uint8_t id = 0; id < buttonCount; ++id) {
+        auto &button = shadow.buttons[id];
+        if (!button.dirty()) continue;
+        if (budget-- <= 0 || !sendHighlightButton(device, id, button.desired)) return;
+        button.acknowledge();
     }
 
-    if (ioctl(m_i2c_fd, I2C_SLAVE, m_device_address) < 0) {
-        DebugLogger::instance().error("Failed to reset I2C slave address");
-        close(m_i2c_fd);
-        m_i2c_fd = -1;
+    const auto towerCount = static_cast<uint8_t>(device.config.towers.size());
+    for (uint8_t id = 0; id < towerCount; ++id) {
+        auto &tower = shadow.towers[id];
+        if (!tower.dirty()) continue;
+        if (budget-- <= 0 || !sendHighlightTower(device, id, tower.desired)) return;
+        tower.acknowledge();
+    }
+
+    if (device.config.display && shadow.balanceCents.dirty()) {
+        if (budget-- <= 0 || !sendUserBalance(device, shadow.balanceCents.desired)) return;
+        shadow.balanceCents.acknowledge();
+    }
+
+    for (uint8_t slot = 0; slot < LedAnimation::MAX_SLOTS; ++slot) {
+        auto &animation = shadow.animations[slot];
+        if (!animation.dirty()) continue;
+        if (budget-- <= 0 || !sendAnimation(device, slot, animation.desired)) return;
+        animation.acknowledge();
+    }
+}
+
+// Protocol Helper Methods
+
+void I2CWorker::flushI2CBuffers() const {
+    if (!m_transport->isOpen()) return;
+
+    m_transport->flush();
+}
+
+bool I2CWorker::openHandle(QString &error) {
+    if (!m_transport->open(primaryDevice().config.address, error)) {
+        DebugLogger::instance().error(error);
         return false;
     }
 
-    flushI2CBuffers();
-    DebugLogger::instance().info("I2C reinitialized successfully");
     return true;
 }
 
-QByteArray I2CWorker::buildPacket(const uint8_t command, const QByteArray &data) {
-    QByteArray packet;
-    packet.append(static_cast<char>(command));
-    packet.append(static_cast<char>(data.size()));
-    packet.append(data);
+void I2CWorker::closeHandle() {
+    m_transport->close();
+}
+
+bool I2CWorker::selectDevice(const Device &device) {
+    QString error;
+    if (!m_transport->selectAddress(device.config.address, error)) {
+        DebugLogger::instance().error(logPrefix(device) + error);
+        return false;
+    }
 
-    const uint8_t checksum = calculateChecksum(packet);
-    packet.append(static_cast<char>(checksum));
+    return true;
+}
 
-    return packet;
+QString I2CWorker::logPrefix(const Device &device) const {
+    return m_devices.size() > 1 ? QString("[%1] ").arg(device.config.name) : QString();
 }
 
-bool I2CWorker::sendPacket(const QByteArray &packet) const {
-    if (const ssize_t written = write(m_i2c_fd, packet.data(), packet.size());
-        written != packet.size()) {
+bool I2CWorker::sendPacket(const std::span<const uint8_t> packet) const {
+    if (const ssize_t written = m_transport->write(packet);
+        written != static_cast<ssize_t>(packet.size())) {
         DebugLogger::instance().error(
             QString("Failed to write packet: %1 (wrote %2/%3 bytes)")
-            .arg(strerror(errno))
+            .arg(m_transport->errorString())
             .arg(written)
             .arg(packet.size())
         );
@@ -372,50 +1060,51 @@ bool I2CWorker::sendPacket(const QByteArray &packet) const {
     return true;
 }
 
-QByteArray I2CWorker::receivePacket() const {
-    QThread::msleep(150);
-
-    uint8_t buffer[MAX_PACKET_SIZE];
+void I2CWorker::waitForResponse() const {
+    if (const int delayMs = m_transport->responseDelayMs(); delayMs > 0) {
+        Clock::instance().sleepMs(delayMs);
+    }
+}
 
-    ssize_t bytesRead = read(m_i2c_fd, buffer, MAX_PACKET_SIZE);
+I2CPacket::ResponseView I2CWorker::receivePacket() {
+    m_rx_buffer.clear();
+    const ssize_t bytesRead = m_transport->read(m_rx_buffer.storage());
 
     if (bytesRead < 0) {
         DebugLogger::instance().error(
-            QString("Read failed: %1").arg(strerror(errno))
+            QString("Read failed: %1").arg(m_transport->errorString())
         );
         return {};
     }
 
-    if (bytesRead < 4) {
+    if (bytesRead < static_cast<ssize_t>(I2CPacket::MIN_RESPONSE_SIZE)) {
         DebugLogger::instance().verbose(
             QString("Response too short: %1 bytes").arg(bytesRead)
         );
         return {};
     }
 
-    const uint8_t dataLength = buffer[1];
+    const I2CPacket::ResponseView response =
+            m_rx_buffer.commit(static_cast<std::size_t>(bytesRead));
 
-    if (const int expectedLength = 3 + dataLength;
-        bytesRead >= expectedLength) {
-        bytesRead = expectedLength;
-    } else {
+    if (const std::size_t expectedLength =
+                I2CPacket::HEADER_SIZE + response.length() + I2CPacket::CHECKSUM_SIZE;
+        response.size() < expectedLength) {
         DebugLogger::instance().warning(
             QString("Incomplete packet: expected %1, got %2 bytes")
             .arg(expectedLength)
-            .arg(bytesRead)
+            .arg(response.size())
         );
     }
 
-    return {reinterpret_cast<char *>(buffer), bytesRead};
+    return response;
 }
 
-bool I2CWorker::validateChecksum(const QByteArray &packet) {
+bool I2CWorker::validateChecksum(const I2CPacket::ResponseView &packet) {
     if (packet.size() < 3) return false;
 
-    const QByteArray dataForChecksum = packet.left(packet.size() - 1);
-    const uint8_t expectedChecksum = calculateChecksum(dataForChecksum);
-    const auto receivedChecksum =
-            static_cast<uint8_t>(packet[packet.size() - 1]);
+    const uint8_t expectedChecksum = packet.expectedChecksum();
+    const uint8_t receivedChecksum = packet.receivedChecksum();
 
     const bool valid = (expectedChecksum == receivedChecksum);
 
@@ -430,93 +1119,165 @@ bool I2CWorker::validateChecksum(const QByteArray &packet) {
     return valid;
 }
 
-uint8_t I2CWorker::calculateChecksum(const QByteArray &data) {
-    uint8_t checksum = 0;
-    for (const char byte: data) {
-        checksum ^= static_cast<uint8_t>(byte);
+void I2CWorker::captureFrame(const Device &device,
+                             const I2CBusRecorder::Direction direction,
+                             const I2CBusRecorder::Outcome outcome,
+                             const uint8_t command, const int attempt,
+                             const std::span<const uint8_t> bytes) const {
+    if (m_recorder) {
+        m_recorder->record(device.config.address, direction, outcome, command,
+                           static_cast<uint8_t>(attempt), bytes);
+    }
+}
+
+bool I2CWorker::checkResponse(const Device &device, const uint8_t command, const int attempt,
+                              const I2CPacket::ResponseView &response) {
+    if (response.empty()) {
+        DebugLogger::instance().warning(logPrefix(device) + "No response received");
+        m_telemetry.recordNoResponse(command);
+        captureFrame(device, I2CBusRecorder::Direction::Rx, I2CBusRecorder::Outcome::NoResponse,
+                     command, attempt, {});
+        return false;
+    }
+
+    // VERBOSE: Log received packet
+    /*DebugLogger::instance().verbose(
+        QString("RX (%1 bytes): %2")
+            .arg(response.size())
+            .arg(DebugLogger::formatHexDump(response.bytes().data(), response.size()))
+    );*/
+
+    if (!validateChecksum(response)) {
+        m_telemetry.recordChecksumFailure(command);
+        captureFrame(device, I2CBusRecorder::Direction::Rx, I2CBusRecorder::Outcome::ChecksumFailure,
+                     command, attempt, response.bytes());
+        return false;
+    }
+
+    const uint8_t expectedRsp = command | 0x80;
+
+    if (const auto receivedCmd = response.command(); receivedCmd != expectedRsp) {
+        DebugLogger::instance().error(
+            QString("%1Response mismatch. Expected 0x%2, got 0x%3")
+            .arg(logPrefix(device))
+            .arg(expectedRsp, 2, 16, QChar('0'))
+            .arg(receivedCmd, 2, 16, QChar('0'))
+        );
+        m_telemetry.recordMismatch(command);
+        captureFrame(device, I2CBusRecorder::Direction::Rx, I2CBusRecorder::Outcome::Mismatch,
+                     command, attempt, response.bytes());
+        return false;
     }
-    return checksum;
+
+    captureFrame(device, I2CBusRecorder::Direction::Rx, I2CBusRecorder::Outcome::Ok,
+                 command, attempt, response.bytes());
+    return true;
 }
 
 bool I2CWorker::sendCommandWithRetry(
+    Device &device,
     const uint8_t command,
-    const QByteArray &data,
-    QByteArray &response
-) const {
-    const QByteArray packet = buildPacket(command, data);
+    const std::span<const uint8_t> data,
+    I2CPacket::ResponseView &response
+) {
+    const I2CPacket::TxPacket packet(command, data);
+    if (packet.empty()) {
+        DebugLogger::instance().error(
+            QString("Payload for command 0x%1 too long: %2 bytes")
+            .arg(command, 2, 16, QChar('0'))
+            .arg(data.size())
+        );
+        return false;
+    }
 
     // VERBOSE: Log packet being sent
     /*DebugLogger::instance().verbose(
         QString("TX (%1 bytes): %2")
             .arg(packet.size())
-            .arg(DebugLogger::formatHexDump(packet))
+            .arg(DebugLogger::formatHexDump(packet.bytes().data(), packet.size()))
     );*/
 
-    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
+    return runTransaction(device, packet, 0, std::chrono::steady_clock::now(), response);
+}
+
+bool I2CWorker::runTransaction(
+    Device &device,
+    const I2CPacket::TxPacket &packet,
+    const int firstAttempt,
+    const std::chrono::steady_clock::time_point started,
+    I2CPacket::ResponseView &response
+) {
+    const uint8_t command = packet.command();
+    Trace::Span span("i2c", "transaction");
+    span.setArg("opcode", command);
+    const auto finish = [&](const bool success) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started);
+        m_telemetry.recordResult(command, success, static_cast<uint64_t>(elapsed.count()));
+        return success;
+    };
+
+    if (!selectDevice(device)) {
+        return finish(false);
+    }
+
+    // Retries go out back to back: each attempt already waits out the
+    // response window, and longer outages are handled by the state machine.
+    for (int attempt = firstAttempt; attempt < MAX_RETRIES; ++attempt) {
         if (attempt > 0) {
             DebugLogger::instance().warning(
-                QString("Retry %1/%2 for command 0x%3")
+                QString("%1Retry %2/%3 for command 0x%4")
+                .arg(logPrefix(device))
                 .arg(attempt + 1)
                 .arg(MAX_RETRIES)
                 .arg(command, 2, 16, QChar('0'))
             );
-            QThread::msleep(500);
+            m_telemetry.recordRetry(command);
         }
 
-        if (!sendPacket(packet)) {
+        m_telemetry.recordFrame(command);
+        if (!sendPacket(packet.bytes())) {
+            captureFrame(device, I2CBusRecorder::Direction::Tx, I2CBusRecorder::Outcome::WriteFailed,
+                         command, attempt, packet.bytes());
             continue;
         }
+        captureFrame(device, I2CBusRecorder::Direction::Tx, I2CBusRecorder::Outcome::Sent,
+                     command, attempt, packet.bytes());
 
+        waitForResponse();
         response = receivePacket();
-        if (response.isEmpty()) {
-            DebugLogger::instance().warning("No response received");
-            continue;
+        if (checkResponse(device, command, attempt, response)) {
+            return finish(true);
         }
-
-        // VERBOSE: Log received packet
-        /*DebugLogger::instance().verbose(
-            QString("RX (%1 bytes): %2")
-                .arg(response.size())
-                .arg(DebugLogger::formatHexDump(response))
-        );*/
-
-        if (!validateChecksum(response)) {
-            continue;
-        }
-
-        const uint8_t expectedRsp = command | 0x80;
-
-        if (const auto receivedCmd = static_cast<uint8_t>(response[0]); receivedCmd != expectedRsp) {
-            DebugLogger::instance().error(
-                QString("Response mismatch. Expected 0x%1, got 0x%2")
-                .arg(expectedRsp, 2, 16, QChar('0'))
-                .arg(receivedCmd, 2, 16, QChar('0'))
-            );
-            continue;
-        }
-
-        return true;
     }
 
     const QString error =
-            QString("Command 0x%1 failed after %2 retries")
+            QString("%1Command 0x%2 failed after %3 retries")
+            .arg(logPrefix(device))
             .arg(command, 2, 16, QChar('0'))
             .arg(MAX_RETRIES);
     DebugLogger::instance().error(error);
-    return false;
+    return finish(false);
 }
 
 bool I2CWorker::checkInitialized() const {
-    if (m_i2c_fd < 0) {
-        return false;
-    }
-    return true;
+    return m_transport->isOpen();
+}
+
+bool I2CWorker::isOperational() const {
+    return m_state == ConnectionState::Ready ||
+           m_state == ConnectionState::Degraded;
+}
+
+bool I2CWorker::isOperational(const Device &device) {
+    return device.state == ConnectionState::Ready ||
+           device.state == ConnectionState::Degraded;
 }
 
 void I2CWorker::startPolling(int intervalMs) {
     if (!m_poll_timer) {
-        m_poll_timer = new QTimer(this);
-        connect(m_poll_timer, &QTimer::timeout,
+        m_poll_timer = new ClockTimer(this);
+        connect(m_poll_timer, &ClockTimer::timeout,
                 this, &I2CWorker::pollButtonEvents);
     }
 
@@ -542,12 +1303,25 @@ void I2CWorker::sendRawCommand(uint8_t command, const QVariantList &data) {
         return;
     }
 
-    QMutexLocker locker(&m_i2c_mutex);
+    BusLock locker(this);
 
-    // Convert QVariantList to QByteArray
-    QByteArray byteData;
-    for (const QVariant &v : data) {
-        byteData.append(static_cast<char>(v.toInt() & 0xFF));
+    // Raw commands always go to the first board
+    Device &device = primaryDevice();
+
+    // Convert QVariantList to payload bytes
+    if (data.size() > static_cast<qsizetype>(I2CPacket::MAX_PAYLOAD_SIZE)) {
+        DebugLogger::instance().error(
+            QString("Raw command payload too long (max %1 bytes)")
+            .arg(I2CPacket::MAX_PAYLOAD_SIZE)
+        );
+        emit rawCommandResponse(command, false, QByteArray());
+        return;
+    }
+
+    std::array<uint8_t, I2CPacket::MAX_PAYLOAD_SIZE> payload{};
+    const std::span byteData(payload.data(), static_cast<std::size_t>(data.size()));
+    for (std::size_t i = 0; i < byteData.size(); ++i) {
+        byteData[i] = static_cast<uint8_t>(data[static_cast<qsizetype>(i)].toInt() & 0xFF);
     }
 
     DebugLogger::instance().info(
@@ -557,30 +1331,37 @@ void I2CWorker::sendRawCommand(uint8_t command, const QVariantList &data) {
     );
 
     // Log the data being sent
-    if (!byteData.isEmpty()) {
+    if (!byteData.empty()) {
         QString hexData;
-        for (int i = 0; i < byteData.size(); ++i) {
-            hexData += QString("%1 ").arg(static_cast<uint8_t>(byteData[i]), 2, 16, QChar('0'));
+        for (const uint8_t byte : byteData) {
+            hexData += QString("%1 ").arg(byte, 2, 16, QChar('0'));
         }
         DebugLogger::instance().info(QString("Data: %1").arg(hexData.trimmed()));
     }
 
-    QByteArray response;
-    const bool success = sendCommandWithRetry(command, byteData, response);
+    I2CPacket::ResponseView response;
+    const bool success = sendCommandWithRetry(device, command, byteData, response);
 
     if (success) {
         QString hexResponse;
-        for (int i = 0; i < response.size(); ++i) {
-            hexResponse += QString("%1 ").arg(static_cast<uint8_t>(response[i]), 2, 16, QChar('0'));
+        for (const uint8_t byte : response.bytes()) {
+            hexResponse += QString("%1 ").arg(byte, 2, 16, QChar('0'));
         }
         DebugLogger::instance().info(
             QString("Raw command response (%1 bytes): %2")
                 .arg(response.size())
                 .arg(hexResponse.trimmed())
         );
+        // A raw INIT resets the Arduino just like our own
+        if (command == CMD_INIT) {
+            device.shadow.invalidate();
+            flushShadow(device);
+        }
     } else {
         DebugLogger::instance().error("Raw command failed");
     }
 
-    emit rawCommandResponse(command, success, response);
+    emit rawCommandResponse(command, success,
+                            QByteArray(reinterpret_cast<const char *>(response.bytes().data()),
+                                       static_cast<qsizetype>(response.size())));
 }
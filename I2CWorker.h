@@ -4,10 +4,29 @@
 #include <QThread>
 #include <QString>
 #include <QByteArray>
-#include <QTimer>
 #include <QVector>
 #include <QMutex>
 #include <QVariantList>
+#include <QSocketNotifier>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <span>
+#include <vector>
+#include "Clock.h"
+#include "DataReadySource.h"
+#include "DeviceShadow.h"
+#include "I2CBusRecorder.h"
+#include "I2CCommandQueue.h"
+#include "I2CDeviceMap.h"
+#include "I2CPacket.h"
+#include "I2CTelemetry.h"
+#include "I2CTransport.h"
+#include "LedAnimation.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
 
 class I2CWorker : public QObject {
     Q_OBJECT
@@ -24,7 +43,10 @@ public:
         CMD_HIGHLIGHT_BUTTON = 0x04,
         CMD_HIGHLIGHT_TOWER = 0x05,
         CMD_UPDATE_USER_NAME = 0x06,
-        CMD_UPDATE_USER_BALANCE = 0x07
+        CMD_UPDATE_USER_BALANCE = 0x07,
+        CMD_UPLOAD_ANIMATION = 0x08,
+        CMD_PLAY_ANIMATION = 0x09,
+        CMD_STOP_ANIMATION = 0x0A
     };
 
     enum Response : uint8_t {
@@ -34,14 +56,79 @@ public:
         RSP_HIGHLIGHT_BUTTON = 0x84,
         RSP_HIGHLIGHT_TOWER = 0x85,
         RSP_UPDATE_USER_NAME = 0x86,
-        RSP_UPDATE_USER_BALANCE = 0x87
+        RSP_UPDATE_USER_BALANCE = 0x87,
+        RSP_UPLOAD_ANIMATION = 0x88,
+        RSP_PLAY_ANIMATION = 0x89,
+        RSP_STOP_ANIMATION = 0x8A
     };
 
+    // Link state as seen by the worker. Every board has its own state and
+    // recovery timer so the worker's event loop never sleeps; the overall
+    // state is Ready when all boards are, Degraded when only some are
+    // operational and otherwise follows the first board.
+    enum class ConnectionState : uint8_t {
+        Closed,       // No device handle
+        Opening,      // Opening /dev/i2c-1 and selecting the slave address
+        Initializing, // Handle open, waiting for RSP_INIT
+        Ready,        // INIT acknowledged, traffic flowing
+        Degraded,     // Ready, but recent transactions failed
+        Recovering    // Handle closed, waiting for the backoff to expire
+    };
+    Q_ENUM(ConnectionState)
+
+    [[nodiscard]] ConnectionState connectionState() const { return m_state; }
+
+    static QString connectionStateToString(ConnectionState state);
+
+    // Cumulative bus counters. Safe to read from any thread.
+    struct BusStatistics {
+        uint64_t transactions = 0;     // Commands issued through the retry loop
+        uint64_t attempts = 0;         // Frames actually written to the bus
+        uint64_t failures = 0;         // Commands that ran out of retries
+        uint64_t lockAcquisitions = 0;
+        uint64_t lockHoldNs = 0;       // Total time m_i2c_mutex was held
+        uint64_t maxLockHoldNs = 0;
+    };
+
+    [[nodiscard]] BusStatistics busStatistics() const;
+
+    // Per-opcode counters, written by the worker thread only. Snapshots
+    // may be taken from any thread.
+    [[nodiscard]] const I2CTelemetry &telemetry() const { return m_telemetry; }
+
+    // Optional data-ready line. Set before the worker thread starts; the
+    // notifier is created on the worker thread in initialize().
+    void setDataReadySource(std::shared_ptr<DataReadySource> source);
+
+    // Replace the default /dev/i2c-1 transport. Set before the worker
+    // thread starts.
+    void setTransport(std::unique_ptr<I2CTransport> transport);
+
+    // Capture every TX/RX frame. Set before the worker thread starts.
+    void setBusRecorder(std::unique_ptr<I2CBusRecorder> recorder);
+
+    // Queue an output change without a QMetaCallEvent per call. Commands run
+    // on the worker thread in order. GUI thread only (single producer).
+    void post(I2CCommand command) {
+        command.traceFlow = Trace::currentFlow();
+        m_commands.push(command);
+    }
+
+    [[nodiscard]] uint64_t commandOverflows() const { return m_commands.overflows(); }
+
+    // Boards on the bus and the buttons/towers/displays they own. Set
+    // before the worker thread starts; defaults to a single board at 0x42.
+    void setDeviceMap(const I2CDeviceMap &map);
+
 public slots:
     void initialize();
 
     void cleanup();
 
+    // Open the bus and bring up every board in the device map
+    void openDevices();
+
+    // Single-board shortcut: replaces the device map
     void openDevice(uint8_t deviceAddress);
 
     void sendInit();
@@ -58,12 +145,24 @@ public slots:
 
     void updateUserBalance(double balance);
 
+    // Keep an LED program uploaded to every board (see LedAnimation). Like
+    // the other outputs it is shadowed and re-sent after each INIT.
+    void defineAnimation(uint8_t slot, const LedAnimation &animation);
+
+    // Start a defined program on every board; one transaction per board
+    void playAnimation(uint8_t slot);
+
+    void stopAnimation();
+
     void startPolling(int intervalMs = 250); // NEW
     void stopPolling() const; // NEW
 
     // Debug interface - send any command with raw data
     Q_INVOKABLE void sendRawCommand(uint8_t command, const QVariantList &data);
 
+    // Drop the handle and reopen it after the current backoff delay
+    Q_INVOKABLE void requestRecovery(const QString &reason);
+
 signals:
     void initialization_complete();
 
@@ -75,7 +174,10 @@ signals:
 
     void healthCheckComplete(bool success, uint8_t status);
 
-    void buttonEventsReceived(const QVector<uint8_t> &buttonIds);
+    // traceFlow: the flow started at the poll, 0 while tracing is off.
+    // decodedAtNs: steady_clock time the first press was decoded, for
+    // InputLatency.
+    void buttonEventsReceived(const QVector<uint8_t> &buttonIds, quint32 traceFlow, qint64 decodedAtNs);
 
     void highlightButtonComplete(bool success, uint8_t status);
 
@@ -85,45 +187,183 @@ signals:
 
     void userBalanceUpdated(bool success, uint8_t status);
 
+    void animationCommandComplete(uint8_t command, bool success, uint8_t status);
+
     // Debug signal for raw command responses
     void rawCommandResponse(uint8_t command, bool success, const QByteArray &response);
 
+    void connectionStateChanged(I2CWorker::ConnectionState state);
+
+    void deviceStateChanged(uint8_t address, I2CWorker::ConnectionState state);
+
+private slots:
+    void onDataReady();
+
+    void onCommandsReady();
+
 private:
+    // One board on the bus. Shadows are indexed by the board's local ids.
+    struct Device {
+        I2CDeviceConfig config;
+        ConnectionState state = ConnectionState::Closed;
+        int consecutiveErrors = 0;
+        int initAttempts = 0;
+        int backoffMs = INITIAL_BACKOFF_MS;
+        DeviceShadow shadow;
+        ClockTimer *stateTimer = nullptr;
+        MetricsRegistry::Gauge *errorsGauge = nullptr; // consecutiveErrors
+        MetricsRegistry::Gauge *stateGauge = nullptr;  // ConnectionState as a number
+    };
+
+    // Global button/tower id -> owning board and its local id
+    struct Route {
+        int8_t device = -1;
+        uint8_t local = 0;
+    };
+
+    // Holds m_i2c_mutex for its lifetime and records the hold time
+    class BusLock {
+    public:
+        explicit BusLock(I2CWorker *worker);
+
+        ~BusLock();
+
+        BusLock(const BusLock &) = delete;
+
+        BusLock &operator=(const BusLock &) = delete;
+
+    private:
+        I2CWorker *m_worker;
+        std::chrono::steady_clock::time_point m_acquired;
+    };
+
     bool m_is_initialized = false;
-    bool m_is_ready = false;
-    int m_i2c_fd = -1;
-    uint8_t m_device_address = 0;
+    std::unique_ptr<I2CTransport> m_transport;
     QMutex m_i2c_mutex;
-    int m_consecutive_errors = 0;
-    QTimer *m_poll_timer = nullptr;
+    ConnectionState m_state = ConnectionState::Closed;
+    std::vector<std::unique_ptr<Device>> m_devices;
+    std::array<Route, 256> m_button_routes{};
+    std::array<Route, 256> m_tower_routes{};
+    std::size_t m_next_device = 0; // Round-robin start of the next poll round
+    I2CPacket::RxBuffer m_rx_buffer;
+    ClockTimer *m_poll_timer = nullptr;
+    std::shared_ptr<DataReadySource> m_data_ready;
+    QSocketNotifier *m_data_ready_notifier = nullptr;
+    I2CCommandQueue m_commands;
+    QSocketNotifier *m_command_notifier = nullptr;
+    uint64_t m_reported_overflows = 0;
+
+    I2CTelemetry m_telemetry;
+    std::unique_ptr<I2CBusRecorder> m_recorder;
+    std::atomic<uint64_t> m_stat_lock_acquisitions{0};
+    std::atomic<uint64_t> m_stat_lock_hold_ns{0};
+    std::atomic<uint64_t> m_stat_max_lock_hold_ns{0};
 
     static constexpr int MAX_RETRIES = 3;
     static constexpr int RESPONSE_TIMEOUT_MS = 150;
-    static constexpr int MAX_PACKET_SIZE = 256;
     static constexpr int MAX_CONSECUTIVE_ERRORS = 10;
+    static constexpr int DEGRADED_ERROR_THRESHOLD = 3;
+    static constexpr int MAX_INIT_ATTEMPTS = 5;
+    static constexpr int SETTLE_DELAY_MS = 500;  // After a recovery reopen; the first INIT goes out at once
+    static constexpr int INITIAL_BACKOFF_MS = 250;
+    static constexpr int MAX_BACKOFF_MS = 8000;
+    static constexpr int POLL_INTERVAL_MS = 200;
+    static constexpr int FALLBACK_POLL_INTERVAL_MS = 1000;
+    static constexpr int MAX_DATA_READY_POLLS = 4;
+    static constexpr int MAX_FLUSH_PER_ROUND = 4;  // Shadow writes per board per poll round
 
     [[nodiscard]] bool checkInitialized() const;
 
+    [[nodiscard]] bool isOperational() const;
+
+    [[nodiscard]] static bool isOperational(const Device &device);
+
+    [[nodiscard]] Device &primaryDevice() const { return *m_devices.front(); }
+
+    // "[name] " when more than one board is configured, for log lines
+    [[nodiscard]] QString logPrefix(const Device &device) const;
+
     void flushI2CBuffers() const;
 
-    bool reinitializeI2C();
+    bool openHandle(QString &error);
 
-    static QByteArray buildPacket(
-        uint8_t command,
-        const QByteArray &data = QByteArray()
-    );
+    void closeHandle();
+
+    bool selectDevice(const Device &device);
+
+    void setState(ConnectionState state);
+
+    void setDeviceState(Device &device, ConnectionState state);
+
+    void updateAggregateState();
+
+    // Per-device timers are created on the worker thread
+    void createStateTimers();
+
+    void scheduleStateTimer(const Device &device, int delayMs);
+
+    void onStateTimeout(Device &device);
+
+    void scheduleRecovery(Device &device, const QString &reason);
 
-    [[nodiscard]] bool sendPacket(const QByteArray &packet) const;
+    void noteTransactionResult(Device &device, bool success);
 
-    [[nodiscard]] QByteArray receivePacket() const;
+    void initDevice(Device &device);
 
-    static bool validateChecksum(const QByteArray &packet);
+    // Polls every operational board, pipelined. Returns the number of
+    // events read, or -1 if no board could be polled.
+    int pollRound();
 
-    static uint8_t calculateChecksum(const QByteArray &data);
+    // Sends at most budget dirty fields; the rest stay dirty
+    void flushShadow(Device &device, int budget = INT_MAX);
+
+    bool sendHighlightButton(Device &device, uint8_t buttonId, bool state);
+
+    bool sendHighlightTower(Device &device, uint8_t towerId, uint8_t row);
+
+    void setUserBalance(int32_t balanceCents);
+
+    bool sendUserBalance(Device &device, int32_t balanceCents);
+
+    bool sendAnimation(Device &device, uint8_t slot, const LedAnimation &animation);
+
+    // Play/stop on every operational board
+    void sendAnimationCommand(uint8_t command, std::span<const uint8_t> data);
+
+    [[nodiscard]] bool sendPacket(std::span<const uint8_t> packet) const;
+
+    // Waits out the Arduino's reply preparation time
+    void waitForResponse() const;
+
+    // The returned view points into m_rx_buffer and is valid until the next receive
+    [[nodiscard]] I2CPacket::ResponseView receivePacket();
+
+    // Validates a reply to command and records it; true if it can be used
+    bool checkResponse(const Device &device, uint8_t command, int attempt,
+                       const I2CPacket::ResponseView &response);
+
+    void captureFrame(const Device &device, I2CBusRecorder::Direction direction,
+                      I2CBusRecorder::Outcome outcome, uint8_t command, int attempt,
+                      std::span<const uint8_t> bytes) const;
+
+    static bool validateChecksum(const I2CPacket::ResponseView &packet);
 
     bool sendCommandWithRetry(
+        Device &device,
         uint8_t command,
-        const QByteArray &data,
-        QByteArray &response
-    ) const;
+        std::span<const uint8_t> data,
+        I2CPacket::ResponseView &response
+    );
+
+    // Attempts firstAttempt..MAX_RETRIES-1 of a transaction that started at
+    // started; the pipelined poll uses it to retry its first attempt
+    bool runTransaction(
+        Device &device,
+        const I2CPacket::TxPacket &packet,
+        int firstAttempt,
+        std::chrono::steady_clock::time_point started,
+        I2CPacket::ResponseView &response
+    );
 };
+
+Q_DECLARE_METATYPE(LedAnimation)
@@ -0,0 +1,133 @@
+#include "InputLatency.h"
+#include <algorithm>
+#include <vector>
+#include "MetricsRegistry.h"
+#include "Trace.h"
+
+namespace {
+    double toMs(const int64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    // Nearest-rank percentiles of an unsorted copy
+    InputLatency::Percentiles percentiles(std::vector<int64_t> values) {
+        InputLatency::Percentiles result;
+        if (values.empty()) {
+            return result;
+        }
+
+        std::sort(values.begin(), values.end());
+        const auto rank = [&values](const double quantile) {
+            const auto index = static_cast<std::size_t>(quantile * static_cast<double>(values.size() - 1) + 0.5);
+            return toMs(values[std::min(index, values.size() - 1)]);
+        };
+        result.p50Ms = rank(0.50);
+        result.p95Ms = rank(0.95);
+        result.p99Ms = rank(0.99);
+        result.maxMs = toMs(values.back());
+        return result;
+    }
+}
+
+void InputLatency::pressAccepted(const int64_t decodedAtNs) {
+    const int64_t now = nowNs();
+    std::lock_guard lock(m_mutex);
+    if (m_state.load(std::memory_order_relaxed) != Idle) {
+        ++m_superseded;
+    }
+    m_decoded_ns = decodedAtNs;
+    m_handled_ns = now;
+    m_state.store(Pending, std::memory_order_release);
+}
+
+void InputLatency::frameSynchronized() {
+    // The GUI thread is blocked while the scene is synchronised, so nothing
+    // can arm a press halfway through this
+    uint8_t expected = Pending;
+    m_state.compare_exchange_strong(expected, Synced, std::memory_order_acq_rel);
+}
+
+void InputLatency::frameSwapped() {
+    if (m_state.load(std::memory_order_acquire) != Synced) {
+        return;
+    }
+
+    const int64_t now = nowNs();
+    std::lock_guard lock(m_mutex);
+    if (m_state.load(std::memory_order_relaxed) != Synced) {
+        return; // Superseded since
+    }
+    m_state.store(Idle, std::memory_order_relaxed);
+
+    const Sample sample{now - m_decoded_ns, m_handled_ns - m_decoded_ns};
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % WINDOW;
+    m_count = std::min(m_count + 1, WINDOW);
+    ++m_measured;
+
+    static MetricsRegistry::Histogram &latency = MetricsRegistry::instance().histogram(
+        "allesspitze_input_latency_seconds", "Button press decoded to first frame of its animation on screen");
+    latency.observe(static_cast<double>(sample.totalNs) / 1e9);
+    Trace::counter("input", "inputToFrameMs", toMs(sample.totalNs));
+}
+
+InputLatency::Report InputLatency::report() const {
+    std::vector<int64_t> totals;
+    std::vector<int64_t> dispatches;
+    Report report;
+    {
+        std::lock_guard lock(m_mutex);
+        totals.reserve(m_count);
+        dispatches.reserve(m_count);
+        for (std::size_t i = 0; i < m_count; ++i) {
+            totals.push_back(m_samples[i].totalNs);
+            dispatches.push_back(m_samples[i].dispatchNs);
+        }
+        report.samples = m_count;
+        report.measured = m_measured;
+        report.superseded = m_superseded;
+    }
+    report.ignored = m_ignored.load(std::memory_order_relaxed);
+    report.total = percentiles(std::move(totals));
+    report.dispatch = percentiles(std::move(dispatches));
+    return report;
+}
+
+QString InputLatency::formatReport(const Report &report) {
+    const auto row = [](const char *label, const Percentiles &p) {
+        return QString("%1 %2 %3 %4 %5\n")
+            .arg(QString(label).leftJustified(16))
+            .arg(p.p50Ms, 8, 'f', 1)
+            .arg(p.p95Ms, 8, 'f', 1)
+            .arg(p.p99Ms, 8, 'f', 1)
+            .arg(p.maxMs, 8, 'f', 1);
+    };
+
+    return QString("=== Input Latency ===\n"
+                   "Window: last %1 of %2 measured presses\n"
+                   "Ignored presses: %3, superseded: %4\n"
+                   "%5    P50ms    P95ms    P99ms    MAXms\n")
+               .arg(report.samples)
+               .arg(report.measured)
+               .arg(report.ignored)
+               .arg(report.superseded)
+               .arg(QString("STAGE").leftJustified(16)) +
+           row("press->frame", report.total) +
+           row("press->handled", report.dispatch) +
+           "=====================\n";
+}
+
+QVariantMap InputLatency::toVariantMap(const Report &report) {
+    QVariantMap map;
+    map["samples"] = static_cast<qulonglong>(report.samples);
+    map["measured"] = static_cast<qulonglong>(report.measured);
+    map["ignored"] = static_cast<qulonglong>(report.ignored);
+    map["superseded"] = static_cast<qulonglong>(report.superseded);
+    map["p50Ms"] = report.total.p50Ms;
+    map["p95Ms"] = report.total.p95Ms;
+    map["p99Ms"] = report.total.p99Ms;
+    map["maxMs"] = report.total.maxMs;
+    map["dispatchP50Ms"] = report.dispatch.p50Ms;
+    map["dispatchP99Ms"] = report.dispatch.p99Ms;
+    return map;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Button-to-screen latency. A press is timestamped when the I2C worker
+// decodes it; if the GUI thread acts on it (a spin or a risk step starts)
+// the measurement is armed, and the first frame synchronised after that
+// closes it when it is swapped to the screen. Presses that did nothing are
+// counted separately: they are what a player reports as "doesn't react".
+//
+// pressAccepted()/pressIgnored() run on the GUI thread, the frame hooks on
+// the render thread. Only one press is in flight at a time; a second one
+// before the frame supersedes the first.
+class InputLatency {
+public:
+    // Rolling window the percentiles are taken over
+    static constexpr std::size_t WINDOW = 512;
+
+    struct Percentiles {
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    struct Report {
+        std::size_t samples = 0;
+        Percentiles total;      // Decoded on the I2C thread -> frame on screen
+        Percentiles dispatch;   // Decoded -> handled on the GUI thread
+        uint64_t measured = 0;
+        uint64_t ignored = 0;
+        uint64_t superseded = 0;
+    };
+
+    // Same clock as I2CWorker's decode timestamps
+    [[nodiscard]] static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // GUI thread, right after the press changed the scene
+    void pressAccepted(int64_t decodedAtNs);
+
+    void pressIgnored() { m_ignored.fetch_add(1, std::memory_order_relaxed); }
+
+    // Render thread, QQuickWindow::afterSynchronizing: the frame being
+    // rendered now includes the press's scene change
+    void frameSynchronized();
+
+    // Render thread, QQuickWindow::frameSwapped
+    void frameSwapped();
+
+    [[nodiscard]] Report report() const;
+
+    // Plain-text block for the serial console
+    static QString formatReport(const Report &report);
+
+    // For the debug overlay
+    static QVariantMap toVariantMap(const Report &report);
+
+private:
+    enum State : uint8_t {
+        Idle,
+        Pending, // Waiting for the next frame to be synchronised
+        Synced   // In the frame being rendered, waiting for its swap
+    };
+
+    struct Sample {
+        int64_t totalNs = 0;
+        int64_t dispatchNs = 0;
+    };
+
+    // Checked on every frame without taking the lock
+    std::atomic<uint8_t> m_state{Idle};
+
+    mutable std::mutex m_mutex;
+    int64_t m_decoded_ns = 0;
+    int64_t m_handled_ns = 0;
+    std::array<Sample, WINDOW> m_samples{};
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    uint64_t m_measured = 0;
+    uint64_t m_superseded = 0;
+    std::atomic<uint64_t> m_ignored{0};
+};
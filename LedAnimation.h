@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Small LED program the Arduino runs on its own. The host uploads a program
+// into one of MAX_SLOTS slots (CMD_UPLOAD_ANIMATION) and starts it with a
+// single CMD_PLAY_ANIMATION, so an effect costs one transaction however
+// many frames it has. A running program owns the LEDs it targets; when it
+// ends or CMD_STOP_ANIMATION arrives the board shows the last HIGHLIGHT_*
+// state again. Boards with single-colour LEDs ignore the colour.
+//
+// Upload payload, ENCODED_SIZE bytes:
+//
+//   [slot][effect][target][first][count][period lo][period hi][repeat][r][g][b]
+//
+// Play payload is [slot]; stop has no payload.
+struct LedAnimation {
+    static constexpr uint8_t MAX_SLOTS = 4;
+    static constexpr std::size_t ENCODED_SIZE = 11;
+    static constexpr uint16_t MIN_PERIOD_MS = 20;
+
+    enum class Effect : uint8_t {
+        None = 0,
+        Blink = 1, // Every targeted LED on, then off; one cycle per period
+        Chase = 2, // One LED lit at a time, advancing every period
+        Fill = 3   // One more LED lit every period until all are on, then clear
+    };
+
+    enum class Target : uint8_t {
+        Towers = 0, // Tower rows; first/count select towers
+        Buttons = 1
+    };
+
+    struct Colour {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+
+        bool operator==(const Colour &) const = default;
+    };
+
+    Effect effect = Effect::None;
+    Target target = Target::Towers;
+    uint8_t first = 0;
+    uint8_t count = 0;     // 0 = every LED from first on
+    uint16_t periodMs = 0;
+    uint8_t repeat = 0;    // Full cycles, 0 = until stopped
+    Colour colour;
+
+    bool operator==(const LedAnimation &) const = default;
+
+    [[nodiscard]] static constexpr LedAnimation blink(const Target target, const Colour colour,
+                                                      const uint16_t periodMs, const uint8_t repeat = 0) {
+        return {Effect::Blink, target, 0, 0, periodMs, repeat, colour};
+    }
+
+    [[nodiscard]] static constexpr LedAnimation chase(const Target target, const Colour colour,
+                                                      const uint16_t periodMs, const uint8_t repeat = 0) {
+        return {Effect::Chase, target, 0, 0, periodMs, repeat, colour};
+    }
+
+    [[nodiscard]] static constexpr LedAnimation fill(const Target target, const Colour colour,
+                                                     const uint16_t periodMs, const uint8_t repeat = 0) {
+        return {Effect::Fill, target, 0, 0, periodMs, repeat, colour};
+    }
+
+    [[nodiscard]] constexpr bool valid() const {
+        return effect >= Effect::Blink && effect <= Effect::Fill &&
+               target <= Target::Buttons &&
+               periodMs >= MIN_PERIOD_MS;
+    }
+
+    [[nodiscard]] constexpr std::array<uint8_t, ENCODED_SIZE> encode(const uint8_t slot) const {
+        return {
+            slot,
+            static_cast<uint8_t>(effect),
+            static_cast<uint8_t>(target),
+            first,
+            count,
+            static_cast<uint8_t>(periodMs & 0xFF),
+            static_cast<uint8_t>(periodMs >> 8),
+            repeat,
+            colour.r,
+            colour.g,
+            colour.b
+        };
+    }
+
+    // Inverse of encode(); false if the payload is malformed
+    [[nodiscard]] static constexpr bool decode(const std::span<const uint8_t> payload,
+                                               uint8_t &slot, LedAnimation &animation) {
+        if (payload.size() != ENCODED_SIZE || payload[0] >= MAX_SLOTS) {
+            return false;
+        }
+
+        LedAnimation result;
+        result.effect = static_cast<Effect>(payload[1]);
+        result.target = static_cast<Target>(payload[2]);
+        result.first = payload[3];
+        result.count = payload[4];
+        result.periodMs = static_cast<uint16_t>(payload[5] | payload[6] << 8);
+        result.repeat = payload[7];
+        result.colour = {payload[8], payload[9], payload[10]};
+        if (!result.valid()) {
+            return false;
+        }
+
+        slot = payload[0];
+        animation = result;
+        return true;
+    }
+};
+
+// Programs the game keeps uploaded, and the slots they live in
+namespace LedAnimations {
+    inline constexpr uint8_t SLOT_JACKPOT = 0;
+    inline constexpr uint8_t SLOT_RISK = 1;
+
+    // Gold chase over every tower, five laps
+    [[nodiscard]] constexpr LedAnimation jackpot() {
+        return LedAnimation::chase(LedAnimation::Target::Towers, {255, 180, 0}, 60, 5);
+    }
+
+    // Orange fill sweeping up the towers while the risk ladder spins
+    [[nodiscard]] constexpr LedAnimation riskSweep() {
+        return LedAnimation::fill(LedAnimation::Target::Towers, {255, 100, 0}, 100);
+    }
+}
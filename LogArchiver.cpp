@@ -0,0 +1,194 @@
+#include "LogArchiver.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+#include <array>
+#include <zlib.h>
+#include "DebugLogger.h"
+#include "MetricsRegistry.h"
+
+namespace {
+    constexpr int STAMP_OFFSET = 6;  // After "debug_"
+    constexpr int STAMP_LENGTH = 19; // yyyy-MM-dd_HH-mm-ss
+
+    QString sessionOf(const QString &fileName) {
+        return fileName.mid(STAMP_OFFSET, STAMP_LENGTH);
+    }
+
+    // debug_<stamp>.log is segment 0, debug_<stamp>.<n>.log segment n
+    int segmentOf(const QString &fileName) {
+        const QString rest = fileName.mid(STAMP_OFFSET + STAMP_LENGTH);
+        if (!rest.startsWith('.') || rest.startsWith(".log")) {
+            return 0;
+        }
+        return rest.mid(1, rest.indexOf('.', 1) - 1).toInt();
+    }
+
+    // A segment is live only while DebugLogger writes to it and never
+    // again afterwards, so a file that is not live now is safe to touch
+    bool isLive(const QFileInfo &info) {
+        return info.fileName() == QFileInfo(DebugLogger::instance().currentLogFile()).fileName();
+    }
+}
+
+LogArchiver::LogArchiver(QString directory, QObject *parent)
+    : QObject(parent)
+      , m_directory(std::move(directory)) {
+}
+
+void LogArchiver::initialize() {
+    m_timer = new QTimer(this);
+    m_timer->setInterval(MAINTENANCE_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &LogArchiver::maintain);
+    m_timer->start();
+
+    // Segments left uncompressed by earlier sessions, and anything over
+    // the limits since
+    maintain();
+}
+
+void LogArchiver::segmentClosed(const QString &, const QString &) {
+    maintain();
+}
+
+void LogArchiver::maintain() {
+    static MetricsRegistry::Counter &compressedCount = MetricsRegistry::instance().counter(
+        "allesspitze_log_segments_compressed_total", "Closed log segments gzip-compressed");
+    static MetricsRegistry::Counter &deletedCount = MetricsRegistry::instance().counter(
+        "allesspitze_log_files_deleted_total", "Log files deleted by retention or the disk budget");
+    static MetricsRegistry::Gauge &diskBytes = MetricsRegistry::instance().gauge(
+        "allesspitze_log_disk_bytes", "Bytes used by debug logs");
+    static MetricsRegistry::Gauge &fileCount = MetricsRegistry::instance().gauge(
+        "allesspitze_log_files", "Debug log files on disk");
+
+    const QDir dir(m_directory);
+
+    // Left by a compression that was interrupted
+    for (const QFileInfo &partial: dir.entryInfoList({"debug_*.gz.part"}, QDir::Files)) {
+        QFile::remove(partial.filePath());
+    }
+
+    int compressed = 0;
+    for (const QFileInfo &info: dir.entryInfoList({"debug_*.log"}, QDir::Files)) {
+        if (isLive(info)) {
+            continue;
+        }
+
+        QString error;
+        if (compressFile(info.filePath(), info.filePath() + ".gz", error)) {
+            QFile::remove(info.filePath());
+            compressedCount.increment();
+            ++compressed;
+        } else {
+            log("Log archiver: " + error, true);
+        }
+    }
+
+    // Oldest first: by session, then segment
+    QFileInfoList logs = dir.entryInfoList({"debug_*.log", "debug_*.log.gz"}, QDir::Files);
+    std::ranges::sort(logs, [](const QFileInfo &a, const QFileInfo &b) {
+        const QString sessionA = sessionOf(a.fileName());
+        const QString sessionB = sessionOf(b.fileName());
+        if (sessionA != sessionB) {
+            return sessionA < sessionB;
+        }
+        return segmentOf(a.fileName()) < segmentOf(b.fileName());
+    });
+
+    QStringList sessions;
+    for (const QFileInfo &info: logs) {
+        if (sessions.isEmpty() || sessions.last() != sessionOf(info.fileName())) {
+            sessions.append(sessionOf(info.fileName()));
+        }
+    }
+    const QSet<QString> expiredSessions(sessions.cbegin(),
+                                        sessions.cbegin() + std::max<qsizetype>(0, sessions.size() - KEEP_SESSIONS));
+    const QDateTime cutoff = QDateTime::currentDateTime().addDays(-MAX_AGE_DAYS);
+
+    int deleted = 0;
+    const auto remove = [&](const QFileInfo &info) {
+        if (isLive(info) || !QFile::remove(info.filePath())) {
+            return false;
+        }
+        deletedCount.increment();
+        ++deleted;
+        return true;
+    };
+
+    QFileInfoList kept;
+    qint64 total = 0;
+    for (const QFileInfo &info: logs) {
+        const bool expired = expiredSessions.contains(sessionOf(info.fileName())) ||
+                             info.lastModified() < cutoff;
+        if (!expired || !remove(info)) {
+            kept.append(info);
+            total += info.size();
+        }
+    }
+
+    // Still over budget: the oldest segments go first, whatever session
+    for (qsizetype i = 0; i < kept.size() && total > DISK_BUDGET_BYTES; ++i) {
+        if (remove(kept[i])) {
+            total -= kept[i].size();
+            kept.removeAt(i--);
+        }
+    }
+
+    diskBytes.set(static_cast<double>(total));
+    fileCount.set(static_cast<double>(kept.size()));
+
+    if (compressed > 0 || deleted > 0) {
+        log(QString("Log archiver: compressed %1, deleted %2; logs use %3 MiB in %4 files")
+            .arg(compressed)
+            .arg(deleted)
+            .arg(static_cast<double>(total) / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(kept.size()));
+    }
+}
+
+void LogArchiver::log(const QString &message, const bool isWarning) {
+    QMetaObject::invokeMethod(&DebugLogger::instance(), [message, isWarning]() {
+        if (isWarning) {
+            DebugLogger::instance().warning(message);
+        } else {
+            DebugLogger::instance().info(message);
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool LogArchiver::compressFile(const QString &source, const QString &target, QString &error) {
+    QFile in(source);
+    if (!in.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot read %1: %2").arg(source, in.errorString());
+        return false;
+    }
+
+    // Renamed into place only when complete, so a .gz is never truncated
+    const QString partial = target + ".part";
+    gzFile out = gzopen(QFile::encodeName(partial).constData(), "wb6");
+    if (!out) {
+        error = QString("Cannot create %1").arg(partial);
+        return false;
+    }
+
+    std::array<char, 64 * 1024> buffer{};
+    bool ok = true;
+    qint64 n = 0;
+    while (ok && (n = in.read(buffer.data(), buffer.size())) > 0) {
+        ok = gzwrite(out, buffer.data(), static_cast<unsigned>(n)) == static_cast<int>(n);
+    }
+    ok = gzclose(out) == Z_OK && ok && n == 0;
+
+    if (ok) {
+        QFile::remove(target); // From a run that stopped before removing source
+    }
+    if (!ok || !QFile::rename(partial, target)) {
+        QFile::remove(partial);
+        error = QString("Cannot compress %1 into %2").arg(source, target);
+        return false;
+    }
+    return true;
+}
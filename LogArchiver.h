@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Housekeeping for DebugLogger's segments, meant to run on an idle-priority
+// thread. Closed segments are gzip-compressed in place (debug_<session>.log
+// becomes debug_<session>.log.gz); then whole sessions beyond
+// KEEP_SESSIONS, files older than MAX_AGE_DAYS and finally the oldest files
+// over DISK_BUDGET_BYTES are deleted. The segment being written is never
+// touched: DebugLogger is asked for it right before each file is compressed
+// or removed, since a rotation may not have been signalled here yet. Disk
+// usage is exported as metrics.
+class LogArchiver : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int KEEP_SESSIONS = 10;
+    static constexpr int MAX_AGE_DAYS = 30;
+    static constexpr qint64 DISK_BUDGET_BYTES = 64LL * 1024 * 1024;
+    static constexpr int MAINTENANCE_INTERVAL_MS = 60 * 60 * 1000;
+
+    explicit LogArchiver(QString directory, QObject *parent = nullptr);
+
+    // gzip source into target through a temporary file; source is kept
+    static bool compressFile(const QString &source, const QString &target, QString &error);
+
+public slots:
+    // Call on the archiver's thread once it is running
+    void initialize();
+
+    void segmentClosed(const QString &closedPath, const QString &currentPath);
+
+    void maintain();
+
+private:
+    // Logged on DebugLogger's thread, like StallWatchdog's reports
+    static void log(const QString &message, bool isWarning = false);
+
+    QString m_directory;
+    QTimer *m_timer = nullptr;
+};
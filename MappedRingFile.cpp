@@ -0,0 +1,198 @@
+#include "MappedRingFile.h"
+#include <QByteArray>
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIC[8] = {'A', 'S', 'R', 'I', 'N', 'G', '0', '1'};
+    constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t slotSize;
+        uint32_t slotCount;
+        uint32_t reserved;
+        uint64_t nextSequence; // Only accessed through std::atomic_ref
+        char tag[32];
+    };
+    static_assert(sizeof(FileHeader) == 64);
+
+    struct SlotHeader {
+        uint64_t sequence;     // Only accessed through std::atomic_ref
+        uint32_t length;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(SlotHeader) == MappedRingFile::SLOT_HEADER_SIZE);
+
+    FileHeader *headerOf(uint8_t *base) {
+        return reinterpret_cast<FileHeader *>(base);
+    }
+
+    SlotHeader *slotAt(uint8_t *base, const uint32_t slotSize, const uint64_t index) {
+        return reinterpret_cast<SlotHeader *>(base + sizeof(FileHeader) + index * slotSize);
+    }
+
+    bool headerMatches(const FileHeader &header, const QByteArray &tag,
+                       const uint32_t slotSize, const uint32_t slotCount) {
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header.version == VERSION &&
+               header.slotSize == slotSize &&
+               header.slotCount == slotCount &&
+               std::strncmp(header.tag, tag.constData(), sizeof(header.tag)) == 0;
+    }
+}
+
+MappedRingFile::MappedRingFile(QString path, uint8_t *base, const std::size_t mappedSize,
+                               const uint32_t slotSize, const uint32_t slotCount)
+    : m_path(std::move(path)), m_base(base), m_mapped_size(mappedSize),
+      m_slot_size(slotSize), m_slot_count(slotCount) {
+}
+
+MappedRingFile::~MappedRingFile() {
+    if (m_base) {
+        munmap(m_base, m_mapped_size);
+    }
+}
+
+std::unique_ptr<MappedRingFile> MappedRingFile::open(const QString &path, const QString &tag,
+                                                     const uint32_t slotSize, const uint32_t slotCount,
+                                                     QString &error) {
+    if (slotSize <= SLOT_HEADER_SIZE || slotSize % 8 != 0 || slotCount == 0) {
+        error = QString("Invalid ring geometry: %1 slots of %2 bytes").arg(slotCount).arg(slotSize);
+        return nullptr;
+    }
+
+    const QByteArray tagBytes = tag.toUtf8();
+    if (tagBytes.size() >= static_cast<qsizetype>(sizeof(FileHeader::tag))) {
+        error = QString("Ring tag too long: %1").arg(tag);
+        return nullptr;
+    }
+
+    const int fd = ::open(path.toLocal8Bit().constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = QString("Failed to open %1: %2").arg(path, strerror(errno));
+        return nullptr;
+    }
+
+    const std::size_t mappedSize = sizeof(FileHeader) + static_cast<std::size_t>(slotSize) * slotCount;
+
+    struct stat info{};
+    const bool sizeMatches = fstat(fd, &info) == 0 &&
+                             static_cast<std::size_t>(info.st_size) == mappedSize;
+    if (!sizeMatches && ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+        error = QString("Failed to size %1: %2").arg(path, strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+
+    void *mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int savedErrno = errno;
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        error = QString("Failed to map %1: %2").arg(path, strerror(savedErrno));
+        return nullptr;
+    }
+
+    auto *base = static_cast<uint8_t *>(mapping);
+    if (FileHeader *header = headerOf(base); !sizeMatches || !headerMatches(*header, tagBytes, slotSize, slotCount)) {
+        std::memset(base, 0, mappedSize);
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->slotSize = slotSize;
+        header->slotCount = slotCount;
+        std::memcpy(header->tag, tagBytes.constData(), static_cast<std::size_t>(tagBytes.size()));
+    }
+
+    return std::unique_ptr<MappedRingFile>(new MappedRingFile(path, base, mappedSize, slotSize, slotCount));
+}
+
+void MappedRingFile::append(const std::span<const uint8_t> record) {
+    FileHeader *header = headerOf(m_base);
+    const uint64_t sequence =
+            std::atomic_ref(header->nextSequence).fetch_add(1, std::memory_order_relaxed) + 1;
+
+    SlotHeader *slot = slotAt(m_base, m_slot_size, (sequence - 1) % m_slot_count);
+    std::atomic_ref slotSequence(slot->sequence);
+
+    // Invalidate first so a reader never pairs the old sequence with new bytes
+    slotSequence.store(0, std::memory_order_release);
+
+    const std::size_t length = std::min(record.size(), payloadCapacity());
+    std::memcpy(reinterpret_cast<uint8_t *>(slot) + SLOT_HEADER_SIZE, record.data(), length);
+    slot->length = static_cast<uint32_t>(length);
+
+    slotSequence.store(sequence, std::memory_order_release);
+}
+
+bool MappedRingFile::readRecords(const QString &path, QString &tag,
+                                 std::vector<Record> &records, QString &error) {
+    const int fd = ::open(path.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = QString("Failed to open %1: %2").arg(path, strerror(errno));
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data.resize(static_cast<std::size_t>(info.st_size));
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            const ssize_t n = ::read(fd, data.data() + offset, data.size() - offset);
+            if (n <= 0) {
+                break;
+            }
+            offset += static_cast<std::size_t>(n);
+        }
+        data.resize(offset);
+    }
+    ::close(fd);
+
+    if (data.size() < sizeof(FileHeader)) {
+        error = QString("%1 is not a ring file").arg(path);
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.slotSize <= SLOT_HEADER_SIZE || header.slotCount == 0 ||
+        data.size() < sizeof(FileHeader) + static_cast<std::size_t>(header.slotSize) * header.slotCount) {
+        error = QString("%1 is not a ring file or is truncated").arg(path);
+        return false;
+    }
+
+    tag = QString::fromUtf8(header.tag, static_cast<qsizetype>(strnlen(header.tag, sizeof(header.tag))));
+
+    // Anything older than one lap behind the writer has been overwritten
+    const uint64_t newest = header.nextSequence;
+    const uint64_t oldest = newest > header.slotCount ? newest - header.slotCount + 1 : 1;
+
+    records.clear();
+    for (uint32_t i = 0; i < header.slotCount; ++i) {
+        SlotHeader slot{};
+        const uint8_t *slotData = data.data() + sizeof(FileHeader) + static_cast<std::size_t>(i) * header.slotSize;
+        std::memcpy(&slot, slotData, sizeof(slot));
+
+        if (slot.sequence < oldest || slot.sequence > newest ||
+            slot.length > header.slotSize - SLOT_HEADER_SIZE) {
+            continue;
+        }
+
+        records.push_back({
+            slot.sequence,
+            std::vector<uint8_t>(slotData + SLOT_HEADER_SIZE, slotData + SLOT_HEADER_SIZE + slot.length)
+        });
+    }
+
+    std::ranges::sort(records, {}, &Record::sequence);
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Fixed-slot ring buffer in a memory-mapped file. append() is a memcpy into
+// the shared mapping: no allocation and no syscall, and whatever was
+// written survives a crash of the process because the pages belong to the
+// kernel's page cache.
+//
+// File layout: a 64-byte header followed by slotCount slots of slotSize
+// bytes. Each slot starts with its sequence number (0 = never written) and
+// the record length; the sequence is stored last so a torn write is never
+// mistaken for a record.
+class MappedRingFile {
+public:
+    struct Record {
+        uint64_t sequence;
+        std::vector<uint8_t> bytes;
+    };
+
+    static constexpr std::size_t SLOT_HEADER_SIZE = 16;
+
+    ~MappedRingFile();
+
+    MappedRingFile(const MappedRingFile &) = delete;
+
+    MappedRingFile &operator=(const MappedRingFile &) = delete;
+
+    // Opens the ring at path, keeping existing records if the file was
+    // written with the same tag and geometry, otherwise starting fresh.
+    // tag identifies the record format, e.g. "i2c-bus/1".
+    static std::unique_ptr<MappedRingFile> open(const QString &path, const QString &tag,
+                                                uint32_t slotSize, uint32_t slotCount,
+                                                QString &error);
+
+    // Reads every valid record, oldest first. tag receives the file's tag.
+    static bool readRecords(const QString &path, QString &tag,
+                            std::vector<Record> &records, QString &error);
+
+    // Thread-safe. Records longer than payloadCapacity() are truncated.
+    void append(std::span<const uint8_t> record);
+
+    [[nodiscard]] std::size_t payloadCapacity() const { return m_slot_size - SLOT_HEADER_SIZE; }
+
+    [[nodiscard]] uint32_t slotCount() const { return m_slot_count; }
+
+    [[nodiscard]] QString path() const { return m_path; }
+
+private:
+    MappedRingFile(QString path, uint8_t *base, std::size_t mappedSize,
+                   uint32_t slotSize, uint32_t slotCount);
+
+    QString m_path;
+    uint8_t *m_base = nullptr;
+    std::size_t m_mapped_size = 0;
+    uint32_t m_slot_size = 0;
+    uint32_t m_slot_count = 0;
+};
@@ -0,0 +1,208 @@
+#include "MetricsRegistry.h"
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    QByteArray formatValue(const double value) {
+        if (std::isnan(value)) {
+            return "NaN";
+        }
+        if (std::isinf(value)) {
+            return value > 0 ? "+Inf" : "-Inf";
+        }
+        return QByteArray::number(value, 'g', 15);
+    }
+
+    void appendSample(QByteArray &out, const QString &name, const char *suffix, const QString &labels,
+                      const QString &extraLabel, const double value) {
+        out.append(name.toUtf8()).append(suffix);
+        if (!labels.isEmpty() || !extraLabel.isEmpty()) {
+            out.append('{').append(labels.toUtf8());
+            if (!labels.isEmpty() && !extraLabel.isEmpty()) {
+                out.append(',');
+            }
+            out.append(extraLabel.toUtf8()).append('}');
+        }
+        out.append(' ').append(formatValue(value)).append('\n');
+    }
+
+    // HELP and TYPE once per metric name, however many label sets follow
+    void appendHeader(QByteArray &out, QString &lastName, const QString &name, const QString &help,
+                      const char *type) {
+        if (name == lastName) {
+            return;
+        }
+        lastName = name;
+        QString escaped = help;
+        escaped.replace('\\', "\\\\").replace('\n', "\\n");
+        out.append("# HELP ").append(name.toUtf8()).append(' ').append(escaped.toUtf8()).append('\n');
+        out.append("# TYPE ").append(name.toUtf8()).append(' ').append(type).append('\n');
+    }
+}
+
+MetricsRegistry::Histogram::Histogram(const std::initializer_list<double> bounds) {
+    for (const double bound: bounds) {
+        if (m_bucket_count == MAX_BUCKETS) {
+            break;
+        }
+        m_bounds[m_bucket_count++] = bound;
+    }
+}
+
+void MetricsRegistry::Histogram::observe(const double value) {
+    const auto end = m_bounds.begin() + static_cast<std::ptrdiff_t>(m_bucket_count);
+    const auto bucket = static_cast<std::size_t>(std::lower_bound(m_bounds.begin(), end, value) - m_bounds.begin());
+    if (bucket < m_bucket_count) {
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    // Last, so a reader never sees more observations than bucket entries
+    m_count.fetch_add(1, std::memory_order_release);
+}
+
+void MetricsRegistry::Collection::counter(const QString &name, const QString &help, const QString &labels,
+                                          const double value) {
+    m_samples.push_back({name, help, "counter", labels, value});
+}
+
+void MetricsRegistry::Collection::gauge(const QString &name, const QString &help, const QString &labels,
+                                        const double value) {
+    m_samples.push_back({name, help, "gauge", labels, value});
+}
+
+MetricsRegistry &MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry *MetricsRegistry::find(const QString &name, const QString &labels, const Type type) {
+    for (Entry &entry: m_entries) {
+        if (entry.name == name && entry.labels == labels && entry.type == type) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+MetricsRegistry::Counter &MetricsRegistry::counter(const QString &name, const QString &help,
+                                                   const QString &labels) {
+    std::lock_guard lock(m_mutex);
+    if (const Entry *entry = find(name, labels, Type::Counter)) {
+        return *entry->counter;
+    }
+
+    Counter &counter = m_counters.emplace_back();
+    m_entries.push_back({name, help, labels, Type::Counter, &counter, nullptr, nullptr});
+    return counter;
+}
+
+MetricsRegistry::Gauge &MetricsRegistry::gauge(const QString &name, const QString &help, const QString &labels) {
+    std::lock_guard lock(m_mutex);
+    if (const Entry *entry = find(name, labels, Type::Gauge)) {
+        return *entry->gauge;
+    }
+
+    Gauge &gauge = m_gauges.emplace_back();
+    m_entries.push_back({name, help, labels, Type::Gauge, nullptr, &gauge, nullptr});
+    return gauge;
+}
+
+MetricsRegistry::Histogram &MetricsRegistry::histogram(const QString &name, const QString &help,
+                                                       const std::initializer_list<double> bounds,
+                                                       const QString &labels) {
+    std::lock_guard lock(m_mutex);
+    if (const Entry *entry = find(name, labels, Type::Histogram)) {
+        return *entry->histogram;
+    }
+
+    Histogram &histogram = m_histograms.emplace_back(bounds);
+    m_entries.push_back({name, help, labels, Type::Histogram, nullptr, nullptr, &histogram});
+    return histogram;
+}
+
+void MetricsRegistry::addCollector(Collector collector) {
+    std::lock_guard lock(m_mutex);
+    m_collectors.push_back(std::move(collector));
+}
+
+QByteArray MetricsRegistry::exposition() const {
+    std::vector<Entry> entries;
+    std::vector<Collector> collectors;
+    {
+        std::lock_guard lock(m_mutex);
+        entries = m_entries;
+        collectors = m_collectors;
+    }
+
+    // Collectors run unlocked: they may register metrics themselves
+    Collection collection;
+    for (const Collector &collector: collectors) {
+        collector(collection);
+    }
+
+    // The format wants all samples of a name together
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.name < b.name;
+    });
+    std::stable_sort(collection.m_samples.begin(), collection.m_samples.end(),
+                     [](const Collection::Sample &a, const Collection::Sample &b) { return a.name < b.name; });
+
+    QByteArray out;
+    QString lastName;
+    for (const Entry &entry: entries) {
+        switch (entry.type) {
+            case Type::Counter:
+                appendHeader(out, lastName, entry.name, entry.help, "counter");
+                appendSample(out, entry.name, "", entry.labels, QString(),
+                             static_cast<double>(entry.counter->value()));
+                break;
+
+            case Type::Gauge:
+                appendHeader(out, lastName, entry.name, entry.help, "gauge");
+                appendSample(out, entry.name, "", entry.labels, QString(), entry.gauge->value());
+                break;
+
+            case Type::Histogram: {
+                const Histogram &histogram = *entry.histogram;
+                appendHeader(out, lastName, entry.name, entry.help, "histogram");
+
+                const uint64_t count = histogram.count();
+                uint64_t cumulative = 0;
+                for (std::size_t i = 0; i < histogram.bucketCount(); ++i) {
+                    // Clamped: observations still landing while we read
+                    cumulative = std::min(cumulative + histogram.bucketValue(i), count);
+                    appendSample(out, entry.name, "_bucket", entry.labels,
+                                 QString("le=\"%1\"").arg(QString::fromLatin1(formatValue(histogram.bound(i)))),
+                                 static_cast<double>(cumulative));
+                }
+                appendSample(out, entry.name, "_bucket", entry.labels, "le=\"+Inf\"", static_cast<double>(count));
+                appendSample(out, entry.name, "_sum", entry.labels, QString(), histogram.sum());
+                appendSample(out, entry.name, "_count", entry.labels, QString(), static_cast<double>(count));
+                break;
+            }
+        }
+    }
+
+    for (const Collection::Sample &sample: collection.m_samples) {
+        appendHeader(out, lastName, sample.name, sample.help, sample.type);
+        appendSample(out, sample.name, "", sample.labels, QString(), sample.value);
+    }
+    return out;
+}
+
+bool MetricsRegistry::writeTextfile(const QString &path, QString &error) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    const QByteArray text = exposition();
+    if (file.write(text) != text.size() || !file.commit()) {
+        error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
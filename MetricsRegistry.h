@@ -0,0 +1,154 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <vector>
+
+// Process-wide counters, gauges and histograms in the Prometheus data
+// model. Registering takes a lock and returns a reference that stays valid
+// for the life of the process; updating through it is a relaxed atomic, so
+// hot paths (the I2C worker, the render thread) keep the reference and
+// never look anything up.
+//
+// Numbers another class already keeps (I2CTelemetry, game state) are not
+// copied into metrics; a collector reads them when an exposition is built.
+//
+// Names follow Prometheus conventions: allesspitze_ prefix, base units,
+// _total for counters. labels is the inside of the braces, e.g.
+// device="0x42", and is part of the identity.
+class MetricsRegistry {
+public:
+    class Counter {
+    public:
+        void increment(const uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+        [[nodiscard]] uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> m_value{0};
+    };
+
+    class Gauge {
+    public:
+        void set(const double value) { m_value.store(value, std::memory_order_relaxed); }
+
+        void add(const double amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+        [[nodiscard]] double value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> m_value{0.0};
+    };
+
+    class Histogram {
+    public:
+        static constexpr std::size_t MAX_BUCKETS = 16;
+
+        // Upper bounds, ascending; +Inf is implicit. Extra bounds past
+        // MAX_BUCKETS are ignored.
+        explicit Histogram(std::initializer_list<double> bounds);
+
+        void observe(double value);
+
+        [[nodiscard]] std::size_t bucketCount() const { return m_bucket_count; }
+        [[nodiscard]] double bound(const std::size_t bucket) const { return m_bounds[bucket]; }
+        // Observations in bucket alone, not cumulative
+        [[nodiscard]] uint64_t bucketValue(const std::size_t bucket) const {
+            return m_buckets[bucket].load(std::memory_order_relaxed);
+        }
+        [[nodiscard]] uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] double sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+    private:
+        std::array<double, MAX_BUCKETS> m_bounds{};
+        std::size_t m_bucket_count = 0;
+        std::array<std::atomic<uint64_t>, MAX_BUCKETS> m_buckets{};
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<double> m_sum{0.0};
+    };
+
+    // Samples a collector adds to an exposition
+    class Collection {
+    public:
+        void counter(const QString &name, const QString &help, const QString &labels, double value);
+
+        void gauge(const QString &name, const QString &help, const QString &labels, double value);
+
+    private:
+        friend class MetricsRegistry;
+
+        struct Sample {
+            QString name;
+            QString help;
+            const char *type;
+            QString labels;
+            double value;
+        };
+        std::vector<Sample> m_samples;
+    };
+
+    using Collector = std::function<void(Collection &)>;
+
+    // Seconds; spans a fast I2C transaction to a stuck frame
+    static constexpr std::initializer_list<double> LATENCY_BUCKETS = {
+        0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5
+    };
+
+    static MetricsRegistry &instance();
+
+    Counter &counter(const QString &name, const QString &help, const QString &labels = QString());
+
+    Gauge &gauge(const QString &name, const QString &help, const QString &labels = QString());
+
+    // bounds only matter the first time a name/labels pair is registered
+    Histogram &histogram(const QString &name, const QString &help,
+                         std::initializer_list<double> bounds = LATENCY_BUCKETS,
+                         const QString &labels = QString());
+
+    // Runs on the thread that builds the exposition (the GUI thread in the
+    // app); it may read anything that thread owns
+    void addCollector(Collector collector);
+
+    // Prometheus text exposition format 0.0.4
+    [[nodiscard]] QByteArray exposition() const;
+
+    // Written to a temporary file and renamed, so a scraper never sees a
+    // partial file
+    bool writeTextfile(const QString &path, QString &error) const;
+
+private:
+    MetricsRegistry() = default;
+
+    enum class Type : uint8_t {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Entry {
+        QString name;
+        QString help;
+        QString labels;
+        Type type;
+        Counter *counter = nullptr;
+        Gauge *gauge = nullptr;
+        Histogram *histogram = nullptr;
+    };
+
+    Entry *find(const QString &name, const QString &labels, Type type);
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    // deques never move their elements, so handed-out references stay valid
+    std::deque<Counter> m_counters;
+    std::deque<Gauge> m_gauges;
+    std::deque<Histogram> m_histograms;
+    std::vector<Collector> m_collectors;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QVariantMap>
+#include <array>
+#include "Symbol.h"
+
+// What SlotMachine needs from a reel. SlotReel draws it in the QML scene;
+// HeadlessReel only decides results, for cabinets without a display. Both
+// emit spinning_changed() when a spin starts and when its result is ready.
+class ReelBackend {
+public:
+    struct SymbolOdds {
+        Symbol::Type type;
+        const char *key;       // As in SET_PROB
+        const char *imagePath;
+        int weight;
+    };
+
+    static constexpr int SPIN_DURATION_MS = 2000;
+
+    // Probabilities tuned for ~95% RTP
+    // Symbol frequency is INVERSE to reward value
+    // Total weight: 52 (excluding miss)
+    // Hit rate: 45% (miss 55%)
+    //
+    // Reward tiers (Level 1-5 multipliers):
+    // - Marienkäfer: 1, 2, 4, 7, 10    (LOW value)    -> HIGH frequency
+    // - Kleeblatt:   3, 8, 16, 29, 50  (MEDIUM value) -> MEDIUM frequency
+    // - Coin:        10, 40, 100, 200, 350 (HIGH value) -> LOW frequency
+    // - Sonne: increases ALL towers    (BONUS)        -> RARE
+    // - Teufel: resets ALL towers      (PENALTY)      -> MODERATE
+    //
+    // Expected symbol distribution when hitting:
+    // - Marienkäfer: 20/52 = 38.5% (common, low value)
+    // - Kleeblatt:   15/52 = 28.8% (medium frequency, medium value)
+    // - Coin:        5/52  = 9.6%  (rare, highest value)
+    // - Sonne:       4/52  = 7.7%  (rare, bonus)
+    // - Teufel:      8/52  = 15.4% (penalty - resets all)
+    static constexpr double DEFAULT_MISS_PROBABILITY = 0.55; // Reduced from 0.70 for better RTP
+    static constexpr std::array<SymbolOdds, 5> DEFAULT_SYMBOLS{{
+        {Symbol::Type::Marienkaefer, "marienkaefer", ":/images/marienkaefer.png", 20},
+        {Symbol::Type::Coin,         "coin",         ":/images/coin.png",          5},
+        {Symbol::Type::Kleeblatt,    "kleeblatt",    ":/images/kleeblatt.png",    15},
+        {Symbol::Type::Sonne,        "sonne",        ":/images/sonne.png",         4},
+        {Symbol::Type::Teufel,       "teufel",       ":/images/teufel.png",        8}
+    }};
+
+    // Weight for a symbol SET_PROB leaves out
+    static constexpr int UNSPECIFIED_WEIGHT = 20;
+
+    virtual ~ReelBackend() = default;
+
+    virtual void spin() = 0;
+
+    [[nodiscard]] virtual bool spinning() const = 0;
+
+    // Result of the last finished spin
+    [[nodiscard]] virtual Symbol::Type currentSymbolType() const = 0;
+
+    [[nodiscard]] virtual bool isMiss() const = 0;
+
+    // Weights by SymbolOdds::key; a weight of 0 takes the symbol off the reel
+    virtual void set_probabilities(const QVariantMap &probabilities) = 0;
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Binary mode of the serial interface, for management software. A client
+// switches a connection to it by sending a 0x00 byte, which never occurs in
+// the text protocol; it stays binary until TextMode or the port closes.
+//
+// Every frame is COBS-encoded and terminated by 0x00, so a receiver can
+// always resynchronise on the next delimiter. Decoded, a frame is
+//
+//   [type][request id lo][request id hi][payload ...][crc lo][crc hi]
+//
+// with CRC-16/CCITT-FALSE over everything before it. A reply carries the
+// request's type | 0x80 and request id, and its payload starts with a
+// Status byte. Requests are answered in the order they arrive except
+// GetStatus, whose answer comes from the GUI thread; match replies by id
+// and pipeline freely. Multi-byte integers are little-endian, money is in
+// cents.
+namespace SerialBinaryProtocol {
+    inline constexpr uint8_t DELIMITER = 0x00;
+    inline constexpr uint8_t REPLY_FLAG = 0x80;
+    inline constexpr std::size_t HEADER_SIZE = 3;
+    inline constexpr std::size_t CRC_SIZE = 2;
+    inline constexpr std::size_t MAX_PAYLOAD_SIZE = 250;
+    inline constexpr std::size_t MAX_FRAME_SIZE = HEADER_SIZE + MAX_PAYLOAD_SIZE + CRC_SIZE;
+    // COBS adds one byte per 254 plus one, then the delimiter
+    inline constexpr std::size_t MAX_ENCODED_SIZE = MAX_FRAME_SIZE + MAX_FRAME_SIZE / 254 + 2;
+
+    // Request id of frames the machine sends on its own
+    inline constexpr uint16_t UNSOLICITED_ID = 0xFFFF;
+
+    enum class Type : uint8_t {
+        Ping = 0x01,             // Payload echoed back
+        Power = 0x02,            // [on u8]
+        SetBalance = 0x03,       // [balance i32]
+        SetProbabilities = 0x04, // n x [symbol u8][weight u16], see Symbol below
+        GetStatus = 0x05,        // Reply payload laid out as described at STATUS_PAYLOAD_SIZE
+        Subscribe = 0x06,        // [event class mask u8][min interval ms u16]
+        TextMode = 0x07,         // Reply, then back to the text protocol
+
+        Event = 0x7E,            // Unsolicited: [event class u8][seq u32][fields utf-8]
+        Error = 0x7F             // Unsolicited: [status u8] for a frame that failed to decode
+    };
+
+    enum class Status : uint8_t {
+        Ok = 0,
+        UnknownType = 1,
+        BadPayload = 2,   // Wrong length for the type
+        InvalidValue = 3,
+        BadFrame = 4      // CRC or COBS error; only in Error frames
+    };
+
+    // Symbol ids used by SetProbabilities
+    enum class Symbol : uint8_t {
+        Coin = 0,
+        Kleeblatt = 1,
+        Marienkaefer = 2,
+        Sonne = 3,
+        Teufel = 4
+    };
+    inline constexpr std::size_t SYMBOL_COUNT = 5;
+
+    // GetStatus reply after the status byte:
+    // [power u8][balance i32][bet i32][prize i32][session u8][risk mode u8]
+    // [risk level u8][risk prize i32]
+    inline constexpr std::size_t STATUS_PAYLOAD_SIZE = 20;
+
+    [[nodiscard]] constexpr uint16_t crc16(const std::span<const uint8_t> bytes) {
+        uint16_t crc = 0xFFFF;
+        for (const uint8_t byte: bytes) {
+            crc ^= static_cast<uint16_t>(byte << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    // out must hold in.size() + in.size() / 254 + 1 bytes. Returns the
+    // encoded size, without delimiter.
+    [[nodiscard]] constexpr std::size_t cobsEncode(const std::span<const uint8_t> in, const std::span<uint8_t> out) {
+        std::size_t codeIndex = 0;
+        std::size_t write = 1;
+        uint8_t code = 1;
+
+        for (const uint8_t byte: in) {
+            if (byte != 0) {
+                out[write++] = byte;
+                ++code;
+            }
+            if (byte == 0 || code == 0xFF) {
+                out[codeIndex] = code;
+                code = 1;
+                codeIndex = write++;
+            }
+        }
+        out[codeIndex] = code;
+        return write;
+    }
+
+    // Decodes in place-safe (out may alias in). Returns the decoded size or
+    // 0 if the input is not valid COBS.
+    [[nodiscard]] constexpr std::size_t cobsDecode(const std::span<const uint8_t> in, const std::span<uint8_t> out) {
+        std::size_t read = 0;
+        std::size_t write = 0;
+
+        while (read < in.size()) {
+            const uint8_t code = in[read++];
+            if (code == 0 || read + code - 1 > in.size()) {
+                return 0;
+            }
+            for (uint8_t i = 1; i < code; ++i) {
+                out[write++] = in[read++];
+            }
+            if (code != 0xFF && read != in.size()) {
+                out[write++] = 0;
+            }
+        }
+        return write;
+    }
+
+    struct Frame {
+        uint8_t type = 0;
+        uint16_t requestId = 0;
+        std::span<const uint8_t> payload;
+    };
+
+    // Outgoing frame, encoded and delimited, built in place
+    class TxFrame {
+    public:
+        // Payload is truncated to MAX_PAYLOAD_SIZE
+        TxFrame(const uint8_t type, const uint16_t requestId, const std::span<const uint8_t> payload) {
+            std::array<uint8_t, MAX_FRAME_SIZE> raw{};
+            const std::size_t payloadSize = payload.size() < MAX_PAYLOAD_SIZE ? payload.size() : MAX_PAYLOAD_SIZE;
+
+            raw[0] = type;
+            raw[1] = static_cast<uint8_t>(requestId & 0xFF);
+            raw[2] = static_cast<uint8_t>(requestId >> 8);
+            for (std::size_t i = 0; i < payloadSize; ++i) {
+                raw[HEADER_SIZE + i] = payload[i];
+            }
+
+            const std::size_t crcOffset = HEADER_SIZE + payloadSize;
+            const uint16_t crc = crc16(std::span(raw.data(), crcOffset));
+            raw[crcOffset] = static_cast<uint8_t>(crc & 0xFF);
+            raw[crcOffset + 1] = static_cast<uint8_t>(crc >> 8);
+
+            m_size = cobsEncode(std::span(raw.data(), crcOffset + CRC_SIZE), m_bytes);
+            m_bytes[m_size++] = DELIMITER;
+        }
+
+        [[nodiscard]] std::span<const uint8_t> bytes() const { return {m_bytes.data(), m_size}; }
+
+    private:
+        std::array<uint8_t, MAX_ENCODED_SIZE> m_bytes{};
+        std::size_t m_size = 0;
+    };
+
+    // Collects bytes up to each delimiter and hands out the decoded frame.
+    // Frames that are too long, not valid COBS or fail the CRC go to onError.
+    class FrameDecoder {
+    public:
+        // onFrame(const Frame &) returns false to stop (e.g. after TextMode);
+        // onError() takes no arguments. Returns the number of bytes consumed.
+        template<typename OnFrame, typename OnError>
+        std::size_t feed(const std::span<const uint8_t> bytes, OnFrame &&onFrame, OnError &&onError) {
+            for (std::size_t i = 0; i < bytes.size(); ++i) {
+                const uint8_t byte = bytes[i];
+                if (byte != DELIMITER) {
+                    if (m_size < m_buffer.size()) {
+                        m_buffer[m_size++] = byte;
+                    } else {
+                        m_overflow = true;
+                    }
+                    continue;
+                }
+
+                if (m_size == 0 && !m_overflow) {
+                    continue; // Idle delimiters between frames
+                }
+
+                const bool keepGoing = finishFrame(onFrame, onError);
+                if (!keepGoing) {
+                    return i + 1;
+                }
+            }
+            return bytes.size();
+        }
+
+        void reset() {
+            m_size = 0;
+            m_overflow = false;
+        }
+
+    private:
+        template<typename OnFrame, typename OnError>
+        bool finishFrame(OnFrame &onFrame, OnError &onError) {
+            const bool overflow = m_overflow;
+            const std::size_t decoded = overflow ? 0 : cobsDecode(std::span(m_buffer.data(), m_size), m_buffer);
+            reset();
+
+            if (decoded < HEADER_SIZE + CRC_SIZE) {
+                onError();
+                return true;
+            }
+
+            const std::size_t crcOffset = decoded - CRC_SIZE;
+            const uint16_t expected = static_cast<uint16_t>(m_buffer[crcOffset] | m_buffer[crcOffset + 1] << 8);
+            if (crc16(std::span(m_buffer.data(), crcOffset)) != expected) {
+                onError();
+                return true;
+            }
+
+            Frame frame;
+            frame.type = m_buffer[0];
+            frame.requestId = static_cast<uint16_t>(m_buffer[1] | m_buffer[2] << 8);
+            frame.payload = std::span(m_buffer.data() + HEADER_SIZE, crcOffset - HEADER_SIZE);
+            return onFrame(frame);
+        }
+
+        std::array<uint8_t, MAX_ENCODED_SIZE> m_buffer{};
+        std::size_t m_size = 0;
+        bool m_overflow = false;
+    };
+
+    [[nodiscard]] constexpr int32_t readInt32(const std::span<const uint8_t> bytes) {
+        return static_cast<int32_t>(static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+                                    static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    [[nodiscard]] constexpr uint16_t readUInt16(const std::span<const uint8_t> bytes) {
+        return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+    }
+
+    constexpr void writeInt32(const std::span<uint8_t> out, const int32_t value) {
+        const auto raw = static_cast<uint32_t>(value);
+        out[0] = static_cast<uint8_t>(raw & 0xFF);
+        out[1] = static_cast<uint8_t>((raw >> 8) & 0xFF);
+        out[2] = static_cast<uint8_t>((raw >> 16) & 0xFF);
+        out[3] = static_cast<uint8_t>((raw >> 24) & 0xFF);
+    }
+}
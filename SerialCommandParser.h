@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+
+// Tokenizer for the ASCII serial protocol. Works on views into the line the
+// framer handed out, so nothing here allocates.
+//
+//   <COMMAND> [args...]
+//
+// Command names are matched case-insensitively against a static table whose
+// entries have a name, an optional alias and whatever the caller dispatches on.
+namespace SerialCommandParser {
+    struct Tokens {
+        std::string_view command;
+        std::string_view args; // Rest of the line, trimmed
+    };
+
+    [[nodiscard]] constexpr bool isSpace(const char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    [[nodiscard]] constexpr std::string_view trimmed(std::string_view text) {
+        while (!text.empty() && isSpace(text.front())) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && isSpace(text.back())) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Removes and returns the first whitespace-delimited token of text
+    [[nodiscard]] constexpr std::string_view nextToken(std::string_view &text) {
+        text = trimmed(text);
+        std::size_t end = 0;
+        while (end < text.size() && !isSpace(text[end])) {
+            ++end;
+        }
+        const std::string_view token = text.substr(0, end);
+        text = trimmed(text.substr(end));
+        return token;
+    }
+
+    [[nodiscard]] constexpr Tokens tokenize(std::string_view line) {
+        const std::string_view command = nextToken(line);
+        return {command, line};
+    }
+
+    [[nodiscard]] constexpr bool equalsIgnoreCase(const std::string_view a, const std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const auto upper = [](const char c) {
+                return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+            };
+            if (upper(a[i]) != upper(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Entry needs `name` and `alias` string_view members; an empty alias
+    // never matches. Returns nullptr for unknown commands.
+    template<typename Entry, std::size_t N>
+    [[nodiscard]] constexpr const Entry *find(const std::array<Entry, N> &table, const std::string_view command) {
+        if (command.empty()) {
+            return nullptr;
+        }
+        for (const Entry &entry: table) {
+            if (equalsIgnoreCase(command, entry.name) ||
+                (!entry.alias.empty() && equalsIgnoreCase(command, entry.alias))) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // Whole token must be a finite number
+    [[nodiscard]] inline bool parseDouble(const std::string_view token, double &value) {
+        const char *first = token.data();
+        const char *last = token.data() + token.size();
+        if (first != last && *first == '+') {
+            ++first;
+        }
+
+        double parsed = 0.0;
+        const auto [end, ec] = std::from_chars(first, last, parsed);
+        if (ec != std::errc() || end != last || !std::isfinite(parsed)) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // Whole token must be a non-negative decimal integer
+    [[nodiscard]] inline bool parseUInt(const std::string_view token, unsigned &value) {
+        unsigned parsed = 0;
+        const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), parsed);
+        if (token.empty() || ec != std::errc() || end != token.data() + token.size()) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+}
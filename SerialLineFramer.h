@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+// Splits the serial byte stream into '\n'-terminated lines (a trailing '\r'
+// is dropped) without allocating. The port reads straight into writable(),
+// and drain() hands out every complete line as a view into the ring, so
+// each byte is copied once and scanned once however bursty the input is.
+// Only a line that wraps around the end of the ring goes through a scratch
+// copy.
+//
+// At most one incomplete line stays buffered between drains. A line longer
+// than MAX_LINE_LENGTH is dropped whole, up to and including its newline,
+// and counted in overlongLines().
+class SerialLineFramer {
+public:
+    static constexpr std::size_t CAPACITY = 4096;
+    static constexpr std::size_t MAX_LINE_LENGTH = 1024;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(MAX_LINE_LENGTH < CAPACITY);
+
+    // Contiguous free space for the next read; never empty after drain()
+    [[nodiscard]] std::span<char> writable() {
+        const std::size_t free = CAPACITY - (m_tail - m_head);
+        const std::size_t offset = m_tail & MASK;
+        return {m_ring.data() + offset, std::min(free, CAPACITY - offset)};
+    }
+
+    // Marks count bytes of writable() as filled
+    void commit(const std::size_t count) {
+        m_tail += count;
+    }
+
+    // Calls onLine(std::string_view) for every complete, non-empty line. The
+    // view is only valid during the call, and only if onLine writes nothing
+    // into the framer.
+    template<typename OnLine>
+    void drain(OnLine &&onLine) {
+        while (m_scan != m_tail) {
+            const std::size_t offset = m_scan & MASK;
+            const std::size_t length = std::min(m_tail - m_scan, CAPACITY - offset);
+            const auto *newline = static_cast<const char *>(std::memchr(m_ring.data() + offset, '\n', length));
+            if (!newline) {
+                m_scan += length;
+                continue;
+            }
+
+            // Consumed before onLine runs, so a drain() nested inside it
+            // cannot hand the same line out again
+            const std::size_t start = m_head;
+            const std::size_t end = m_scan + static_cast<std::size_t>(newline - (m_ring.data() + offset));
+            m_head = m_scan = end + 1;
+            emitLine(start, end, onLine);
+        }
+
+        if (m_tail - m_head > MAX_LINE_LENGTH) {
+            // Start of a line that can never fit: skip to its newline
+            if (!m_discarding) {
+                m_discarding = true;
+                ++m_overlong_lines;
+            }
+            m_head = m_tail;
+        }
+    }
+
+    // Copies bytes in and drains as it goes; for sources that are not a port
+    template<typename OnLine>
+    void feed(std::span<const char> bytes, OnLine &&onLine) {
+        while (!bytes.empty()) {
+            const std::span<char> space = writable();
+            const std::size_t count = std::min(space.size(), bytes.size());
+            std::memcpy(space.data(), bytes.data(), count);
+            commit(count);
+            drain(onLine);
+            bytes = bytes.subspan(count);
+        }
+    }
+
+    // Forgets the incomplete line, if any
+    void clear() {
+        m_head = m_scan = m_tail;
+        m_discarding = false;
+    }
+
+    [[nodiscard]] uint64_t overlongLines() const { return m_overlong_lines; }
+
+    // Bytes of the incomplete line held back for the next drain()
+    [[nodiscard]] std::size_t pending() const { return m_tail - m_head; }
+
+private:
+    static constexpr std::size_t MASK = CAPACITY - 1;
+
+    template<typename OnLine>
+    void emitLine(const std::size_t start, const std::size_t end, OnLine &onLine) {
+        if (m_discarding) {
+            m_discarding = false;
+            return;
+        }
+
+        std::size_t length = end - start;
+        if (length > MAX_LINE_LENGTH) {
+            ++m_overlong_lines;
+            return;
+        }
+
+        const std::size_t offset = start & MASK;
+        const char *data = m_ring.data() + offset;
+        if (offset + length > CAPACITY) {
+            const std::size_t first = CAPACITY - offset;
+            std::memcpy(m_scratch.data(), data, first);
+            std::memcpy(m_scratch.data() + first, m_ring.data(), length - first);
+            data = m_scratch.data();
+        }
+
+        if (length > 0 && data[length - 1] == '\r') {
+            --length;
+        }
+        if (length > 0) {
+            onLine(std::string_view(data, length));
+        }
+    }
+
+    // Free-running positions: m_head is the start of the current line,
+    // m_scan the first byte not yet searched for '\n', m_tail the write end
+    std::size_t m_head = 0;
+    std::size_t m_scan = 0;
+    std::size_t m_tail = 0;
+    bool m_discarding = false;
+    uint64_t m_overlong_lines = 0;
+
+    std::array<char, CAPACITY> m_ring{};
+    std::array<char, MAX_LINE_LENGTH> m_scratch{};
+};
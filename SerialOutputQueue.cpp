@@ -0,0 +1,100 @@
+#include "SerialOutputQueue.h"
+#include <algorithm>
+
+SerialOutputQueue::SerialOutputQueue(const qsizetype capacity)
+    : m_capacity(capacity) {
+}
+
+bool SerialOutputQueue::push(QByteArray bytes, const Kind kind) {
+    const qsizetype size = bytes.size();
+    if (size == 0) {
+        return true;
+    }
+
+    if (!fits(size)) {
+        if (m_policy == OverflowPolicy::Block) {
+            // The worker pauses input while over capacity; this only
+            // bounds a link that has stopped draining
+            if (m_queued_bytes + size > m_capacity * BLOCK_OVERCOMMIT) {
+                ++(kind == Kind::Reply ? m_stats.droppedReplies : m_stats.droppedTelemetry);
+                return false;
+            }
+            ++m_stats.parkedMessages;
+        } else if (kind == Kind::Telemetry || m_policy != OverflowPolicy::KeepReplies) {
+            ++(kind == Kind::Reply ? m_stats.droppedReplies : m_stats.droppedTelemetry);
+            return false;
+        } else {
+            evictTelemetry(size);
+            if (!fits(size)) {
+                ++m_stats.repliesOverCapacity;
+            }
+        }
+    }
+
+    m_messages.push_back({std::move(bytes), kind});
+    m_queued_bytes += size;
+    m_stats.peakBytes = std::max(m_stats.peakBytes, m_queued_bytes);
+    ++m_stats.queuedMessages;
+    return true;
+}
+
+QByteArray SerialOutputQueue::take(const qsizetype budget) {
+    QByteArray chunk;
+    while (!m_messages.empty() &&
+           (chunk.isEmpty() || chunk.size() + m_messages.front().bytes.size() <= budget)) {
+        Message &front = m_messages.front();
+        m_queued_bytes -= front.bytes.size();
+        if (chunk.isEmpty()) {
+            chunk = std::move(front.bytes);
+        } else {
+            chunk.append(front.bytes);
+        }
+        m_messages.pop_front();
+    }
+    return chunk;
+}
+
+void SerialOutputQueue::clear() {
+    m_messages.clear();
+    m_queued_bytes = 0;
+}
+
+void SerialOutputQueue::evictTelemetry(const qsizetype needed) {
+    // Oldest first: that is the most stale information in the queue
+    for (auto it = m_messages.begin(); it != m_messages.end() && !fits(needed);) {
+        if (it->kind == Kind::Telemetry) {
+            m_queued_bytes -= it->bytes.size();
+            ++m_stats.evictedTelemetry;
+            it = m_messages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+SerialOutputQueue::Stats SerialOutputQueue::stats() const {
+    Stats stats = m_stats;
+    stats.queuedBytes = m_queued_bytes;
+    stats.capacity = m_capacity;
+    return stats;
+}
+
+QString SerialOutputQueue::policyName(const OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::Block: return "block";
+        case OverflowPolicy::DropTelemetry: return "drop-telemetry";
+        case OverflowPolicy::KeepReplies: return "keep-replies";
+        default: return "unknown";
+    }
+}
+
+bool SerialOutputQueue::policyFromString(const QString &text, OverflowPolicy &policy) {
+    for (const OverflowPolicy candidate: {OverflowPolicy::Block, OverflowPolicy::DropTelemetry,
+                                          OverflowPolicy::KeepReplies}) {
+        if (text.trimmed().compare(policyName(candidate), Qt::CaseInsensitive) == 0) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <deque>
+
+// Bounded buffer between SerialWorker's producers and the port. Messages are
+// queued already encoded and handed to QSerialPort a little at a time as
+// bytesWritten comes back, so a burst of output never turns into a
+// synchronous write and the queue, not QSerialPort's unbounded internal
+// buffer, decides what happens when the link cannot keep up.
+//
+// Replies answer a command the client sent; telemetry is anything the
+// machine sends on its own. What happens when a message does not fit
+// depends on the policy:
+//
+//   Block          Nothing is dropped: a message that does not fit is
+//                  parked over capacity and SerialWorker stops reading
+//                  commands until the queue is back under capacity, so the
+//                  client is slowed down instead of the serial thread
+//                  stalling. Only a link that stops draining altogether
+//                  hits the hard limit of BLOCK_OVERCOMMIT times capacity,
+//                  past which output is dropped. For scripted bulk
+//                  transfers.
+//   DropTelemetry  Whatever does not fit is dropped. Memory is strictly
+//                  bounded.
+//   KeepReplies    Telemetry that does not fit is dropped. A reply first
+//                  evicts queued telemetry, oldest first, and is queued over
+//                  capacity if that is not enough, so every command gets its
+//                  answer. Default.
+//
+// Not thread-safe; lives on the serial thread with its worker.
+class SerialOutputQueue {
+public:
+    enum class Kind : uint8_t {
+        Reply,
+        Telemetry
+    };
+
+    enum class OverflowPolicy : uint8_t {
+        Block,
+        DropTelemetry,
+        KeepReplies
+    };
+
+    static constexpr qsizetype DEFAULT_CAPACITY = 16 * 1024;
+    static constexpr qsizetype BLOCK_OVERCOMMIT = 4;
+
+    struct Stats {
+        uint64_t queuedMessages = 0;
+        uint64_t writtenBytes = 0;
+        uint64_t droppedReplies = 0;
+        uint64_t droppedTelemetry = 0;
+        uint64_t evictedTelemetry = 0;
+        uint64_t repliesOverCapacity = 0;
+        uint64_t parkedMessages = 0;  // Block: queued over capacity
+        uint64_t inputPauses = 0;
+        qsizetype queuedBytes = 0;
+        qsizetype peakBytes = 0;
+        qsizetype capacity = 0;
+    };
+
+    explicit SerialOutputQueue(qsizetype capacity = DEFAULT_CAPACITY);
+
+    void setPolicy(OverflowPolicy policy) { m_policy = policy; }
+    [[nodiscard]] OverflowPolicy policy() const { return m_policy; }
+
+    // False if the message was dropped
+    bool push(QByteArray bytes, Kind kind);
+
+    [[nodiscard]] bool fits(qsizetype size) const { return m_queued_bytes + size <= m_capacity; }
+    [[nodiscard]] bool isOverCapacity() const { return m_queued_bytes > m_capacity; }
+    [[nodiscard]] bool isEmpty() const { return m_messages.empty(); }
+
+    // Whole messages from the front, at least one, until budget is spent
+    [[nodiscard]] QByteArray take(qsizetype budget);
+
+    void clear();
+
+    void noteWritten(const qint64 bytes) { m_stats.writtenBytes += static_cast<uint64_t>(bytes); }
+    void noteInputPaused() { ++m_stats.inputPauses; }
+
+    [[nodiscard]] Stats stats() const;
+
+    [[nodiscard]] static QString policyName(OverflowPolicy policy);
+
+    // "block", "drop-telemetry" or "keep-replies"
+    [[nodiscard]] static bool policyFromString(const QString &text, OverflowPolicy &policy);
+
+private:
+    struct Message {
+        QByteArray bytes;
+        Kind kind;
+    };
+
+    void evictTelemetry(qsizetype needed);
+
+    std::deque<Message> m_messages;
+    qsizetype m_queued_bytes = 0;
+    qsizetype m_capacity;
+    OverflowPolicy m_policy = OverflowPolicy::KeepReplies;
+    Stats m_stats;
+};
@@ -1,15 +1,47 @@
 #include "SerialWorker.h"
 #include "DebugLogger.h"
+#include "SerialCommandParser.h"
+#include "Trace.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+    struct EventClassEntry {
+        std::string_view name;
+        std::string_view alias;
+        SerialWorker::EventClass eventClass;
+    };
+
+    constexpr std::array<EventClassEntry, SerialWorker::EVENT_CLASS_COUNT> EVENT_CLASSES = {{
+        {"SPIN", "", SerialWorker::EventClass::Spin},
+        {"BALANCE", "", SerialWorker::EventClass::Balance},
+        {"RISK", "", SerialWorker::EventClass::Risk},
+        {"POWER", "", SerialWorker::EventClass::Power},
+        {"I2C", "I2C_HEALTH", SerialWorker::EventClass::I2CHealth},
+    }};
+
+    constexpr unsigned MAX_EVENT_INTERVAL_MS = 3600 * 1000;
+
+    QString toQString(const std::string_view text) {
+        return QString::fromLatin1(text.data(), static_cast<qsizetype>(text.size()));
+    }
+}
 
 SerialWorker::SerialWorker(QObject *parent)
     : QObject(parent)
 #ifdef Q_OS_LINUX
       , m_serial_port(new QSerialPort(this))
 #endif
+      , m_event_timer(new ClockTimer(this))
 {
+    m_event_timer->setSingleShot(true);
+    connect(m_event_timer, &ClockTimer::timeout, this, &SerialWorker::flushPendingEvents);
 }
 
 SerialWorker::~SerialWorker() {
@@ -19,6 +51,7 @@ SerialWorker::~SerialWorker() {
 void SerialWorker::initialize() {
     DebugLogger::instance().info("SerialWorker initialized on thread: " +
                                  QString::number(reinterpret_cast<quint64>(QThread::currentThreadId())));
+    Trace::setThreadName("Serial");
 #ifndef Q_OS_LINUX
     DebugLogger::instance().warning("SerialWorker: Serial port support is disabled on this platform (macOS)");
 #endif
@@ -100,6 +133,8 @@ void SerialWorker::openPort(const QString &portName) {
                 this, &SerialWorker::handleReadyRead);
         connect(m_serial_port, &QSerialPort::errorOccurred,
                 this, &SerialWorker::handleError);
+        connect(m_serial_port, &QSerialPort::bytesWritten,
+                this, &SerialWorker::handleBytesWritten);
 
         const QString successMsg = QString("Serial port opened: %1 at %2 baud")
             .arg(selectedPort).arg(BAUD_RATE);
@@ -108,7 +143,7 @@ void SerialWorker::openPort(const QString &portName) {
 
         // Send welcome message
         sendResponse("# AllesSpitze Serial Interface Ready\n");
-        sendResponse("# Commands: POWER_ON, POWER_OFF, SET_BALANCE <value>, SET_PROB <json>, STATUS\n");
+        sendResponse("# Commands: POWER_ON, POWER_OFF, SET_BALANCE <value>, SET_PROB <json>, STATUS, I2C_STATS, LATENCY, METRICS, SERIAL_STATS, SUBSCRIBE, UNSUBSCRIBE, TRACE\n");
     } else {
         const QString errorMsg = QString("Failed to open serial port %1: %2")
             .arg(selectedPort).arg(m_serial_port->errorString());
@@ -127,6 +162,12 @@ void SerialWorker::closePort() {
     if (m_serial_port && m_is_open) {
         m_serial_port->close();
         m_is_open = false;
+        m_output.clear();
+        m_input_paused = false;
+        clearSubscriptions();
+        m_binary_mode = false;
+        m_frame_decoder.reset();
+        m_framer.clear();
         DebugLogger::instance().info("Serial port closed");
         emit portClosed();
     }
@@ -135,25 +176,68 @@ void SerialWorker::closePort() {
 
 #ifdef Q_OS_LINUX
 void SerialWorker::handleReadyRead() {
-    m_read_buffer.append(m_serial_port->readAll());
-
-    // Process complete lines (terminated by \n or \r\n)
-    while (m_read_buffer.contains('\n')) {
-        const int newlinePos = m_read_buffer.indexOf('\n');
-        QByteArray line = m_read_buffer.left(newlinePos);
-        m_read_buffer.remove(0, newlinePos + 1);
+    // Nothing here waits on the port, but a nested call would hand the
+    // framer's current line out twice
+    if (m_reading || m_input_paused) {
+        return;
+    }
+    m_reading = true;
+    const uint64_t overlongBefore = m_framer.overlongLines();
+
+    // Paused by a reply that overfilled a Block queue: the rest stays in
+    // the port until handleBytesWritten() drains it
+    while (!m_input_paused) {
+        if (m_binary_mode) {
+            std::array<char, 512> chunk;
+            const qint64 bytesRead = m_serial_port->read(chunk.data(), static_cast<qint64>(chunk.size()));
+            if (bytesRead <= 0) {
+                break;
+            }
+            consumeInput(std::span(chunk.data(), static_cast<std::size_t>(bytesRead)));
+            continue;
+        }
 
-        // Remove trailing \r if present
-        if (line.endsWith('\r')) {
-            line.chop(1);
+        // Text: read straight into the framer's ring; lines are handled as
+        // views into it
+        const std::span<char> space = m_framer.writable();
+        const qint64 bytesRead = m_serial_port->read(space.data(), static_cast<qint64>(space.size()));
+        if (bytesRead <= 0) {
+            break;
         }
 
-        if (!line.isEmpty()) {
-            const QString command = QString::fromUtf8(line).trimmed();
-            DebugLogger::instance().verbose("Serial RX: " + command);
-            processCommand(command);
+        const std::span<const char> received = space.first(static_cast<std::size_t>(bytesRead));
+        const auto *nul = static_cast<const char *>(std::memchr(received.data(), 0, received.size()));
+        const std::size_t textBytes = nul ? static_cast<std::size_t>(nul - received.data()) : received.size();
+
+        m_framer.commit(textBytes);
+        m_framer.drain([this](const std::string_view line) { processLine(line); });
+
+        if (nul) {
+            // The rest still sits in the ring's free space; move it out
+            // before anything else writes there
+            std::array<char, SerialLineFramer::CAPACITY> rest;
+            const std::size_t restSize = received.size() - textBytes;
+            std::memcpy(rest.data(), nul, restSize);
+            enterBinaryMode();
+            consumeInput(std::span(rest.data(), restSize));
         }
     }
+
+    m_reading = false;
+    for (uint64_t n = overlongBefore; n < m_framer.overlongLines(); ++n) {
+        sendResponse(QString("ERROR: Line too long (max %1 bytes)\n").arg(SerialLineFramer::MAX_LINE_LENGTH));
+    }
+}
+
+void SerialWorker::handleBytesWritten(const qint64 bytes) {
+    m_output.noteWritten(bytes);
+    pumpOutput();
+
+    if (m_input_paused && !m_output.isOverCapacity()) {
+        m_input_paused = false;
+        // readyRead is not repeated for what is already buffered
+        QMetaObject::invokeMethod(this, &SerialWorker::handleReadyRead, Qt::QueuedConnection);
+    }
 }
 
 void SerialWorker::handleError(QSerialPort::SerialPortError error) {
@@ -165,98 +249,631 @@ void SerialWorker::handleError(QSerialPort::SerialPortError error) {
 }
 #endif
 
-void SerialWorker::processCommand(const QString &line) {
-    const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-    if (parts.isEmpty()) {
+const std::array<SerialWorker::CommandEntry, 12> SerialWorker::COMMANDS = {{
+    {"POWER_ON", "ON", &SerialWorker::handlePowerOn},
+    {"POWER_OFF", "OFF", &SerialWorker::handlePowerOff},
+    {"SET_BALANCE", "BALANCE", &SerialWorker::handleSetBalance},
+    {"SET_PROB", "PROBABILITIES", &SerialWorker::handleSetProbabilities},
+    {"STATUS", "?", &SerialWorker::handleStatus},
+    {"I2C_STATS", "", &SerialWorker::handleI2CStats},
+    {"LATENCY", "", &SerialWorker::handleLatency},
+    {"METRICS", "", &SerialWorker::handleMetrics},
+    {"SERIAL_STATS", "", &SerialWorker::handleSerialStats},
+    {"SUBSCRIBE", "", &SerialWorker::handleSubscribe},
+    {"UNSUBSCRIBE", "", &SerialWorker::handleUnsubscribe},
+    {"TRACE", "", &SerialWorker::handleTrace},
+}};
+
+void SerialWorker::processLine(const std::string_view line) {
+    const auto [command, args] = SerialCommandParser::tokenize(line);
+    if (command.empty()) {
+        return;
+    }
+
+    Trace::Span span("serial", "processLine");
+    if (DebugLogger::instance().verbosity() == DebugLogger::LogVerbosity::Verbose) {
+        DebugLogger::instance().verbose("Serial RX: " +
+                                        QString::fromUtf8(line.data(), static_cast<qsizetype>(line.size())));
+    }
+
+    if (const CommandEntry *entry = SerialCommandParser::find(COMMANDS, command)) {
+        (this->*entry->handler)(args);
+    } else {
+        sendResponse("ERROR: Unknown command. Available: POWER_ON, POWER_OFF, SET_BALANCE, SET_PROB, STATUS, I2C_STATS, LATENCY, METRICS, SERIAL_STATS, SUBSCRIBE, UNSUBSCRIBE, TRACE\n");
+    }
+}
+
+void SerialWorker::consumeInput(std::span<const char> bytes) {
+    while (!bytes.empty()) {
+        if (m_binary_mode) {
+            const std::size_t consumed = m_frame_decoder.feed(
+                std::span(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size()),
+                [this](const SerialBinaryProtocol::Frame &frame) { return handleBinaryFrame(frame); },
+                [this]() { handleBinaryFrameError(); });
+            bytes = bytes.subspan(consumed);
+            continue;
+        }
+
+        // A NUL never occurs in text, so it can only mean "binary from here"
+        const auto *nul = static_cast<const char *>(std::memchr(bytes.data(), 0, bytes.size()));
+        const std::size_t textBytes = nul ? static_cast<std::size_t>(nul - bytes.data()) : bytes.size();
+        m_framer.feed(bytes.first(textBytes), [this](const std::string_view line) { processLine(line); });
+        bytes = bytes.subspan(textBytes);
+        if (nul) {
+            enterBinaryMode();
+        }
+    }
+}
+
+void SerialWorker::enterBinaryMode() {
+    m_binary_mode = true;
+    m_frame_decoder.reset();
+    m_framer.clear();
+    DebugLogger::instance().info("Serial: client switched to the binary protocol");
+}
+
+bool SerialWorker::handleBinaryFrame(const SerialBinaryProtocol::Frame &frame) {
+    using namespace SerialBinaryProtocol;
+    ++m_binary_frames;
+    Trace::Span span("serial", "binaryFrame");
+    span.setArg("type", frame.type);
+
+    if (DebugLogger::instance().verbosity() == DebugLogger::LogVerbosity::Verbose) {
+        DebugLogger::instance().verbose(QString("Serial RX frame: type 0x%1 id %2, %3 payload bytes")
+            .arg(frame.type, 2, 16, QChar('0')).arg(frame.requestId).arg(frame.payload.size()));
+    }
+
+    const std::span<const uint8_t> payload = frame.payload;
+    switch (static_cast<Type>(frame.type)) {
+        case Type::Ping:
+            sendBinaryReply(frame, Status::Ok, payload);
+            return true;
+
+        case Type::Power:
+            if (payload.size() != 1) {
+                sendBinaryReply(frame, Status::BadPayload);
+            } else if (payload[0] > 1) {
+                sendBinaryReply(frame, Status::InvalidValue);
+            } else {
+                sendBinaryReply(frame, Status::Ok);
+                emit commandReceived(payload[0] ? Command::PowerOn : Command::PowerOff, QVariantMap());
+            }
+            return true;
+
+        case Type::SetBalance: {
+            if (payload.size() != 4) {
+                sendBinaryReply(frame, Status::BadPayload);
+                return true;
+            }
+
+            const int32_t cents = readInt32(payload);
+            if (cents < 0) {
+                sendBinaryReply(frame, Status::InvalidValue);
+                return true;
+            }
+
+            QVariantMap params;
+            params["balance"] = cents / 100.0;
+            sendBinaryReply(frame, Status::Ok);
+            emit commandReceived(Command::SetBalance, params);
+            return true;
+        }
+
+        case Type::SetProbabilities: {
+            if (payload.empty() || payload.size() % 3 != 0) {
+                sendBinaryReply(frame, Status::BadPayload);
+                return true;
+            }
+
+            static const std::array<QString, SYMBOL_COUNT> symbolKeys = {
+                "coin", "kleeblatt", "marienkaefer", "sonne", "teufel"
+            };
+            QVariantMap probMap;
+            for (std::size_t offset = 0; offset < payload.size(); offset += 3) {
+                const uint8_t symbol = payload[offset];
+                if (symbol >= SYMBOL_COUNT) {
+                    sendBinaryReply(frame, Status::InvalidValue);
+                    return true;
+                }
+                probMap[symbolKeys[symbol]] = static_cast<int>(readUInt16(payload.subspan(offset + 1)));
+            }
+
+            QVariantMap params;
+            params["probabilities"] = probMap;
+            sendBinaryReply(frame, Status::Ok);
+            emit commandReceived(Command::SetProbabilities, params);
+            return true;
+        }
+
+        case Type::GetStatus: {
+            if (!payload.empty()) {
+                sendBinaryReply(frame, Status::BadPayload);
+                return true;
+            }
+
+            // Answered by sendStatusReport() once the GUI thread has the numbers
+            QVariantMap params;
+            params["requestId"] = static_cast<int>(frame.requestId);
+            emit commandReceived(Command::GetStatus, params);
+            return true;
+        }
+
+        case Type::Subscribe: {
+            if (payload.size() != 3) {
+                sendBinaryReply(frame, Status::BadPayload);
+                return true;
+            }
+
+            const uint8_t mask = payload[0];
+            if (mask >> EVENT_CLASS_COUNT) {
+                sendBinaryReply(frame, Status::InvalidValue);
+                return true;
+            }
+
+            const int intervalMs = readUInt16(payload.subspan(1));
+            for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+                if (mask & (1u << i)) {
+                    m_subscriptions[i].active = true;
+                    m_subscriptions[i].minIntervalMs = intervalMs;
+                } else {
+                    m_subscriptions[i] = Subscription();
+                }
+            }
+            storeSubscriptionMask();
+            sendBinaryReply(frame, Status::Ok);
+            return true;
+        }
+
+        case Type::TextMode:
+            sendBinaryReply(frame, Status::Ok);
+            m_binary_mode = false;
+            DebugLogger::instance().info("Serial: client switched back to the text protocol");
+            return false;
+
+        default:
+            sendBinaryReply(frame, Status::UnknownType);
+            return true;
+    }
+}
+
+void SerialWorker::handleBinaryFrameError() {
+    using namespace SerialBinaryProtocol;
+    ++m_binary_frame_errors;
+
+    // The request id cannot be trusted, so this is not a reply
+    const std::array<uint8_t, 1> payload = {static_cast<uint8_t>(Status::BadFrame)};
+    sendBinaryFrame(static_cast<uint8_t>(Type::Error), UNSOLICITED_ID, payload, SerialOutputQueue::Kind::Reply);
+}
+
+void SerialWorker::sendBinaryReply(const SerialBinaryProtocol::Frame &request,
+                                   const SerialBinaryProtocol::Status status,
+                                   const std::span<const uint8_t> payload) {
+    using namespace SerialBinaryProtocol;
+    std::array<uint8_t, MAX_PAYLOAD_SIZE> body;
+    const std::size_t payloadSize = std::min(payload.size(), MAX_PAYLOAD_SIZE - 1);
+    body[0] = static_cast<uint8_t>(status);
+    std::copy_n(payload.begin(), payloadSize, body.begin() + 1);
+
+    sendBinaryFrame(request.type | REPLY_FLAG, request.requestId, std::span(body.data(), payloadSize + 1),
+                    SerialOutputQueue::Kind::Reply);
+}
+
+void SerialWorker::sendBinaryFrame(const uint8_t type, const uint16_t requestId,
+                                   const std::span<const uint8_t> payload,
+                                   const SerialOutputQueue::Kind kind) {
+    const SerialBinaryProtocol::TxFrame frame(type, requestId, payload);
+    const std::span<const uint8_t> bytes = frame.bytes();
+    enqueueBytes(QByteArray(reinterpret_cast<const char *>(bytes.data()), static_cast<qsizetype>(bytes.size())),
+                 kind);
+}
+
+void SerialWorker::sendStatusReport(const int requestId, const StatusReport &report) {
+    if (requestId < 0) {
+        sendResponse(QString(
+            "=== AllesSpitze Status ===\n"
+            "Power: %1\n"
+            "Balance: %2\n"
+            "Bet: %3\n"
+            "Current Prize: %4\n"
+            "Session Active: %5\n"
+            "Risk Mode: %6\n"
+            "Risk Level: %7\n"
+            "Risk Prize: %8\n"
+            "==========================\n"
+        ).arg(report.poweredOn ? "ON" : "OFF")
+         .arg(report.balance)
+         .arg(report.bet)
+         .arg(report.currentPrize)
+         .arg(report.sessionActive ? "YES" : "NO")
+         .arg(report.riskModeActive ? "YES" : "NO")
+         .arg(report.riskLevel)
+         .arg(report.riskPrize));
+        return;
+    }
+
+    if (!m_binary_mode) {
+        return; // Client left binary mode before the answer arrived
+    }
+
+    using namespace SerialBinaryProtocol;
+    const auto cents = [](const double amount) { return static_cast<int32_t>(std::llround(amount * 100.0)); };
+
+    std::array<uint8_t, 1 + STATUS_PAYLOAD_SIZE> body{};
+    body[0] = static_cast<uint8_t>(Status::Ok);
+    body[1] = report.poweredOn ? 1 : 0;
+    writeInt32(std::span(body).subspan(2), cents(report.balance));
+    writeInt32(std::span(body).subspan(6), cents(report.bet));
+    writeInt32(std::span(body).subspan(10), cents(report.currentPrize));
+    body[14] = report.sessionActive ? 1 : 0;
+    body[15] = report.riskModeActive ? 1 : 0;
+    body[16] = static_cast<uint8_t>(report.riskLevel);
+    writeInt32(std::span(body).subspan(17), cents(report.riskPrize));
+
+    sendBinaryFrame(static_cast<uint8_t>(Type::GetStatus) | REPLY_FLAG, static_cast<uint16_t>(requestId), body,
+                    SerialOutputQueue::Kind::Reply);
+}
+
+void SerialWorker::handlePowerOn(std::string_view) {
+    sendResponse("OK: Powering on\n");
+    emit commandReceived(Command::PowerOn, QVariantMap());
+}
+
+void SerialWorker::handlePowerOff(std::string_view) {
+    sendResponse("OK: Powering off\n");
+    emit commandReceived(Command::PowerOff, QVariantMap());
+}
+
+void SerialWorker::handleSetBalance(std::string_view args) {
+    const std::string_view value = SerialCommandParser::nextToken(args);
+    if (value.empty()) {
+        sendResponse("ERROR: SET_BALANCE requires value (e.g., SET_BALANCE 100.5)\n");
+        return;
+    }
+
+    double balance = 0.0;
+    if (!SerialCommandParser::parseDouble(value, balance) || balance < 0) {
+        sendResponse("ERROR: Invalid balance value\n");
         return;
     }
 
-    const QString cmd = parts[0].toUpper();
     QVariantMap params;
+    params["balance"] = balance;
+    sendResponse(QString("OK: Balance set to %1\n").arg(balance));
+    emit commandReceived(Command::SetBalance, params);
+}
 
-    if (cmd == "POWER_ON" || cmd == "ON") {
-        sendResponse("OK: Powering on\n");
-        emit commandReceived(Command::PowerOn, params);
+void SerialWorker::handleSetProbabilities(const std::string_view args) {
+    if (args.empty()) {
+        sendResponse("ERROR: SET_PROB requires JSON (e.g., SET_PROB {\"coin\":10,\"kleeblatt\":15})\n");
+        return;
+    }
 
-    } else if (cmd == "POWER_OFF" || cmd == "OFF") {
-        sendResponse("OK: Powering off\n");
-        emit commandReceived(Command::PowerOff, params);
+    const QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(args.data(), static_cast<qsizetype>(args.size())));
 
-    } else if (cmd == "SET_BALANCE" || cmd == "BALANCE") {
-        if (parts.size() < 2) {
-            sendResponse("ERROR: SET_BALANCE requires value (e.g., SET_BALANCE 100.5)\n");
-            return;
+    if (!doc.isObject()) {
+        sendResponse("ERROR: Invalid JSON format\n");
+        return;
+    }
+
+    const QJsonObject obj = doc.object();
+    QVariantMap probMap;
+
+    // Expected keys: coin, kleeblatt, marienkaefer, sonne, teufel
+    const QStringList validKeys = {"coin", "kleeblatt", "marienkaefer", "sonne", "teufel"};
+    for (const QString &key : validKeys) {
+        if (obj.contains(key)) {
+            probMap[key] = obj[key].toInt();
         }
+    }
 
-        bool ok;
-        const double balance = parts[1].toDouble(&ok);
-        if (!ok || balance < 0) {
-            sendResponse("ERROR: Invalid balance value\n");
+    if (probMap.isEmpty()) {
+        sendResponse("ERROR: No valid probabilities found\n");
+        return;
+    }
+
+    QVariantMap params;
+    params["probabilities"] = probMap;
+    sendResponse("OK: Probabilities updated\n");
+    emit commandReceived(Command::SetProbabilities, params);
+}
+
+void SerialWorker::handleStatus(std::string_view) {
+    sendStatus();
+}
+
+void SerialWorker::handleI2CStats(std::string_view) {
+    emit commandReceived(Command::GetI2CStats, QVariantMap());
+}
+
+void SerialWorker::handleTrace(std::string_view args) {
+    const std::string_view action = SerialCommandParser::nextToken(args);
+    for (const std::string_view known: {"ON", "OFF", "DUMP", "STATUS"}) {
+        if (SerialCommandParser::equalsIgnoreCase(action, known) && args.empty()) {
+            QVariantMap params;
+            params["action"] = toQString(known).toLower();
+            emit commandReceived(Command::Trace, params);
             return;
         }
+    }
+    sendResponse("ERROR: TRACE requires ON, OFF, DUMP or STATUS\n");
+}
+
+void SerialWorker::handleLatency(std::string_view) {
+    emit commandReceived(Command::GetLatency, QVariantMap());
+}
+
+void SerialWorker::handleMetrics(std::string_view) {
+    emit commandReceived(Command::GetMetrics, QVariantMap());
+}
+
+void SerialWorker::sendStatus() {
+    // Status will be filled by ApplicationController
+    emit commandReceived(Command::GetStatus, QVariantMap());
+}
+
+void SerialWorker::handleSerialStats(std::string_view) {
+    const SerialOutputQueue::Stats stats = m_output.stats();
+    sendResponse(QString(
+        "=== Serial Output ===\n"
+        "Policy: %1\n"
+        "Queued: %2 bytes (peak %3, capacity %4)\n"
+        "Messages: %5\n"
+        "Written: %6 bytes\n"
+        "Dropped: %7 replies, %8 telemetry\n"
+        "Evicted telemetry: %9\n"
+        "Replies over capacity: %10\n"
+        "Parked over capacity: %11 (input paused %12 times)\n"
+        "Binary frames: %13 ok, %14 rejected\n"
+        "=====================\n"
+    ).arg(SerialOutputQueue::policyName(m_output.policy()))
+     .arg(stats.queuedBytes)
+     .arg(stats.peakBytes)
+     .arg(stats.capacity)
+     .arg(stats.queuedMessages)
+     .arg(stats.writtenBytes)
+     .arg(stats.droppedReplies)
+     .arg(stats.droppedTelemetry)
+     .arg(stats.evictedTelemetry)
+     .arg(stats.repliesOverCapacity)
+     .arg(stats.parkedMessages)
+     .arg(stats.inputPauses)
+     .arg(m_binary_frames)
+     .arg(m_binary_frame_errors));
+}
 
-        params["balance"] = balance;
-        sendResponse(QString("OK: Balance set to %1\n").arg(balance));
-        emit commandReceived(Command::SetBalance, params);
+void SerialWorker::handleSubscribe(std::string_view args) {
+    if (args.empty()) {
+        sendResponse("ERROR: SUBSCRIBE requires event classes (SPIN, BALANCE, RISK, POWER, I2C or ALL, "
+                     "optionally CLASS:<min interval ms>)\n");
+        return;
+    }
 
-    } else if (cmd == "SET_PROB" || cmd == "PROBABILITIES") {
-        if (parts.size() < 2) {
-            sendResponse("ERROR: SET_PROB requires JSON (e.g., SET_PROB {\"coin\":10,\"kleeblatt\":15})\n");
+    // Parse everything first so a typo changes nothing
+    std::array<int, EVENT_CLASS_COUNT> requested;
+    requested.fill(-1);
+    while (!args.empty()) {
+        const std::string_view token = SerialCommandParser::nextToken(args);
+        const std::size_t colon = token.find(':');
+        const std::string_view name = token.substr(0, colon);
+
+        unsigned intervalMs = 0;
+        if (colon != std::string_view::npos &&
+            (!SerialCommandParser::parseUInt(token.substr(colon + 1), intervalMs) ||
+             intervalMs > MAX_EVENT_INTERVAL_MS)) {
+            sendResponse(QString("ERROR: Invalid rate limit in '%1'\n").arg(toQString(token)));
             return;
         }
 
-        // Reconstruct JSON from remaining parts
-        QString jsonStr = line.mid(cmd.length()).trimmed();
-        QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
+        if (SerialCommandParser::equalsIgnoreCase(name, "ALL")) {
+            requested.fill(static_cast<int>(intervalMs));
+            continue;
+        }
 
-        if (!doc.isObject()) {
-            sendResponse("ERROR: Invalid JSON format\n");
+        const EventClassEntry *entry = SerialCommandParser::find(EVENT_CLASSES, name);
+        if (!entry) {
+            sendResponse(QString("ERROR: Unknown event class '%1'\n").arg(toQString(name)));
             return;
         }
+        requested[static_cast<std::size_t>(entry->eventClass)] = static_cast<int>(intervalMs);
+    }
+
+    for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+        if (requested[i] >= 0) {
+            m_subscriptions[i].active = true;
+            m_subscriptions[i].minIntervalMs = requested[i];
+        }
+    }
+    storeSubscriptionMask();
 
-        const QJsonObject obj = doc.object();
-        QVariantMap probMap;
+    sendResponse("OK: Subscriptions: " + subscriptionSummary() + "\n");
+}
 
-        // Expected keys: coin, kleeblatt, marienkaefer, sonne, teufel
-        const QStringList validKeys = {"coin", "kleeblatt", "marienkaefer", "sonne", "teufel"};
-        for (const QString &key : validKeys) {
-            if (obj.contains(key)) {
-                probMap[key] = obj[key].toInt();
-            }
+void SerialWorker::handleUnsubscribe(std::string_view args) {
+    std::array<bool, EVENT_CLASS_COUNT> dropped{};
+    if (args.empty()) {
+        dropped.fill(true);
+    }
+
+    while (!args.empty()) {
+        const std::string_view name = SerialCommandParser::nextToken(args);
+        if (SerialCommandParser::equalsIgnoreCase(name, "ALL")) {
+            dropped.fill(true);
+            continue;
         }
 
-        if (probMap.isEmpty()) {
-            sendResponse("ERROR: No valid probabilities found\n");
+        const EventClassEntry *entry = SerialCommandParser::find(EVENT_CLASSES, name);
+        if (!entry) {
+            sendResponse(QString("ERROR: Unknown event class '%1'\n").arg(toQString(name)));
             return;
         }
+        dropped[static_cast<std::size_t>(entry->eventClass)] = true;
+    }
 
-        params["probabilities"] = probMap;
-        sendResponse("OK: Probabilities updated\n");
-        emit commandReceived(Command::SetProbabilities, params);
+    for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+        if (dropped[i]) {
+            m_subscriptions[i] = Subscription();
+        }
+    }
+    storeSubscriptionMask();
 
-    } else if (cmd == "STATUS" || cmd == "?") {
-        sendStatus();
+    sendResponse("OK: Subscriptions: " + subscriptionSummary() + "\n");
+}
 
-    } else {
-        sendResponse("ERROR: Unknown command. Available: POWER_ON, POWER_OFF, SET_BALANCE, SET_PROB, STATUS\n");
+void SerialWorker::publishEvent(const EventClass eventClass, const QString &fields) {
+    Subscription &subscription = m_subscriptions[static_cast<std::size_t>(eventClass)];
+    if (!subscription.active) {
+        return;
+    }
+
+    const qint64 now = Clock::instance().nowMs();
+    if (subscription.lastSentMs < 0 || now - subscription.lastSentMs >= subscription.minIntervalMs) {
+        subscription.hasPending = false;
+        subscription.pendingFields.clear();
+        subscription.lastSentMs = now;
+        sendEventRecord(eventClass, fields);
+        return;
+    }
+
+    // Inside the interval only the newest record survives; it goes out
+    // once the interval is up
+    subscription.pendingFields = fields;
+    subscription.hasPending = true;
+
+    const qint64 dueInMs = subscription.lastSentMs + subscription.minIntervalMs - now;
+    if (!m_event_timer->isActive() || m_event_timer->remainingTime() > dueInMs) {
+        m_event_timer->start(static_cast<int>(dueInMs));
     }
 }
 
-void SerialWorker::sendStatus() {
-    // Status will be filled by ApplicationController
-    emit commandReceived(Command::GetStatus, QVariantMap());
+void SerialWorker::flushPendingEvents() {
+    const qint64 now = Clock::instance().nowMs();
+    qint64 nextDueMs = std::numeric_limits<qint64>::max();
+
+    for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+        Subscription &subscription = m_subscriptions[i];
+        if (!subscription.hasPending) {
+            continue;
+        }
+
+        const qint64 dueInMs = subscription.lastSentMs + subscription.minIntervalMs - now;
+        if (dueInMs > 0) {
+            nextDueMs = std::min(nextDueMs, dueInMs);
+            continue;
+        }
+
+        subscription.hasPending = false;
+        subscription.lastSentMs = now;
+        sendEventRecord(static_cast<EventClass>(i), std::exchange(subscription.pendingFields, QString()));
+    }
+
+    if (nextDueMs != std::numeric_limits<qint64>::max()) {
+        m_event_timer->start(static_cast<int>(nextDueMs));
+    }
+}
+
+void SerialWorker::sendEventRecord(const EventClass eventClass, const QString &fields) {
+    ++m_event_sequence;
+
+    if (m_binary_mode) {
+        using namespace SerialBinaryProtocol;
+        const QByteArray text = fields.toUtf8();
+        std::array<uint8_t, MAX_PAYLOAD_SIZE> payload;
+        payload[0] = static_cast<uint8_t>(eventClass);
+        writeInt32(std::span(payload).subspan(1), static_cast<int32_t>(m_event_sequence));
+        const std::size_t textSize = std::min(static_cast<std::size_t>(text.size()), MAX_PAYLOAD_SIZE - 5);
+        std::memcpy(payload.data() + 5, text.constData(), textSize);
+        sendBinaryFrame(static_cast<uint8_t>(Type::Event), UNSOLICITED_ID, std::span(payload.data(), 5 + textSize),
+                        SerialOutputQueue::Kind::Telemetry);
+        return;
+    }
+
+    const std::string_view name = EVENT_CLASSES[static_cast<std::size_t>(eventClass)].name;
+    sendTelemetry(QString("EVT %1 %2 %3\n").arg(m_event_sequence).arg(toQString(name), fields));
+}
+
+void SerialWorker::clearSubscriptions() {
+    m_subscriptions.fill(Subscription());
+    storeSubscriptionMask();
+    m_event_timer->stop();
+    m_event_sequence = 0;
+}
+
+void SerialWorker::storeSubscriptionMask() {
+    uint32_t mask = 0;
+    for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+        if (m_subscriptions[i].active) {
+            mask |= 1u << i;
+        }
+    }
+    m_subscribed.store(mask, std::memory_order_relaxed);
+}
+
+QString SerialWorker::subscriptionSummary() const {
+    QStringList active;
+    for (std::size_t i = 0; i < EVENT_CLASS_COUNT; ++i) {
+        const Subscription &subscription = m_subscriptions[i];
+        if (!subscription.active) {
+            continue;
+        }
+
+        QString entry = toQString(EVENT_CLASSES[i].name);
+        if (subscription.minIntervalMs > 0) {
+            entry += ":" + QString::number(subscription.minIntervalMs);
+        }
+        active.append(entry);
+    }
+    return active.isEmpty() ? "none" : active.join(' ');
+}
+
+void SerialWorker::setOverflowPolicy(const SerialOutputQueue::OverflowPolicy policy) {
+    m_output.setPolicy(policy);
 }
 
 void SerialWorker::sendResponse(const QString &response) {
+    enqueue(response, SerialOutputQueue::Kind::Reply);
+}
+
+void SerialWorker::sendTelemetry(const QString &line) {
+    enqueue(line, SerialOutputQueue::Kind::Telemetry);
+}
+
+void SerialWorker::enqueue(const QString &text, const SerialOutputQueue::Kind kind) {
+    if (DebugLogger::instance().verbosity() == DebugLogger::LogVerbosity::Verbose) {
+        DebugLogger::instance().verbose("Serial TX: " + text.trimmed());
+    }
+    enqueueBytes(text.toUtf8(), kind);
+}
+
+void SerialWorker::enqueueBytes(QByteArray bytes, const SerialOutputQueue::Kind kind) {
 #ifdef Q_OS_LINUX
-    if (m_is_open && m_serial_port) {
-        m_serial_port->write(response.toUtf8());
-        m_serial_port->flush();
-        DebugLogger::instance().verbose("Serial TX: " + response.trimmed());
+    if (!m_is_open || !m_serial_port) {
+        return;
+    }
+
+    // Never wait for the port here: this runs inside command handlers, and
+    // waitForBytesWritten() can deliver readyRead re-entrantly. A Block
+    // queue that overflows pauses input instead, which holds the client
+    // back until the output has drained.
+    m_output.push(std::move(bytes), kind);
+    if (m_output.policy() == SerialOutputQueue::OverflowPolicy::Block && m_output.isOverCapacity() &&
+        !m_input_paused) {
+        m_input_paused = true;
+        m_output.noteInputPaused();
     }
+    pumpOutput();
 #else
-    Q_UNUSED(response);
-    // On macOS, just log it
-    // DebugLogger::instance().verbose("Serial TX (simulated): " + response.trimmed());
+    Q_UNUSED(bytes);
+    Q_UNUSED(kind);
+#endif
+}
+
+void SerialWorker::pumpOutput() {
+#ifdef Q_OS_LINUX
+    // Keep only a little in QSerialPort's own buffer; the rest waits in
+    // m_output where the overflow policy applies
+    while (!m_output.isEmpty() && m_serial_port->bytesToWrite() < PORT_HIGH_WATER) {
+        m_serial_port->write(m_output.take(PORT_HIGH_WATER - m_serial_port->bytesToWrite()));
+    }
 #endif
 }
@@ -4,6 +4,13 @@
 #include <QString>
 #include <QByteArray>
 #include <QVariantMap>
+#include <array>
+#include <atomic>
+#include <string_view>
+#include "Clock.h"
+#include "SerialBinaryProtocol.h"
+#include "SerialLineFramer.h"
+#include "SerialOutputQueue.h"
 
 #ifdef Q_OS_LINUX
 #include <QSerialPort>
@@ -23,8 +30,54 @@ public:
         PowerOff,
         SetBalance,
         SetProbabilities,
-        GetStatus
+        GetStatus,
+        GetI2CStats,
+        GetLatency,
+        GetMetrics,
+        Trace           // params["action"]: "on", "off", "dump" or "status"
     };
+    Q_ENUM(Command)
+
+    // What a client can SUBSCRIBE to
+    enum class EventClass : uint8_t {
+        Spin,      // Spin results
+        Balance,   // Balance changes
+        Risk,      // Risk ladder won/lost/collected
+        Power,     // Power on/off
+        I2CHealth  // Bus link state
+    };
+    static constexpr std::size_t EVENT_CLASS_COUNT = 5;
+
+    // Game state for a STATUS request, gathered on the GUI thread
+    struct StatusReport {
+        bool poweredOn = false;
+        double balance = 0.0;
+        double bet = 0.0;
+        double currentPrize = 0.0;
+        bool sessionActive = false;
+        bool riskModeActive = false;
+        int riskLevel = 0;
+        double riskPrize = 0.0;
+    };
+
+    // Call before the worker moves to its thread
+    void setOverflowPolicy(SerialOutputQueue::OverflowPolicy policy);
+
+    // Safe from any thread. Publishers check this before formatting an
+    // event so an unmonitored machine does no work for it.
+    [[nodiscard]] bool isSubscribed(EventClass eventClass) const {
+        return m_subscribed.load(std::memory_order_relaxed) & (1u << static_cast<unsigned>(eventClass));
+    }
+
+    // Pushes "EVT <seq> <CLASS> <fields>" to the client if it subscribed to
+    // eventClass, subject to its rate limit. Call on the serial thread
+    // (queue it from elsewhere).
+    void publishEvent(EventClass eventClass, const QString &fields);
+
+    // Answers a GetStatus request. requestId is the "requestId" parameter
+    // of a binary request, or -1 for the text STATUS command. Call on the
+    // serial thread.
+    void sendStatusReport(int requestId, const StatusReport &report);
 
 public slots:
     void initialize();
@@ -33,6 +86,8 @@ public slots:
     void closePort();
     void sendStatus();
     void sendResponse(const QString &response);
+    // Unsolicited output; the first thing dropped when the link falls behind
+    void sendTelemetry(const QString &line);
 
 signals:
     void portOpened(bool success, const QString &message);
@@ -44,17 +99,77 @@ private slots:
 #ifdef Q_OS_LINUX
     void handleReadyRead();
     void handleError(QSerialPort::SerialPortError error);
+    void handleBytesWritten(qint64 bytes);
 #endif
 
 private:
-    void processCommand(const QString &line);
+    // One row of the static command table; alias may be empty
+    struct CommandEntry {
+        std::string_view name;
+        std::string_view alias;
+        void (SerialWorker::*handler)(std::string_view args);
+    };
+
+    void processLine(std::string_view line);
+    void consumeInput(std::span<const char> bytes);
+    void enterBinaryMode();
+    bool handleBinaryFrame(const SerialBinaryProtocol::Frame &frame);
+    void handleBinaryFrameError();
+    void sendBinaryReply(const SerialBinaryProtocol::Frame &request, SerialBinaryProtocol::Status status,
+                         std::span<const uint8_t> payload = {});
+    void sendBinaryFrame(uint8_t type, uint16_t requestId, std::span<const uint8_t> payload,
+                         SerialOutputQueue::Kind kind);
+    void handlePowerOn(std::string_view args);
+    void handlePowerOff(std::string_view args);
+    void handleSetBalance(std::string_view args);
+    void handleSetProbabilities(std::string_view args);
+    void handleStatus(std::string_view args);
+    void handleI2CStats(std::string_view args);
+    void handleLatency(std::string_view args);
+    void handleMetrics(std::string_view args);
+    void handleSerialStats(std::string_view args);
+    void handleSubscribe(std::string_view args);
+    void handleUnsubscribe(std::string_view args);
+    void handleTrace(std::string_view args);
+    void sendEventRecord(EventClass eventClass, const QString &fields);
+    void flushPendingEvents();
+    void clearSubscriptions();
+    void storeSubscriptionMask();
+    QString subscriptionSummary() const;
+    void enqueue(const QString &text, SerialOutputQueue::Kind kind);
+    void enqueueBytes(QByteArray bytes, SerialOutputQueue::Kind kind);
+    void pumpOutput();
     QString findSerialPort();
 
+    static const std::array<CommandEntry, 12> COMMANDS;
+
 #ifdef Q_OS_LINUX
     QSerialPort *m_serial_port = nullptr;
 #endif
-    QByteArray m_read_buffer;
+    SerialLineFramer m_framer;
+    bool m_binary_mode = false;
+    bool m_reading = false;       // Inside handleReadyRead()
+    bool m_input_paused = false;  // Block policy: output over capacity
+    SerialBinaryProtocol::FrameDecoder m_frame_decoder;
+    uint64_t m_binary_frames = 0;
+    uint64_t m_binary_frame_errors = 0;
+    SerialOutputQueue m_output;
+
+    // Per event class; only touched on the serial thread
+    struct Subscription {
+        bool active = false;
+        int minIntervalMs = 0;       // 0 = no rate limit
+        qint64 lastSentMs = -1;
+        bool hasPending = false;     // Coalesced record waiting for the interval
+        QString pendingFields;
+    };
+    std::array<Subscription, EVENT_CLASS_COUNT> m_subscriptions;
+    std::atomic<uint32_t> m_subscribed{0};
+    uint64_t m_event_sequence = 0;
+    ClockTimer *m_event_timer = nullptr;
     bool m_is_open = false;
 
     static constexpr int BAUD_RATE = 115200;
+    // Bytes handed to QSerialPort ahead of the wire; ~45 ms at BAUD_RATE
+    static constexpr qint64 PORT_HIGH_WATER = 512;
 };
@@ -0,0 +1,388 @@
+#include "SimulatedArduino.h"
+#include "Clock.h"
+#include "I2CWorker.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cstring>
+
+SimulatedArduino::Config SimulatedArduino::Config::fromString(const QString &spec, QString &error) {
+    Config config;
+
+    for (const QString &option: spec.split(',', Qt::SkipEmptyParts)) {
+        const QString key = option.section('=', 0, 0).trimmed().toLower();
+        const QString value = option.section('=', 1).trimmed();
+        bool ok = true;
+
+        if (key == "latency") {
+            config.latencyMs = value.toInt(&ok);
+        } else if (key == "jitter") {
+            config.jitterMs = value.toInt(&ok);
+        } else if (key == "corrupt") {
+            config.corruptRate = value.toDouble(&ok);
+        } else if (key == "drop") {
+            config.dropRate = value.toDouble(&ok);
+        } else if (key == "seed") {
+            config.seed = value.toUInt(&ok);
+        } else if (key == "script") {
+            QFile file(value);
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                error = QString("Cannot open button script %1").arg(value);
+                return config;
+            }
+
+            QTextStream in(&file);
+            while (!in.atEnd()) {
+                const QStringList parts = in.readLine().simplified().split(' ');
+                if (parts.size() != 2 || parts[0].startsWith('#')) continue;
+                config.script.append(ScriptedPress{parts[0].toInt(), static_cast<uint8_t>(parts[1].toUInt())});
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            error = QString("Invalid simulator option '%1'").arg(option);
+            return config;
+        }
+    }
+
+    return config;
+}
+
+SimulatedArduino::SimulatedArduino(Config config)
+    : m_config(std::move(config))
+      , m_data_ready(std::make_shared<FakeDataReadySource>())
+      , m_rng(m_config.seed ? m_config.seed : std::random_device{}()) {
+    std::sort(m_config.script.begin(), m_config.script.end(),
+              [](const ScriptedPress &a, const ScriptedPress &b) { return a.atMs < b.atMs; });
+}
+
+SimulatedArduino::~SimulatedArduino() {
+    close();
+}
+
+bool SimulatedArduino::open(const uint8_t address, QString &error) {
+    Q_UNUSED(error);
+    close();
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_open = true;
+        m_address = address;
+        m_primary_address = address;
+        for (auto &[boardAddress, board]: m_boards) {
+            board.replyPending = false;
+        }
+        m_script_stop = false;
+    }
+
+    if (!m_config.script.isEmpty()) {
+        m_script_thread = std::thread(&SimulatedArduino::runScript, this);
+    }
+
+    return true;
+}
+
+void SimulatedArduino::close() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_open = false;
+        m_script_stop = true;
+    }
+    m_script_cv.notify_all();
+
+    if (m_script_thread.joinable()) {
+        m_script_thread.join();
+    }
+}
+
+bool SimulatedArduino::isOpen() const {
+    std::lock_guard lock(m_mutex);
+    return m_open;
+}
+
+bool SimulatedArduino::selectAddress(const uint8_t address, QString &error) {
+    Q_UNUSED(error);
+    std::lock_guard lock(m_mutex);
+    m_address = address;
+    return true;
+}
+
+QString SimulatedArduino::description() const {
+    return QString("simulated Arduino (latency %1 ms, jitter %2 ms, corrupt %3, drop %4)")
+            .arg(m_config.latencyMs)
+            .arg(m_config.jitterMs)
+            .arg(m_config.corruptRate)
+            .arg(m_config.dropRate);
+}
+
+ssize_t SimulatedArduino::write(const std::span<const uint8_t> bytes) {
+    std::lock_guard lock(m_mutex);
+    if (!m_open || !m_powered) {
+        return -1;
+    }
+
+    Board &current = board(m_address);
+    m_frames_received++;
+    current.replyPending = false;
+
+    // Like the firmware, ignore anything that is not a well-formed frame
+    if (bytes.size() < I2CPacket::HEADER_SIZE + I2CPacket::CHECKSUM_SIZE) {
+        return static_cast<ssize_t>(bytes.size());
+    }
+
+    const I2CPacket::ResponseView frame(bytes);
+    if (!frame.checksumValid() ||
+        frame.length() != bytes.size() - I2CPacket::HEADER_SIZE - I2CPacket::CHECKSUM_SIZE) {
+        return static_cast<ssize_t>(bytes.size());
+    }
+
+    handleRequest(current, frame.command(), frame.payload());
+    return static_cast<ssize_t>(bytes.size());
+}
+
+ssize_t SimulatedArduino::read(const std::span<uint8_t> buffer) {
+    std::lock_guard lock(m_mutex);
+    if (!m_open) {
+        return -1;
+    }
+
+    Board &current = board(m_address);
+    if (!current.replyPending || Clock::instance().nowNs() < current.replyReadyAtNs) {
+        return 0;
+    }
+
+    current.replyPending = false;
+    const std::size_t size = std::min(buffer.size(), current.replySize);
+    std::memcpy(buffer.data(), current.reply.data(), size);
+    return static_cast<ssize_t>(size);
+}
+
+void SimulatedArduino::flush() {
+    std::lock_guard lock(m_mutex);
+    board(m_address).replyPending = false;
+}
+
+SimulatedArduino::Board &SimulatedArduino::board(const uint8_t address) {
+    return m_boards[address ? address : m_primary_address];
+}
+
+const SimulatedArduino::Board *SimulatedArduino::findBoard(const uint8_t address) const {
+    const auto it = m_boards.find(address ? address : m_primary_address);
+    return it != m_boards.end() ? &it->second : nullptr;
+}
+
+void SimulatedArduino::handleRequest(Board &board, const uint8_t command,
+                                     const std::span<const uint8_t> payload) {
+    uint8_t status = 0x00;
+
+    switch (command) {
+        case I2CWorker::CMD_INIT:
+            resetState(board);
+            m_init_count++;
+            break;
+
+        case I2CWorker::CMD_HEALTHCHECK:
+            break;
+
+        case I2CWorker::CMD_POLL_BUTTON_EVENTS: {
+            std::array<uint8_t, 1 + MAX_EVENTS_PER_POLL> reply{};
+            uint8_t count = 0;
+            while (!board.events.empty() && count < MAX_EVENTS_PER_POLL) {
+                reply[1 + count++] = board.events.front();
+                board.events.pop_front();
+            }
+            reply[0] = count;
+            queueReply(board, command, std::span(reply.data(), 1 + count));
+            return;
+        }
+
+        case I2CWorker::CMD_HIGHLIGHT_BUTTON:
+            if (payload.size() == 2 && payload[0] < MAX_BUTTONS) {
+                board.buttons[payload[0]] = payload[1] != 0;
+            } else {
+                status = 0x01;
+            }
+            break;
+
+        case I2CWorker::CMD_HIGHLIGHT_TOWER:
+            if (payload.size() == 2 && payload[0] < MAX_TOWERS) {
+                board.towers[payload[0]] = payload[1];
+            } else {
+                status = 0x01;
+            }
+            break;
+
+        case I2CWorker::CMD_UPDATE_USER_NAME:
+            board.userName = QString::fromUtf8(reinterpret_cast<const char *>(payload.data()),
+                                               static_cast<qsizetype>(payload.size()));
+            break;
+
+        case I2CWorker::CMD_UPDATE_USER_BALANCE:
+            if (payload.size() == 4) {
+                board.balanceCents = static_cast<int32_t>(
+                    static_cast<uint32_t>(payload[0]) |
+                    static_cast<uint32_t>(payload[1]) << 8 |
+                    static_cast<uint32_t>(payload[2]) << 16 |
+                    static_cast<uint32_t>(payload[3]) << 24);
+            } else {
+                status = 0x01;
+            }
+            break;
+
+        case I2CWorker::CMD_UPLOAD_ANIMATION: {
+            uint8_t slot = 0;
+            LedAnimation animation;
+            if (LedAnimation::decode(payload, slot, animation)) {
+                board.animations[slot] = animation;
+            } else {
+                status = 0x01;
+            }
+            break;
+        }
+
+        case I2CWorker::CMD_PLAY_ANIMATION:
+            if (payload.size() == 1 && payload[0] < LedAnimation::MAX_SLOTS &&
+                board.animations[payload[0]].valid()) {
+                board.playingAnimation = payload[0];
+            } else {
+                status = 0x01;
+            }
+            break;
+
+        case I2CWorker::CMD_STOP_ANIMATION:
+            board.playingAnimation = -1;
+            break;
+
+        default:
+            status = 0xFF; // Unknown command
+            break;
+    }
+
+    queueReply(board, command, std::span(&status, 1));
+}
+
+void SimulatedArduino::queueReply(Board &board, const uint8_t command,
+                                  const std::span<const uint8_t> payload) {
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    if (chance(m_rng) < m_config.dropRate) {
+        return;
+    }
+
+    const I2CPacket::TxPacket reply(command | 0x80, payload);
+    std::memcpy(board.reply.data(), reply.bytes().data(), reply.size());
+    board.replySize = reply.size();
+
+    if (chance(m_rng) < m_config.corruptRate) {
+        board.reply[board.replySize - 1] ^= 0x5A;
+    }
+
+    int delayMs = m_config.latencyMs;
+    if (m_config.jitterMs > 0) {
+        delayMs += std::uniform_int_distribution<int>(0, m_config.jitterMs)(m_rng);
+    }
+
+    board.replyPending = true;
+    board.replyReadyAtNs = Clock::instance().nowNs() + static_cast<int64_t>(delayMs) * 1'000'000;
+}
+
+void SimulatedArduino::resetState(Board &board) {
+    board.buttons.fill(false);
+    board.towers.fill(0);
+    board.balanceCents = 0;
+    board.userName.clear();
+    board.events.clear();
+    board.animations.fill({});
+    board.playingAnimation = -1;
+}
+
+void SimulatedArduino::pressButton(const uint8_t buttonId, const uint8_t address) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_powered) {
+            return;
+        }
+        board(address).events.push_back(buttonId);
+    }
+    m_data_ready->trigger();
+}
+
+void SimulatedArduino::setPowered(const bool powered) {
+    std::lock_guard lock(m_mutex);
+    if (m_powered && !powered) {
+        for (auto &[boardAddress, board]: m_boards) {
+            resetState(board);
+            board.replyPending = false;
+        }
+    }
+    m_powered = powered;
+}
+
+bool SimulatedArduino::isPowered() const {
+    std::lock_guard lock(m_mutex);
+    return m_powered;
+}
+
+void SimulatedArduino::runScript() {
+    const auto start = SteadyClock::now();
+
+    for (const ScriptedPress &press: m_config.script) {
+        std::unique_lock lock(m_mutex);
+        if (m_script_cv.wait_until(lock, start + std::chrono::milliseconds(press.atMs),
+                                   [this] { return m_script_stop; })) {
+            return;
+        }
+        board(0).events.push_back(press.buttonId);
+        lock.unlock();
+
+        m_data_ready->trigger();
+    }
+}
+
+bool SimulatedArduino::buttonState(const uint8_t buttonId, const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b && buttonId < MAX_BUTTONS && b->buttons[buttonId];
+}
+
+uint8_t SimulatedArduino::towerRow(const uint8_t towerId, const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b && towerId < MAX_TOWERS ? b->towers[towerId] : 0;
+}
+
+int32_t SimulatedArduino::balanceCents(const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b ? b->balanceCents : 0;
+}
+
+QString SimulatedArduino::userName(const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b ? b->userName : QString();
+}
+
+int SimulatedArduino::playingAnimation(const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b ? b->playingAnimation : -1;
+}
+
+LedAnimation SimulatedArduino::animation(const uint8_t slot, const uint8_t address) const {
+    std::lock_guard lock(m_mutex);
+    const Board *b = findBoard(address);
+    return b && slot < LedAnimation::MAX_SLOTS ? b->animations[slot] : LedAnimation{};
+}
+
+uint64_t SimulatedArduino::framesReceived() const {
+    std::lock_guard lock(m_mutex);
+    return m_frames_received;
+}
+
+uint64_t SimulatedArduino::initCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_init_count;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "DataReadySource.h"
+#include "I2CPacket.h"
+#include "I2CTransport.h"
+#include "LedAnimation.h"
+
+// In-process stand-in for the cabinet Arduino. Implements CMD_INIT through
+// CMD_STOP_ANIMATION on top of the I2CTransport interface, with
+// configurable timing and fault injection, so the whole stack can run on a
+// dev box or CI runner. Every slave address answers as its own board, so
+// multi-board device maps work unchanged.
+//
+// The worker thread drives write()/read(); pressButton() and the state
+// getters may be called from any thread.
+class SimulatedArduino final : public I2CTransport {
+public:
+    struct ScriptedPress {
+        int atMs;          // Offset from open()
+        uint8_t buttonId;
+    };
+
+    struct Config {
+        int latencyMs = 20;             // Nominal time until a reply is readable
+        int jitterMs = 0;               // Extra 0..jitterMs per reply
+        double corruptRate = 0.0;       // Probability of a bad reply checksum
+        double dropRate = 0.0;          // Probability of no reply at all
+        uint32_t seed = 0;              // 0 = random
+        QVector<ScriptedPress> script;  // Button presses replayed after open(), in real time
+
+        // "latency=20,jitter=5,corrupt=0.01,drop=0.01,seed=1,script=<file>".
+        // The script file holds one "<ms> <buttonId>" pair per line.
+        static Config fromString(const QString &spec, QString &error);
+    };
+
+    explicit SimulatedArduino(Config config = Config());
+
+    ~SimulatedArduino() override;
+
+    // I2CTransport
+    bool open(uint8_t address, QString &error) override;
+
+    void close() override;
+
+    [[nodiscard]] bool isOpen() const override;
+
+    bool selectAddress(uint8_t address, QString &error) override;
+
+    ssize_t write(std::span<const uint8_t> bytes) override;
+
+    ssize_t read(std::span<uint8_t> buffer) override;
+
+    void flush() override;
+
+    [[nodiscard]] int responseDelayMs() const override { return m_config.latencyMs; }
+
+    [[nodiscard]] QString errorString() const override { return "simulated transport error"; }
+
+    [[nodiscard]] QString description() const override;
+
+    // Data-ready line that fires whenever a button event is queued
+    [[nodiscard]] std::shared_ptr<DataReadySource> dataReadySource() const { return m_data_ready; }
+
+    // Simulated player input. address 0 means the board passed to open().
+    // Ignored while the boards are powered off.
+    void pressButton(uint8_t buttonId, uint8_t address = 0);
+
+    // Power cut: every board stops acknowledging writes and comes back
+    // blank, as after a reset, until it gets CMD_INIT again
+    void setPowered(bool powered);
+
+    [[nodiscard]] bool isPowered() const;
+
+    // Observed device state, per board
+    [[nodiscard]] bool buttonState(uint8_t buttonId, uint8_t address = 0) const;
+
+    [[nodiscard]] uint8_t towerRow(uint8_t towerId, uint8_t address = 0) const;
+
+    [[nodiscard]] int32_t balanceCents(uint8_t address = 0) const;
+
+    [[nodiscard]] QString userName(uint8_t address = 0) const;
+
+    // Slot of the last animation started and not stopped, or -1. Programs
+    // are treated as running until CMD_STOP_ANIMATION or CMD_INIT.
+    [[nodiscard]] int playingAnimation(uint8_t address = 0) const;
+
+    [[nodiscard]] LedAnimation animation(uint8_t slot, uint8_t address = 0) const;
+
+    [[nodiscard]] uint64_t framesReceived() const;
+
+    // Across all boards
+    [[nodiscard]] uint64_t initCount() const;
+
+private:
+    using SteadyClock = std::chrono::steady_clock; // Script timing only
+
+    static constexpr int MAX_BUTTONS = 8;
+    static constexpr int MAX_TOWERS = 8;
+    static constexpr int MAX_EVENTS_PER_POLL = 16;
+
+    // Every address answers; a board is created on first use so multi-board
+    // cabinets work without extra configuration
+    struct Board {
+        std::array<bool, MAX_BUTTONS> buttons{};
+        std::array<uint8_t, MAX_TOWERS> towers{};
+        int32_t balanceCents = 0;
+        QString userName;
+        std::deque<uint8_t> events;
+        std::array<LedAnimation, LedAnimation::MAX_SLOTS> animations{};
+        int playingAnimation = -1;
+
+        std::array<uint8_t, I2CPacket::MAX_PACKET_SIZE> reply{};
+        std::size_t replySize = 0;
+        bool replyPending = false;
+        int64_t replyReadyAtNs = 0; // On Clock, so replies keep pace with virtual time
+    };
+
+    // Both require m_mutex
+    Board &board(uint8_t address);
+
+    [[nodiscard]] const Board *findBoard(uint8_t address) const;
+
+    void handleRequest(Board &board, uint8_t command, std::span<const uint8_t> payload);
+
+    void queueReply(Board &board, uint8_t command, std::span<const uint8_t> payload);
+
+    static void resetState(Board &board);
+
+    void runScript();
+
+    Config m_config;
+    std::shared_ptr<FakeDataReadySource> m_data_ready;
+
+    mutable std::mutex m_mutex;
+    std::mt19937 m_rng;
+    bool m_open = false;
+    bool m_powered = true;
+    uint8_t m_address = 0;          // Currently selected
+    uint8_t m_primary_address = 0;  // Passed to open()
+    std::map<uint8_t, Board> m_boards;
+
+    uint64_t m_frames_received = 0;
+    uint64_t m_init_count = 0;
+
+    std::thread m_script_thread;
+    std::condition_variable m_script_cv;
+    bool m_script_stop = false;
+};
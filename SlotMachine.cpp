@@ -1,6 +1,9 @@
 #include "SlotMachine.h"
 #include "I2CWorker.h"
 #include "DebugLogger.h"
+#include "FlightRecorder.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
 #include <QPointer>
 #include <QStandardPaths>
 #include <QDir>
@@ -8,6 +11,7 @@
 #include <QTextStream>
 #include <cmath>
 #include <chrono>
+#include <utility>
 
 SlotMachine::SlotMachine(QObject *parent) : QObject(parent) {
     // Initialize random number generator
@@ -15,9 +19,9 @@ SlotMachine::SlotMachine(QObject *parent) : QObject(parent) {
     m_rng.seed(static_cast<unsigned int>(seed));
 
     // Initialize risk animation timer
-    m_risk_animation_timer = new QTimer(this);
+    m_risk_animation_timer = new ClockTimer(this);
     m_risk_animation_timer->setInterval(80); // Fast animation
-    connect(m_risk_animation_timer, &QTimer::timeout, this, &SlotMachine::onRiskAnimationStep);
+    connect(m_risk_animation_timer, &ClockTimer::timeout, this, &SlotMachine::onRiskAnimationStep);
 
     // Create 3 towers with Qt parent ownership
     // Order: Coin (0), Kleeblatt (1), Marienkaefer (2)
@@ -39,6 +43,9 @@ SlotMachine::SlotMachine(QObject *parent) : QObject(parent) {
                 }
             }
             if (allFull) {
+                static MetricsRegistry::Counter &jackpots = MetricsRegistry::instance().counter(
+                    "allesspitze_jackpots_total", "Jackpots won (all towers full)");
+                jackpots.increment();
                 DebugLogger::instance().info("🎰 JACKPOT! All towers full!");
                 emit jackpotWon();
                 cashout(); // Auto-cashout on jackpot
@@ -48,6 +55,8 @@ SlotMachine::SlotMachine(QObject *parent) : QObject(parent) {
 }
 
 QVariantList SlotMachine::towers() const {
+    // Re-read by QML on every towersChanged, rebuilding the tower delegates
+    Trace::Span span("qml", "towers");
     QVariantList list;
     for (const auto *tower: m_towers) {
         QVariantMap towerData;
@@ -60,29 +69,62 @@ QVariantList SlotMachine::towers() const {
     return list;
 }
 
-void SlotMachine::setReel(SlotReel *reel) {
-    if (m_reel == reel) return;
+template<typename Reel>
+void SlotMachine::attachReel(Reel *reel) {
+    if (m_reel_object == reel) return;
 
-    if (m_reel) {
-        disconnect(m_reel, nullptr, this, nullptr);
+    if (m_reel_object) {
+        disconnect(m_reel_object, nullptr, this, nullptr);
     }
 
     m_reel = reel;
+    m_reel_object = reel;
 
-    if (m_reel) {
-        connect(m_reel, &SlotReel::spinning_changed,
+    if (reel) {
+        connect(reel, &Reel::spinning_changed,
                 this, &SlotMachine::onSpinFinished);
     }
 }
 
+void SlotMachine::setReel(SlotReel *reel) {
+    attachReel(reel);
+}
+
+void SlotMachine::setReel(HeadlessReel *reel) {
+    attachReel(reel);
+}
+
+void SlotMachine::setProbabilities(const QVariantMap &probabilities) {
+    if (!reel()) {
+        DebugLogger::instance().warning("Cannot set probabilities - no reel");
+        return;
+    }
+
+    reel()->set_probabilities(probabilities);
+    DebugLogger::instance().info("Probabilities updated on reel");
+}
+
 void SlotMachine::spin() {
-    if (!canSpin() || !m_reel) {
+    if (!canSpin() || !reel()) {
         DebugLogger::instance().warning("Cannot spin - insufficient balance or no reel");
         return;
     }
 
+    Trace::Span span("game", "spin");
+    static MetricsRegistry::Counter &spins = MetricsRegistry::instance().counter(
+        "allesspitze_spins_total", "Spins started");
+    spins.increment();
+    m_spin_flow = Trace::currentFlow();
+    if (m_spin_flow == 0) {
+        // Started from the touch screen or the serial port
+        m_spin_flow = Trace::newFlow();
+        Trace::flowStart(m_spin_flow);
+    }
+    Trace::asyncBegin("game", "reelSpin", ++m_spin_count);
+
     // Deduct bet amount for the spin
     m_balance -= m_bet;
+    FlightRecorder::instance().recordMoney(FlightRecorder::MoneyKind::Bet, m_bet, m_balance);
     saveBalance();
     emit balanceChanged();
 
@@ -90,16 +132,22 @@ void SlotMachine::spin() {
     emit canSpinChanged();
 
     DebugLogger::instance().info(QString("Starting slot machine spin... (Bet: %1, Balance: %2)").arg(m_bet).arg(m_balance));
-    m_reel->spin();
+    reel()->spin();
 }
 
 void SlotMachine::onSpinFinished() {
-    if (!m_reel || m_reel->spinning()) {
+    if (!reel() || reel()->spinning()) {
         return;
     }
 
-    const auto symbolType = m_reel->currentSymbolType();
-    const bool isMiss = m_reel->isMiss();
+    Trace::asyncEnd("game", "reelSpin", m_spin_count);
+    Trace::FlowScope flow(std::exchange(m_spin_flow, 0));
+    Trace::Span span("game", "onSpinFinished");
+
+    const auto symbolType = reel()->currentSymbolType();
+    const bool isMiss = reel()->isMiss();
+    FlightRecorder::instance().record(FlightRecorder::Type::SpinResult, static_cast<uint8_t>(symbolType), 0, 0,
+                                      isMiss ? QString("miss") : Symbol::typeToString(symbolType));
 
     processResult(symbolType, isMiss);
 
@@ -151,14 +199,13 @@ void SlotMachine::processResult(Symbol::Type symbolType, bool isMiss) {
 void SlotMachine::updatePhysicalTower(int towerId) {
     if (!m_i2c_worker) return;
 
+    Trace::Span span("game", "updatePhysicalTower");
+    span.setArg("tower", towerId);
+
     int level = m_towers[towerId]->level();
 
-    QMetaObject::invokeMethod(
-        m_i2c_worker,
-        "highlightTower",
-        Q_ARG(uint8_t, static_cast<uint8_t>(towerId)),
-        Q_ARG(uint8_t, static_cast<uint8_t>(level))
-    );
+    m_i2c_worker->post(I2CCommand::highlightTower(static_cast<uint8_t>(towerId),
+                                                  static_cast<uint8_t>(level)));
 }
 
 void SlotMachine::resetAllTowers() {
@@ -175,6 +222,7 @@ void SlotMachine::addBalance(double amount) {
     if (amount <= 0) return;
 
     m_balance += amount;
+    FlightRecorder::instance().recordMoney(FlightRecorder::MoneyKind::Deposit, amount, m_balance);
     saveBalance();
     emit balanceChanged();
     emit canSpinChanged();
@@ -185,6 +233,7 @@ void SlotMachine::setBalance(double balance) {
     if (qFuzzyCompare(m_balance, balance)) return;
 
     m_balance = balance;
+    FlightRecorder::instance().recordMoney(FlightRecorder::MoneyKind::SetBalance, balance, m_balance);
     emit balanceChanged();
     emit canSpinChanged();
     DebugLogger::instance().info(QString("Balance set to: %1 units").arg(m_balance));
@@ -315,6 +364,7 @@ void SlotMachine::cashout() {
 
     // Add prize to balance
     m_balance += prize;
+    FlightRecorder::instance().recordMoney(FlightRecorder::MoneyKind::Cashout, prize, m_balance);
     saveBalance();
     emit balanceChanged();
 
@@ -337,14 +387,22 @@ QString SlotMachine::balanceFilePath() {
 }
 
 void SlotMachine::saveBalance() {
+    Trace::Span span("persistence", "saveBalance");
+    static MetricsRegistry::Histogram &saveSeconds = MetricsRegistry::instance().histogram(
+        "allesspitze_balance_save_seconds", "Time to write the balance file");
+    static MetricsRegistry::Counter &saveFailures = MetricsRegistry::instance().counter(
+        "allesspitze_balance_save_failures_total", "Balance file writes that failed");
+    const auto started = std::chrono::steady_clock::now();
     QFile file(balanceFilePath());
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QTextStream out(&file);
         out << QString::number(m_balance, 'f', 2);
         file.close();
     } else {
+        saveFailures.increment();
         DebugLogger::instance().error("Could not save balance to file");
     }
+    saveSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
 }
 
 // ===== RISK LADDER FUNCTIONS =====
@@ -473,6 +531,7 @@ void SlotMachine::finishRiskAttempt(bool won) {
         m_risk_level++;
         m_risk_prize = m_risk_base_prize * RISK_MULTIPLIERS[m_risk_level];
         m_risk_animation_position = m_risk_level;
+        FlightRecorder::instance().recordRisk(FlightRecorder::RiskOutcome::Won, m_risk_level, m_risk_prize);
 
         DebugLogger::instance().info(QString("🎉 Risk won! New level: %1, Prize: %2").arg(m_risk_level).arg(m_risk_prize));
 
@@ -495,6 +554,7 @@ void SlotMachine::finishRiskAttempt(bool won) {
             m_risk_level = RISK_CHECKPOINT_LEVEL;
             m_risk_prize = m_risk_base_prize * RISK_MULTIPLIERS[m_risk_level];
             m_risk_animation_position = m_risk_level;
+            FlightRecorder::instance().recordRisk(FlightRecorder::RiskOutcome::FellBack, m_risk_level, m_risk_prize);
 
             emit riskLevelChanged();
             emit riskPrizeChanged();
@@ -512,6 +572,7 @@ void SlotMachine::finishRiskAttempt(bool won) {
             m_risk_level = 0;
             m_risk_base_prize = 0;
             m_risk_mode_active = false;
+            FlightRecorder::instance().recordRisk(FlightRecorder::RiskOutcome::Lost, 0, 0.0);
 
             emit riskPrizeChanged();
             emit riskLevelChanged();
@@ -534,6 +595,7 @@ void SlotMachine::collectRiskPrize() {
 
     // Add to balance
     m_balance += prize;
+    FlightRecorder::instance().recordMoney(FlightRecorder::MoneyKind::RiskCollect, prize, m_balance);
     saveBalance();
     emit balanceChanged();
 
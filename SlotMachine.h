@@ -4,8 +4,10 @@
 #include <QVector>
 #include <QPointer>
 #include <QVariantList>
-#include <QTimer>
 #include <random>
+#include "Clock.h"
+#include "HeadlessReel.h"
+#include "ReelBackend.h"
 #include "Tower.h"
 #include "SlotReel.h"
 #include "Symbol.h"
@@ -44,7 +46,7 @@ public:
     [[nodiscard]] QVariantList towerPrizes() const;
     [[nodiscard]] bool sessionActive() const { return m_session_active; }
     [[nodiscard]] bool canChangeBet() const { return !m_session_active && !m_risk_mode_active; }
-    [[nodiscard]] bool isSpinning() const { return m_reel && m_reel->spinning(); }
+    [[nodiscard]] bool isSpinning() const { return reel() && reel()->spinning(); }
 
     // Risk ladder getters
     [[nodiscard]] bool riskModeActive() const { return m_risk_mode_active; }
@@ -57,6 +59,9 @@ public:
     Q_INVOKABLE void spin();
     Q_INVOKABLE void resetAllTowers();
     Q_INVOKABLE void setReel(SlotReel *reel);
+    void setReel(HeadlessReel *reel);
+    // Symbol weights by SET_PROB key, for whichever reel is attached
+    void setProbabilities(const QVariantMap &probabilities);
     Q_INVOKABLE void addBalance(double amount);
     Q_INVOKABLE void setBet(double bet);
     Q_INVOKABLE void increaseBet();
@@ -111,6 +116,12 @@ private:
     void updateSessionState();
     void finishRiskAttempt(bool won);
 
+    // Both reels are QObjects with a spinning_changed() signal
+    template<typename Reel>
+    void attachReel(Reel *reel);
+
+    [[nodiscard]] ReelBackend *reel() const { return m_reel_object ? m_reel : nullptr; }
+
     // Prize multiplier tables [tower][level] - level 0 means no prize
     inline static constexpr double MARIENKAEFER_MULTIPLIERS[6] = {0, 1, 2, 4, 7, 10};
     inline static constexpr double KLEEBLATT_MULTIPLIERS[6] = {0, 3, 8, 16, 29, 50};
@@ -122,7 +133,8 @@ private:
     inline static constexpr double RISK_MULTIPLIERS[RISK_LADDER_STEPS] = {1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0};
 
     QVector<Tower*> m_towers;
-    QPointer<SlotReel> m_reel;
+    ReelBackend *m_reel = nullptr;
+    QPointer<QObject> m_reel_object; // Same object; tracks its lifetime
     QPointer<I2CWorker> m_i2c_worker;
     bool m_can_spin = true;
     bool m_session_active = false;
@@ -138,9 +150,14 @@ private:
     bool m_risk_animating = false;
     int m_risk_animation_position = 0;
     int m_risk_target_position = 0;
-    QTimer *m_risk_animation_timer = nullptr;
+    ClockTimer *m_risk_animation_timer = nullptr;
     std::mt19937 m_rng;
 
+    // Trace flow of the press that started the running spin, so the tower
+    // updates at its end join the same chain
+    uint32_t m_spin_flow = 0;
+    uint32_t m_spin_count = 0;
+
     inline static constexpr double MIN_BET = 0.10;
     inline static constexpr double MAX_BET = 100.0;
     inline static constexpr double BET_STEP = 0.10;
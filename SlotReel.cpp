@@ -1,5 +1,6 @@
 #include "SlotReel.h"
 #include "DebugLogger.h"
+#include "Trace.h"
 #include <QPainterPath>
 #include <QCoreApplication>
 #include <QDebug>
@@ -9,39 +10,17 @@ SlotReel::SlotReel(QQuickItem *parent)
     : QQuickPaintedItem(parent)
       , m_spinning(false)
       , m_rotation(0.0)
-      , m_miss_probability(0.55)  // Reduced from 0.70 for better RTP
+      , m_miss_probability(DEFAULT_MISS_PROBABILITY)
       , m_current_miss_offset(0.0)
       , m_target_miss_offset(0.0) {
     // Make it much larger to fill screen height
     setWidth(600);
     setHeight(600);
 
-    // Probabilities tuned for ~95% RTP
-    // Symbol frequency is INVERSE to reward value
-    // Total weight: 52 (excluding miss)
-    // Hit rate: 45% (miss 55%)
-    //
-    // Reward tiers (Level 1-5 multipliers):
-    // - Marienkäfer: 1, 2, 4, 7, 10    (LOW value)    -> HIGH frequency
-    // - Kleeblatt:   3, 8, 16, 29, 50  (MEDIUM value) -> MEDIUM frequency
-    // - Coin:        10, 40, 100, 200, 350 (HIGH value) -> LOW frequency
-    // - Sonne: increases ALL towers    (BONUS)        -> RARE
-    // - Teufel: resets ALL towers      (PENALTY)      -> MODERATE
-    //
-    // Expected symbol distribution when hitting:
-    // - Marienkäfer: 20/52 = 38.5% (common, low value)
-    // - Kleeblatt:   15/52 = 28.8% (medium frequency, medium value)
-    // - Coin:        5/52  = 9.6%  (rare, highest value)
-    // - Sonne:       4/52  = 7.7%  (rare, bonus)
-    // - Teufel:      8/52  = 15.4% (penalty - resets all)
-    m_symbols = {
-        Symbol(":/images/marienkaefer.png", Symbol::Type::Marienkaefer, 20),
-        Symbol(":/images/coin.png",        Symbol::Type::Coin,          5),
-        Symbol(":/images/kleeblatt.png",   Symbol::Type::Kleeblatt,    15),
-        Symbol(":/images/sonne.png",       Symbol::Type::Sonne,         4),
-        Symbol(":/images/teufel.png",      Symbol::Type::Teufel,        8)
-    };
-
+    // Odds and their rationale: see ReelBackend
+    for (const SymbolOdds &odds : DEFAULT_SYMBOLS) {
+        m_symbols.append(Symbol(odds.imagePath, odds.type, odds.weight));
+    }
 
     for (const auto &symbol : m_symbols) {
         if (!symbol.isValid()) {
@@ -53,7 +32,7 @@ SlotReel::SlotReel(QQuickItem *parent)
     build_symbol_sequence();
 
     m_spin_animation = new QPropertyAnimation(this, "rotation", this);
-    m_spin_animation->setDuration(2000);
+    m_spin_animation->setDuration(SPIN_DURATION_MS);
     m_spin_animation->setEasingCurve(QEasingCurve::OutQuart);
 
     connect(m_spin_animation, &QPropertyAnimation::finished,
@@ -61,6 +40,8 @@ SlotReel::SlotReel(QQuickItem *parent)
 }
 
 void SlotReel::paint(QPainter *painter) {
+    // Runs on the scene graph's render thread with the threaded render loop
+    Trace::Span span("render", "SlotReel::paint");
     painter->setRenderHint(QPainter::Antialiasing);
     painter->setRenderHint(QPainter::SmoothPixmapTransform);
     painter->setClipRect(boundingRect());
@@ -152,27 +133,16 @@ void SlotReel::spin() {
 }
 
 void SlotReel::set_probabilities(const QVariantMap &probabilities) {
-    struct SymbolConfig {
-        QString key;
-        Symbol::Type type;
-        QString path;
-    };
-
-    QVector<SymbolConfig> configs = {
-        {"coin", Symbol::Type::Coin, ":/images/coin.png"},
-        {"kleeblatt", Symbol::Type::Kleeblatt, ":/images/kleeblatt.png"},
-        {"marienkaefer", Symbol::Type::Marienkaefer, ":/images/marienkaefer.png"},
-        {"sonne", Symbol::Type::Sonne, ":/images/sonne.png"},
-        {"teufel", Symbol::Type::Teufel, ":/images/teufel.png"}
-    };
+    // Decodes every symbol PNG again
+    Trace::Span span("reel", "setProbabilities");
 
     m_symbols.clear();
-    for (const auto &config : configs) {
-        int prob = probabilities.contains(config.key)
-            ? probabilities[config.key].toInt()
-            : 20;
+    for (const SymbolOdds &odds : DEFAULT_SYMBOLS) {
+        const int prob = probabilities.contains(odds.key)
+            ? probabilities[odds.key].toInt()
+            : UNSPECIFIED_WEIGHT;
         if (prob > 0) {
-            m_symbols.append(Symbol(config.path, config.type, prob));
+            m_symbols.append(Symbol(odds.imagePath, odds.type, prob));
         }
     }
 
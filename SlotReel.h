@@ -6,9 +6,10 @@
 #include <QTimer>
 #include <QRandomGenerator>
 #include <QVector>
+#include "ReelBackend.h"
 #include "Symbol.h"
 
-class SlotReel : public QQuickPaintedItem {
+class SlotReel : public QQuickPaintedItem, public ReelBackend {
     Q_OBJECT
     Q_PROPERTY(qreal rotation READ rotation WRITE set_rotation NOTIFY rotation_changed)
     Q_PROPERTY(qreal miss_probability READ miss_probability WRITE set_miss_probability NOTIFY miss_probability_changed)
@@ -22,22 +23,22 @@ public:
     void paint(QPainter *painter) override;
 
     [[nodiscard]] qreal rotation() const { return m_rotation; }
-    [[nodiscard]] bool spinning() const { return m_spinning; }
+    [[nodiscard]] bool spinning() const override { return m_spinning; }
     [[nodiscard]] qreal miss_probability() const { return m_miss_probability; }
 
-    [[nodiscard]] Symbol::Type currentSymbolType() const {
+    [[nodiscard]] Symbol::Type currentSymbolType() const override {
         return m_current_symbol_type;
     }
 
-    [[nodiscard]] bool isMiss() const { return m_is_miss; }
+    [[nodiscard]] bool isMiss() const override { return m_is_miss; }
 
     void set_rotation(qreal rotation);
 
     Q_INVOKABLE void set_miss_probability(qreal probability);
 
-    Q_INVOKABLE void spin();
+    Q_INVOKABLE void spin() override;
 
-    Q_INVOKABLE void set_probabilities(const QVariantMap &probabilities);
+    Q_INVOKABLE void set_probabilities(const QVariantMap &probabilities) override;
 
 signals:
     void rotation_changed();
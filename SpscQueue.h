@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Capacity must be a power of two; one slot is never wasted because
+// head and tail are free-running counters. T is copied in and out, so keep
+// it small and trivially copyable.
+template<typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // Producer only. False if the ring is full.
+    bool tryPush(const T &value) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache == Capacity) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache == Capacity) {
+                return false;
+            }
+        }
+
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False if the ring is empty.
+    bool tryPop(T &value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cache) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cache) {
+                return false;
+            }
+        }
+
+        value = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently
+    [[nodiscard]] std::size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Each side's index and its cached copy of the other side's index share
+    // a line that only that side writes
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_head_cache = 0;
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tail_cache = 0;
+
+    alignas(CACHE_LINE) std::array<T, Capacity> m_slots{};
+};
@@ -0,0 +1,157 @@
+#include "StallWatchdog.h"
+#include <QFile>
+#include <chrono>
+#include "DebugLogger.h"
+#include "MetricsRegistry.h"
+
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+      , m_open_spans(Trace::currentOpenSpans()) {
+}
+
+StallWatchdog::~StallWatchdog() {
+    stop();
+}
+
+void StallWatchdog::start(const int thresholdMs, const QString &reportPath) {
+    stop();
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_threshold_ns = static_cast<int64_t>(thresholdMs) * 1'000'000;
+        m_report_path = reportPath;
+        m_stop = false;
+        m_heartbeat_sent_ns = 0;
+        m_current.reset();
+        m_finished.reset();
+    }
+    m_thread = std::thread(&StallWatchdog::run, this);
+}
+
+void StallWatchdog::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void StallWatchdog::run() {
+    Trace::setThreadName("Stall watchdog");
+
+    std::unique_lock lock(m_mutex);
+    while (!m_stop) {
+        const int64_t now = Trace::nowNs();
+        if (m_heartbeat_sent_ns == 0) {
+            m_heartbeat_sent_ns = now;
+            QMetaObject::invokeMethod(this, [this, now]() { heartbeatArrived(now); }, Qt::QueuedConnection);
+        } else if (!m_current && now - m_heartbeat_sent_ns >= m_threshold_ns) {
+            captureStall(m_heartbeat_sent_ns);
+        }
+
+        if (m_finished) {
+            Report report = std::move(*m_finished);
+            m_finished.reset();
+            lock.unlock();
+            finishStall(std::move(report));
+            lock.lock();
+        }
+
+        // Decays while nothing stalls, so the gauge is a true rate
+        static MetricsRegistry::Gauge &stallsLastHour = MetricsRegistry::instance().gauge(
+            "allesspitze_gui_stalls_last_hour", "GUI event loop stalls that ended in the last hour");
+        constexpr int64_t HOUR_NS = 3600LL * 1'000'000'000;
+        while (!m_recent_stalls.empty() && now - m_recent_stalls.front() > HOUR_NS) {
+            m_recent_stalls.pop_front();
+        }
+        stallsLastHour.set(static_cast<double>(m_recent_stalls.size()));
+
+        m_cv.wait_for(lock, std::chrono::milliseconds(HEARTBEAT_MS),
+                      [this] { return m_stop || m_finished.has_value(); });
+    }
+}
+
+void StallWatchdog::heartbeatArrived(const int64_t sentNs) {
+    const int64_t latencyNs = Trace::nowNs() - sentNs;
+
+    static MetricsRegistry::Histogram &dispatch = MetricsRegistry::instance().histogram(
+        "allesspitze_gui_dispatch_latency_seconds", "Time from posting an event to the GUI loop running it");
+    dispatch.observe(static_cast<double>(latencyNs) / 1e9);
+
+    std::lock_guard lock(m_mutex);
+    m_heartbeat_sent_ns = 0;
+    if (m_current) {
+        m_current->durationMs = latencyNs / 1'000'000;
+        m_finished = std::move(m_current);
+        m_current.reset();
+        m_cv.notify_one();
+    }
+}
+
+// Runs with m_mutex held, while the loop is still blocked: this is the only
+// moment the open spans say where it is stuck
+void StallWatchdog::captureStall(const int64_t sentNs) {
+    Report report;
+    report.startedAt = QDateTime::currentDateTime().addMSecs(-(Trace::nowNs() - sentNs) / 1'000'000);
+    report.openSpans = Trace::openSpanNames(m_open_spans);
+    for (const QueueCounter &queue: m_queues) {
+        const uint64_t delivered = queue.delivered.load(std::memory_order_relaxed);
+        const uint64_t posted = queue.posted.load(std::memory_order_relaxed);
+        if (posted > delivered) {
+            report.queued.append(QString("%1 %2").arg(QLatin1String(queue.name)).arg(posted - delivered));
+        }
+    }
+    report.logTail = DebugLogger::instance().recentLines();
+    m_current = std::move(report);
+
+    Trace::instant("watchdog", "stallDetected");
+}
+
+void StallWatchdog::finishStall(Report report) {
+    static MetricsRegistry::Counter &stallCount = MetricsRegistry::instance().counter(
+        "allesspitze_gui_stalls_total", "GUI event loop stalls over the threshold");
+    static MetricsRegistry::Histogram &stallSeconds = MetricsRegistry::instance().histogram(
+        "allesspitze_gui_stall_seconds", "Length of GUI event loop stalls",
+        {0.25, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0});
+    stallCount.increment();
+    stallSeconds.observe(static_cast<double>(report.durationMs) / 1000.0);
+    m_stalls.fetch_add(1, std::memory_order_relaxed);
+    m_recent_stalls.push_back(Trace::nowNs());
+
+    // Written here rather than on the GUI thread, which just got free
+    QString writeError;
+    if (!m_report_path.isEmpty()) {
+        QFile file(m_report_path);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+            file.write(formatReport(report).toUtf8());
+        } else {
+            writeError = QString(" (cannot write %1: %2)").arg(m_report_path, file.errorString());
+        }
+    }
+
+    // DebugLogger belongs to the GUI thread, which is running again by now
+    const QString where = report.openSpans.isEmpty() ? QString("outside any traced span")
+                                                     : "in " + report.openSpans.join(" > ");
+    const QString message = QString("GUI stalled for %1 ms %2%3")
+                                .arg(report.durationMs).arg(where, writeError);
+    QMetaObject::invokeMethod(this, [message]() {
+        DebugLogger::instance().warning(message);
+    }, Qt::QueuedConnection);
+}
+
+QString StallWatchdog::formatReport(const Report &report) {
+    QString text = QString("=== GUI stall at %1, %2 ms ===\n")
+                       .arg(report.startedAt.toString("yyyy-MM-dd HH:mm:ss.zzz"))
+                       .arg(report.durationMs);
+    text += "Open spans: " + (report.openSpans.isEmpty() ? QString("none") : report.openSpans.join(" > ")) + "\n";
+    text += "Queued: " + (report.queued.isEmpty() ? QString("none") : report.queued.join(", ")) + "\n";
+    text += "Recent log:\n";
+    for (const QString &line: report.logTail) {
+        text += "  " + line + "\n";
+    }
+    return text + "\n";
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "Trace.h"
+
+// Watches the event loop of the thread it was created on from a thread of
+// its own. Every HEARTBEAT_MS it posts a no-op to the loop and times how
+// long the loop takes to run it (dispatch latency). A heartbeat still
+// waiting after the threshold is a stall: while the loop is still stuck the
+// watchdog notes which Trace spans the thread has open, how many tracked
+// signals are queued behind it and the last log lines. Once the loop runs
+// the heartbeat the report gets its duration and is appended to the report
+// file and logged.
+//
+// Qt does not expose the length of a thread's posted-event queue, so
+// "queued" covers the signals registered with trackQueue().
+class StallWatchdog : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int HEARTBEAT_MS = 50;
+    static constexpr int DEFAULT_THRESHOLD_MS = 250;
+
+    struct Report {
+        QDateTime startedAt;
+        int64_t durationMs = 0;
+        QStringList openSpans; // Outermost first, as "category/name"
+        QStringList queued;    // "name n" for each tracked signal with deliveries waiting
+        QStringList logTail;
+    };
+
+    explicit StallWatchdog(QObject *parent = nullptr);
+
+    ~StallWatchdog() override;
+
+    // reportPath: stall reports are appended there; empty to only log them
+    void start(int thresholdMs, const QString &reportPath);
+
+    void stop();
+
+    // Counts emissions of signal that this thread has not handled yet. Call
+    // after the real connection so the count drops when it has run.
+    template<typename Func>
+    void trackQueue(const char *name, const typename QtPrivate::FunctionPointer<Func>::Object *sender,
+                    Func signal) {
+        QueueCounter &queue = m_queues.emplace_back(name);
+        connect(sender, signal, this, [&queue]() {
+            queue.posted.fetch_add(1, std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        connect(sender, signal, this, [&queue]() {
+            queue.delivered.fetch_add(1, std::memory_order_relaxed);
+        }, Qt::QueuedConnection);
+    }
+
+    [[nodiscard]] uint64_t stalls() const { return m_stalls.load(std::memory_order_relaxed); }
+
+    static QString formatReport(const Report &report);
+
+private:
+    struct QueueCounter {
+        explicit QueueCounter(const char *queueName) : name(queueName) {}
+
+        const char *name;
+        std::atomic<uint64_t> posted{0};
+        std::atomic<uint64_t> delivered{0};
+    };
+
+    void run();
+
+    void heartbeatArrived(int64_t sentNs);
+
+    void captureStall(int64_t sentNs);
+
+    void finishStall(Report report);
+
+    const Trace::OpenSpans *m_open_spans;
+    std::deque<QueueCounter> m_queues; // Stable addresses for the lambdas
+    int64_t m_threshold_ns = 0; // Set before the thread starts
+    QString m_report_path;      // Likewise
+    std::atomic<uint64_t> m_stalls{0};
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    int64_t m_heartbeat_sent_ns = 0;   // 0: no heartbeat outstanding
+    std::optional<Report> m_current;   // Stall in progress
+    std::optional<Report> m_finished;  // Waiting to be written by run()
+    std::deque<int64_t> m_recent_stalls; // End times within the last hour; watchdog thread only
+};
@@ -0,0 +1,218 @@
+#include "StartupPipeline.h"
+#include <algorithm>
+#include "Clock.h"
+#include "DebugLogger.h"
+#include "MetricsRegistry.h"
+
+namespace {
+    double toMs(const qint64 ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    bool isSettled(const StartupPipeline::State state) {
+        return state != StartupPipeline::State::Pending && state != StartupPipeline::State::Running;
+    }
+}
+
+StartupPipeline::StartupPipeline(QObject *parent)
+    : QObject(parent) {
+    m_clock.start();
+}
+
+void StartupPipeline::addStep(const QString &name, const QStringList &after, std::function<void()> run,
+                              const int timeoutMs) {
+    if (m_started || find(name)) {
+        DebugLogger::instance().warning("Startup: step '" + name + "' not added");
+        return;
+    }
+
+    Step step;
+    step.name = name;
+    step.after = after;
+    step.run = std::move(run);
+    step.timeoutMs = timeoutMs;
+    m_steps.push_back(std::move(step));
+}
+
+void StartupPipeline::addMilestone(const QString &name, const QStringList &after) {
+    addStep(name, after, nullptr, 0);
+    if (Step *step = find(name)) {
+        step->milestone = true;
+    }
+}
+
+void StartupPipeline::start() {
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    // An unknown dependency would keep its step pending forever
+    for (Step &step: m_steps) {
+        for (const QString &dependency: std::as_const(step.after)) {
+            if (!find(dependency)) {
+                DebugLogger::instance().warning(
+                    QString("Startup: '%1' waits for unknown step '%2' - ignoring it")
+                    .arg(step.name, dependency));
+            }
+        }
+        step.after.removeIf([this](const QString &dependency) { return !find(dependency); });
+    }
+
+    advance();
+}
+
+void StartupPipeline::finish(const QString &name, const bool success) {
+    Step *step = find(name);
+    if (!step || step->state != State::Running) {
+        return;
+    }
+
+    settle(*step, success ? State::Done : State::Failed);
+    advance();
+}
+
+bool StartupPipeline::isFinished(const QString &name) const {
+    const Step *step = find(name);
+    return step && isSettled(step->state);
+}
+
+bool StartupPipeline::isComplete() const {
+    return m_started && std::ranges::all_of(m_steps, [](const Step &step) { return isSettled(step.state); });
+}
+
+StartupPipeline::Step *StartupPipeline::find(const QString &name) {
+    const auto it = std::ranges::find(m_steps, name, &Step::name);
+    return it != m_steps.end() ? &*it : nullptr;
+}
+
+const StartupPipeline::Step *StartupPipeline::find(const QString &name) const {
+    const auto it = std::ranges::find(m_steps, name, &Step::name);
+    return it != m_steps.end() ? &*it : nullptr;
+}
+
+void StartupPipeline::advance() {
+    // run() may finish its step synchronously and re-enter; the steps
+    // vector no longer changes once started, so indices stay valid
+    for (std::size_t i = 0; i < m_steps.size(); ++i) {
+        Step &step = m_steps[i];
+        if (step.state != State::Pending ||
+            !std::ranges::all_of(step.after, [this](const QString &dependency) {
+                return isFinished(dependency);
+            })) {
+            continue;
+        }
+
+        step.state = State::Running;
+        step.startedNs = m_clock.nsecsElapsed();
+
+        if (step.milestone) {
+            settle(step, State::Done);
+            continue;
+        }
+
+        if (step.timeoutMs > 0) {
+            ClockTimer::singleShot(step.timeoutMs, this, [this, name = step.name]() {
+                Step *running = find(name);
+                if (!running || running->state != State::Running) {
+                    return;
+                }
+                DebugLogger::instance().warning(
+                    QString("Startup: '%1' did not finish within %2 ms - continuing without it")
+                    .arg(name).arg(running->timeoutMs));
+                settle(*running, State::TimedOut);
+                advance();
+            });
+        }
+
+        if (step.run) {
+            step.run();
+        }
+    }
+
+    if (!m_reported && isComplete()) {
+        m_reported = true;
+        report();
+    }
+}
+
+void StartupPipeline::settle(Step &step, const State state) {
+    step.state = state;
+    step.finishedNs = m_clock.nsecsElapsed();
+    const qint64 elapsedMs = step.finishedNs / 1000000;
+
+    if (step.milestone) {
+        DebugLogger::instance().info(QString("Startup: %1 after %2 ms").arg(step.name).arg(elapsedMs));
+        emit milestoneReached(step.name, elapsedMs);
+    } else {
+        DebugLogger::instance().verbose(
+            QString("Startup: '%1' %2 after %3 ms")
+            .arg(step.name, stateName(state)).arg(toMs(step.finishedNs - step.startedNs), 0, 'f', 1));
+    }
+    emit stepFinished(step.name, state, elapsedMs);
+}
+
+void StartupPipeline::report() {
+    auto &registry = MetricsRegistry::instance();
+    for (const Step &step: m_steps) {
+        const QString labels = QString("step=\"%1\"").arg(step.name);
+        if (step.milestone) {
+            registry.gauge("allesspitze_startup_milestone_seconds",
+                           "Time from launch until a startup milestone was reached", labels)
+                    .set(static_cast<double>(step.finishedNs) / 1e9);
+        } else {
+            registry.gauge("allesspitze_startup_step_seconds",
+                           "Time a startup step took from its dependencies being met to finishing", labels)
+                    .set(static_cast<double>(step.finishedNs - step.startedNs) / 1e9);
+        }
+    }
+
+    DebugLogger::instance().info(formatReport());
+    emit complete(m_clock.elapsed());
+}
+
+QString StartupPipeline::formatReport() const {
+    QString result = QString("=== Startup ===\n"
+                             "%1 %2 %3 %4  %5\n")
+            .arg(QString("STEP").leftJustified(16))
+            .arg(QString("STARTms"), 8)
+            .arg(QString("DONEms"), 8)
+            .arg(QString("TOOKms"), 8)
+            .arg(QString("STATE"));
+
+    // In the order the steps finished, so the slowest chain ends the table
+    std::vector<const Step *> ordered;
+    for (const Step &step: m_steps) {
+        ordered.push_back(&step);
+    }
+    std::ranges::stable_sort(ordered, {}, [](const Step *step) { return step->finishedNs; });
+
+    for (const Step *step: ordered) {
+        const bool settled = isSettled(step->state);
+        result += QString("%1 %2 %3 %4  %5\n")
+                .arg(step->name.leftJustified(16))
+                .arg(toMs(step->startedNs), 8, 'f', 1)
+                .arg(settled ? QString::number(toMs(step->finishedNs), 'f', 1) : QString("-"), 8)
+                .arg(step->milestone || !settled
+                         ? QString("-")
+                         : QString::number(toMs(step->finishedNs - step->startedNs), 'f', 1), 8)
+                .arg(step->milestone ? QString("milestone") : stateName(step->state));
+    }
+    return result + "===============\n";
+}
+
+QString StartupPipeline::stateName(const State state) {
+    switch (state) {
+        case State::Pending:
+            return "pending";
+        case State::Running:
+            return "running";
+        case State::Done:
+            return "done";
+        case State::Failed:
+            return "failed";
+        case State::TimedOut:
+            return "timed out";
+    }
+    return "unknown";
+}
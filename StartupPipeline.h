@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+// Bring-up as a dependency graph instead of fixed delays. Every step names
+// the steps it waits for; it starts the moment they have finished and ends
+// when its completion signal calls finish(), so independent steps (worker
+// threads, serial scan, QML load) overlap and nothing waits longer than it
+// has to. A step that overruns its timeout is given up on and its
+// dependents start anyway, so missing hardware degrades startup instead of
+// blocking it. Milestones are steps without work of their own, e.g.
+// "playable".
+//
+// Times are measured from construction; the breakdown is logged and
+// exported as metrics once every step has finished. GUI thread only.
+class StartupPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_TIMEOUT_MS = 5000;
+
+    enum class State : uint8_t {
+        Pending,
+        Running,
+        Done,
+        Failed,   // finish(name, false)
+        TimedOut
+    };
+
+    struct Step {
+        QString name;
+        QStringList after;
+        std::function<void()> run; // Empty for milestones and steps finished from outside
+        bool milestone = false;
+        int timeoutMs = 0;
+        State state = State::Pending;
+        qint64 startedNs = 0;
+        qint64 finishedNs = 0;
+    };
+
+    explicit StartupPipeline(QObject *parent = nullptr);
+
+    // run may call finish() itself for synchronous work. timeoutMs 0 waits forever.
+    void addStep(const QString &name, const QStringList &after, std::function<void()> run,
+                 int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    void addMilestone(const QString &name, const QStringList &after);
+
+    // Starts every step without dependencies
+    void start();
+
+    // Ignored unless the step is running, so late or repeated completion
+    // signals are harmless
+    void finish(const QString &name, bool success = true);
+
+    [[nodiscard]] bool isFinished(const QString &name) const;
+
+    [[nodiscard]] bool isComplete() const;
+
+    [[nodiscard]] QString formatReport() const;
+
+    static QString stateName(State state);
+
+signals:
+    void stepFinished(const QString &name, StartupPipeline::State state, qint64 elapsedMs);
+
+    void milestoneReached(const QString &name, qint64 elapsedMs);
+
+    void complete(qint64 elapsedMs);
+
+private:
+    Step *find(const QString &name);
+
+    [[nodiscard]] const Step *find(const QString &name) const;
+
+    void advance();
+
+    void settle(Step &step, State state);
+
+    void report();
+
+    std::vector<Step> m_steps;
+    QElapsedTimer m_clock;
+    bool m_started = false;
+    bool m_reported = false;
+};
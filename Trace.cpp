@@ -0,0 +1,412 @@
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMetaProperty>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char *category;
+        const char *name;
+        const char *argName; // nullptr: no argument
+        double argValue;
+        int64_t timestampNs;
+        int64_t durationNs;  // Complete events only
+        uint32_t id;         // Flow or async id
+        char phase;          // Chrome trace-event phase
+    };
+
+    // ~450 KiB per thread that ever recorded; a few seconds of a busy
+    // GUI thread
+    constexpr std::size_t EVENTS_PER_THREAD = 8192;
+
+    // Written only by its thread. The dump copies a slot and then checks
+    // the write count again to discard anything overwritten meanwhile.
+    struct ThreadBuffer {
+        std::array<Event, EVENTS_PER_THREAD> events;
+        std::atomic<uint64_t> written{0};
+        int tid = 0;
+        QString name; // Guarded by the registry mutex
+    };
+
+    // Buffers stay alive after their thread exits so its events can still
+    // be dumped; the app has a handful of long-lived threads
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    Registry &registry() {
+        // Never destroyed: threads may still record during static teardown
+        static auto *instance = new Registry;
+        return *instance;
+    }
+
+    // Deeper spans are not recorded but still counted, so pops stay balanced
+    constexpr int MAX_OPEN_SPANS = 16;
+
+    thread_local ThreadBuffer *t_buffer = nullptr;
+    thread_local uint32_t t_flow = 0;
+    std::atomic<uint32_t> g_next_flow{1};
+
+    ThreadBuffer &threadBuffer() {
+        if (!t_buffer) {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            const QThread *thread = QThread::currentThread();
+            buffer->name = thread ? thread->objectName() : QString();
+
+            Registry &r = registry();
+            std::lock_guard lock(r.mutex);
+            buffer->tid = static_cast<int>(r.buffers.size()) + 1;
+            if (buffer->name.isEmpty()) {
+                buffer->name = QString("Thread %1").arg(buffer->tid);
+            }
+            t_buffer = buffer.get();
+            r.buffers.push_back(std::move(buffer));
+        }
+        return *t_buffer;
+    }
+
+    void record(const char phase, const char *category, const char *name, const int64_t timestampNs,
+                const int64_t durationNs = 0, const uint32_t id = 0,
+                const char *argName = nullptr, const double argValue = 0.0) {
+        ThreadBuffer &buffer = threadBuffer();
+        const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+        buffer.events[index % EVENTS_PER_THREAD] = {
+            category, name, argName, argValue, timestampNs, durationNs, id, phase
+        };
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+
+    void appendString(QByteArray &out, const char *text) {
+        out.append('"');
+        for (const char *c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out.append('\\').append(*c);
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                out.append(' ');
+            } else {
+                out.append(*c);
+            }
+        }
+        out.append('"');
+    }
+
+    void appendMicros(QByteArray &out, const int64_t ns) {
+        out.append(QByteArray::number(static_cast<double>(ns) / 1000.0, 'f', 3));
+    }
+
+    void appendEvent(QByteArray &out, const Event &event, const qint64 pid, const int tid) {
+        out.append("{\"ph\":\"").append(event.phase).append("\",\"pid\":")
+           .append(QByteArray::number(pid)).append(",\"tid\":").append(QByteArray::number(tid))
+           .append(",\"ts\":");
+        appendMicros(out, event.timestampNs);
+
+        switch (event.phase) {
+            case 'X':
+                out.append(",\"dur\":");
+                appendMicros(out, event.durationNs);
+                break;
+            case 's':
+            case 't':
+                out.append(",\"id\":").append(QByteArray::number(event.id));
+                if (event.phase == 't') {
+                    out.append(",\"bp\":\"e\"");
+                }
+                break;
+            case 'b':
+            case 'e':
+                out.append(",\"id\":").append(QByteArray::number(event.id));
+                break;
+            case 'i':
+                out.append(",\"s\":\"t\"");
+                break;
+            default:
+                break;
+        }
+
+        out.append(",\"cat\":");
+        appendString(out, event.category);
+        out.append(",\"name\":");
+        appendString(out, event.name);
+
+        if (event.argName) {
+            out.append(",\"args\":{");
+            appendString(out, event.argName);
+            out.append(':').append(QByteArray::number(std::isfinite(event.argValue) ? event.argValue : 0.0, 'g', 15))
+               .append('}');
+        }
+        out.append('}');
+    }
+
+    void appendMetadata(QByteArray &out, const char *kind, const qint64 pid, const int tid, const QString &name) {
+        out.append("{\"ph\":\"M\",\"pid\":").append(QByteArray::number(pid))
+           .append(",\"tid\":").append(QByteArray::number(tid))
+           .append(",\"name\":\"").append(kind).append("\",\"args\":{\"name\":");
+        appendString(out, name.toUtf8().constData());
+        out.append("}}");
+    }
+}
+
+void Trace::setEnabled(const bool on) {
+    detail::enabled.store(on, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const QString &name) {
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard lock(registry().mutex);
+    buffer.name = name;
+}
+
+int64_t Trace::nowNs() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+// Written only by its thread; the names are literals, so a reader that
+// races a push or pop sees a stale but valid pointer
+class Trace::OpenSpans {
+public:
+    std::array<std::atomic<const char *>, MAX_OPEN_SPANS> categories{};
+    std::array<std::atomic<const char *>, MAX_OPEN_SPANS> names{};
+    std::atomic<int> depth{0};
+};
+
+namespace {
+    thread_local Trace::OpenSpans t_open_spans;
+}
+
+const Trace::OpenSpans *Trace::currentOpenSpans() {
+    return &t_open_spans;
+}
+
+QStringList Trace::openSpanNames(const OpenSpans *spans) {
+    QStringList result;
+    if (!spans) {
+        return result;
+    }
+
+    const int depth = std::min(spans->depth.load(std::memory_order_acquire), MAX_OPEN_SPANS);
+    for (int i = 0; i < depth; ++i) {
+        const char *category = spans->categories[i].load(std::memory_order_relaxed);
+        const char *name = spans->names[i].load(std::memory_order_relaxed);
+        if (category && name) {
+            result.append(QString("%1/%2").arg(QLatin1String(category), QLatin1String(name)));
+        }
+    }
+    return result;
+}
+
+Trace::Span::Span(const char *category, const char *name)
+    : m_category(category)
+      , m_name(name) {
+    const int depth = t_open_spans.depth.load(std::memory_order_relaxed);
+    if (depth < MAX_OPEN_SPANS) {
+        t_open_spans.categories[depth].store(category, std::memory_order_relaxed);
+        t_open_spans.names[depth].store(name, std::memory_order_relaxed);
+    }
+    t_open_spans.depth.store(depth + 1, std::memory_order_release);
+
+    if (!enabled()) {
+        return;
+    }
+
+    m_start_ns = nowNs();
+    if (t_flow != 0) {
+        record('t', "flow", "flow", m_start_ns, 0, t_flow);
+    }
+}
+
+Trace::Span::~Span() {
+    t_open_spans.depth.store(t_open_spans.depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+
+    if (m_start_ns < 0) {
+        return;
+    }
+    record('X', m_category, m_name, m_start_ns, nowNs() - m_start_ns, 0, m_arg_name, m_arg_value);
+}
+
+void Trace::instant(const char *category, const char *name, const char *argName, const double value) {
+    if (enabled()) {
+        record('i', category, name, nowNs(), 0, 0, argName, value);
+    }
+}
+
+void Trace::counter(const char *category, const char *name, const double value) {
+    if (enabled()) {
+        record('C', category, name, nowNs(), 0, 0, "value", value);
+    }
+}
+
+void Trace::asyncBegin(const char *category, const char *name, const uint32_t id) {
+    if (enabled()) {
+        record('b', category, name, nowNs(), 0, id);
+    }
+}
+
+void Trace::asyncEnd(const char *category, const char *name, const uint32_t id) {
+    if (enabled()) {
+        record('e', category, name, nowNs(), 0, id);
+    }
+}
+
+uint32_t Trace::newFlow() {
+    if (!enabled()) {
+        return 0;
+    }
+
+    uint32_t flow = g_next_flow.fetch_add(1, std::memory_order_relaxed);
+    if (flow == 0) {
+        flow = g_next_flow.fetch_add(1, std::memory_order_relaxed); // Wrapped
+    }
+    return flow;
+}
+
+uint32_t Trace::currentFlow() {
+    return t_flow;
+}
+
+Trace::FlowScope::FlowScope(const uint32_t flow)
+    : m_previous(t_flow) {
+    if (flow != 0) {
+        t_flow = flow;
+    }
+}
+
+Trace::FlowScope::~FlowScope() {
+    t_flow = m_previous;
+}
+
+void Trace::flowStart(const uint32_t flow) {
+    if (enabled() && flow != 0) {
+        // Flow events share one category and name so viewers link them by id
+        record('s', "flow", "flow", nowNs(), 0, flow);
+    }
+}
+
+bool Trace::dumpChromeJson(const QString &path, DumpResult &result, QString &error) {
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray out;
+    out.reserve(1024 * 1024);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    const QString processName = QCoreApplication::applicationName().isEmpty()
+                                    ? QString("AllesSpitze")
+                                    : QCoreApplication::applicationName();
+    appendMetadata(out, "process_name", pid, 0, processName);
+
+    result = {};
+    std::vector<Event> events;
+    {
+        Registry &r = registry();
+        std::lock_guard lock(r.mutex);
+        for (const auto &buffer: r.buffers) {
+            const uint64_t written = buffer->written.load(std::memory_order_acquire);
+            const uint64_t first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+
+            events.clear();
+            for (uint64_t i = first; i < written; ++i) {
+                events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+            }
+
+            // The owner kept recording while we copied; slots it reached
+            // again (and the one it may be writing now) are not trustworthy
+            const uint64_t after = buffer->written.load(std::memory_order_acquire);
+            const uint64_t valid = after >= EVENTS_PER_THREAD ? after - EVENTS_PER_THREAD + 1 : 0;
+            const std::size_t skip = valid > first ? static_cast<std::size_t>(valid - first) : 0;
+
+            out.append(",\n");
+            appendMetadata(out, "thread_name", pid, buffer->tid, buffer->name);
+            for (std::size_t i = skip; i < events.size(); ++i) {
+                out.append(",\n");
+                appendEvent(out, events[i], pid, buffer->tid);
+                ++result.events;
+            }
+            ++result.threads;
+        }
+    }
+    out.append("\n]}\n");
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    if (file.write(out) != out.size()) {
+        error = QString("Short write to %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+QString Trace::defaultDumpPath() {
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    return dataDir + "/trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json";
+}
+
+void Trace::watchProperties(QObject *object) {
+    new TracePropertyWatcher(object);
+}
+
+TracePropertyWatcher::TracePropertyWatcher(QObject *object)
+    : QObject(object) {
+    const QMetaObject *meta = object->metaObject();
+    const QMetaMethod slot = metaObject()->method(metaObject()->indexOfSlot("propertyChanged()"));
+
+    for (int i = QObject::staticMetaObject.propertyCount(); i < meta->propertyCount(); ++i) {
+        const QMetaProperty property = meta->property(i);
+        if (!property.hasNotifySignal()) {
+            continue;
+        }
+
+        // Several properties may share one notify signal
+        QList<int> &properties = m_properties_for_signal[property.notifySignalIndex()];
+        if (properties.isEmpty()) {
+            connect(object, property.notifySignal(), this, slot);
+        }
+        properties.append(i);
+    }
+}
+
+void TracePropertyWatcher::propertyChanged() {
+    if (!Trace::enabled()) {
+        return;
+    }
+
+    const QObject *object = sender();
+    const auto it = m_properties_for_signal.constFind(senderSignalIndex());
+    if (!object || it == m_properties_for_signal.constEnd()) {
+        return;
+    }
+
+    for (const int index: *it) {
+        const QMetaProperty property = object->metaObject()->property(index);
+        const QVariant value = property.read(object);
+        switch (value.metaType().id()) {
+            case QMetaType::Bool:
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::LongLong:
+            case QMetaType::ULongLong:
+            case QMetaType::Float:
+            case QMetaType::Double:
+                Trace::counter("state", property.name(), value.toDouble());
+                break;
+            default:
+                Trace::instant("state", property.name());
+                break;
+        }
+    }
+}
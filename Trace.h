@@ -0,0 +1,145 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <cstdint>
+
+// In-process tracing for latency work that crosses the GUI, I2C and serial
+// threads. Events go into a fixed ring owned by the recording thread, so
+// recording never locks or allocates once a thread has its ring; the oldest
+// events are overwritten. dumpChromeJson() writes everything still in the
+// rings as Chrome trace-event JSON for chrome://tracing or ui.perfetto.dev.
+//
+// Off by default; while off every call below is one relaxed load, except
+// that Spans always keep their thread's open-span stack (two relaxed stores)
+// so a stall can be attributed without tracing. Names,
+// categories and argument names are stored as pointers and must outlive
+// the trace: string literals or moc'd property names.
+//
+// Flows tie a chain of work together across threads. A flow id is started
+// where the chain begins, travels with whatever crosses the thread boundary
+// (a signal argument, I2CCommand::traceFlow) and is made current on the
+// other side with a FlowScope; every Span opened while a flow is current
+// becomes a step of it.
+namespace Trace {
+    namespace detail {
+        inline std::atomic<bool> enabled{false};
+    }
+
+    [[nodiscard]] inline bool enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool on);
+
+    // Label for the calling thread's track. Call once from the thread,
+    // e.g. in a worker's initialize().
+    void setThreadName(const QString &name);
+
+    // Monotonic, nanoseconds since the first call
+    [[nodiscard]] int64_t nowNs();
+
+    // Complete event covering the Span's lifetime
+    class Span {
+    public:
+        Span(const char *category, const char *name);
+
+        ~Span();
+
+        Span(const Span &) = delete;
+
+        Span &operator=(const Span &) = delete;
+
+        // One numeric argument shown with the event
+        void setArg(const char *argName, const double value) {
+            m_arg_name = argName;
+            m_arg_value = value;
+        }
+
+    private:
+        const char *m_category;
+        const char *m_name;
+        const char *m_arg_name = nullptr;
+        double m_arg_value = 0.0;
+        int64_t m_start_ns = -1; // -1 while tracing was off at construction
+    };
+
+    void instant(const char *category, const char *name, const char *argName = nullptr, double value = 0.0);
+
+    // Numeric value over time, drawn as its own track
+    void counter(const char *category, const char *name, double value);
+
+    // Begin/end of an operation that is not a C++ scope (an animation,
+    // a timer), matched by id
+    void asyncBegin(const char *category, const char *name, uint32_t id);
+
+    void asyncEnd(const char *category, const char *name, uint32_t id);
+
+    // Fresh flow id, or 0 while tracing is off. 0 is never a valid flow.
+    [[nodiscard]] uint32_t newFlow();
+
+    // Flow current on the calling thread, 0 if none
+    [[nodiscard]] uint32_t currentFlow();
+
+    // Makes flow current on this thread for its lifetime; 0 is a no-op
+    class FlowScope {
+    public:
+        explicit FlowScope(uint32_t flow);
+
+        ~FlowScope();
+
+        FlowScope(const FlowScope &) = delete;
+
+        FlowScope &operator=(const FlowScope &) = delete;
+
+    private:
+        uint32_t m_previous;
+    };
+
+    // The calling thread's open spans, for reading from another thread
+    // (see StallWatchdog). Valid until that thread exits.
+    class OpenSpans;
+
+    [[nodiscard]] const OpenSpans *currentOpenSpans();
+
+    // "category/name" of each span open on the thread, outermost first.
+    // Racy by design: a span may close while it is being read.
+    [[nodiscard]] QStringList openSpanNames(const OpenSpans *spans);
+
+    // Starts a flow at the current point. Open a Span first so the flow
+    // has a slice to attach to.
+    void flowStart(uint32_t flow);
+
+    struct DumpResult {
+        int events = 0;
+        int threads = 0;
+    };
+
+    // Writes every buffered event; tracing stays in whatever state it was
+    bool dumpChromeJson(const QString &path, DumpResult &result, QString &error);
+
+    // trace-<timestamp>.json in the app data directory
+    [[nodiscard]] QString defaultDumpPath();
+
+    // Records a counter (numbers, bools) or an instant (anything else) under
+    // category "state" whenever one of object's notifying properties
+    // changes. The watcher is a child of object.
+    void watchProperties(QObject *object);
+}
+
+// Helper for Trace::watchProperties: one slot shared by every notify signal,
+// mapped back to the property through senderSignalIndex()
+class TracePropertyWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TracePropertyWatcher(QObject *object);
+
+private slots:
+    void propertyChanged();
+
+private:
+    QHash<int, QList<int>> m_properties_for_signal; // Notify signal -> properties
+};
@@ -48,3 +48,7 @@ echo "  - 'Program received signal SIGSEGV' - shows crash location"
 echo "  - Stack frames with '???' - missing debug symbols"
 echo "  - Last function called before crash"
 
+echo ""
+echo "Without gdb: every crash is also in the flight recorder. Decode it with"
+echo "  flight_decode ~/.local/share/AllesSpitze/AllesSpitzeQt/flight.ring --bus ~/.local/share/AllesSpitze/AllesSpitzeQt/i2c_bus.ring"
+echo "(build with -DALLESSPITZE_BUILD_TOOLS=ON)"
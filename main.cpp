@@ -1,3 +1,6 @@
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <memory>
 #include "ApplicationController.h"
 
 /**
@@ -7,7 +10,15 @@
  * @return
  */
 int main(int argc, char *argv[]) {
-    QGuiApplication app(argc, argv);
+    // ALLESSPITZE_HEADLESS=1 for cabinets with only towers, buttons and the
+    // balance display: no window system, QML or scene graph is brought up
+    const bool headless = qEnvironmentVariable("ALLESSPITZE_HEADLESS") == "1";
+    std::unique_ptr<QCoreApplication> app;
+    if (headless) {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QGuiApplication>(argc, argv);
+    }
 
     // Set application metadata for proper data directory creation
     QCoreApplication::setOrganizationName("AllesSpitze");
@@ -16,7 +27,7 @@ int main(int argc, char *argv[]) {
     // Ensure QML engine doesn't crash on missing resources
     qputenv("QT_QUICK_CONTROLS_STYLE", "Basic");
 
-    ApplicationController controller;
+    ApplicationController controller(headless);
     controller.initialize();
 
     if (!controller.start()) {
@@ -24,5 +35,5 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
-    return QGuiApplication::exec();
+    return QCoreApplication::exec();
 }
\ No newline at end of file
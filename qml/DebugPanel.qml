@@ -80,6 +80,20 @@ Rectangle {
                     }
                 }
             }
+
+            Item { Layout.fillWidth: true }
+
+            // Button press -> first frame on screen, rolling percentiles
+            Label {
+                readonly property var latency: appController.inputLatency
+                text: latency.samples > 0
+                      ? "Input p50/p95/p99: " + latency.p50Ms.toFixed(0) + "/" + latency.p95Ms.toFixed(0)
+                        + "/" + latency.p99Ms.toFixed(0) + " ms, ignored " + latency.ignored
+                      : "Input latency: no presses yet"
+                color: latency.p95Ms > 100 ? "#ffa500" : "#aaa"
+                font.family: "Courier"
+                font.pixelSize: 12
+            }
         }
 
         ScrollView {
@@ -63,11 +63,27 @@ Rectangle {
         spacing: 10
 
         // Header
-        Label {
-            text: "🔧 I2C Debug Interface"
-            color: "#00d4ff"
-            font.bold: true
-            font.pixelSize: 16
+        RowLayout {
+            Layout.fillWidth: true
+
+            Label {
+                text: "🔧 I2C Debug Interface"
+                color: "#00d4ff"
+                font.bold: true
+                font.pixelSize: 16
+            }
+
+            Item { Layout.fillWidth: true }
+
+            // Link state reported by the I2C worker
+            Label {
+                text: appController.i2cState
+                color: appController.i2cState === "Ready" ? "#4caf50"
+                     : appController.i2cState === "Degraded" ? "#ffa500"
+                     : "#f44336"
+                font.family: "Courier"
+                font.pixelSize: 12
+            }
         }
 
         Rectangle {
@@ -307,6 +323,63 @@ Rectangle {
             color: "#444"
         }
 
+        // Per-opcode bus counters, refreshed once per second
+        Label {
+            text: "📊 Bus Statistics"
+            color: "#aaa"
+            font.pixelSize: 12
+            font.bold: true
+        }
+
+        GridLayout {
+            Layout.fillWidth: true
+            columns: 7
+            columnSpacing: 6
+            rowSpacing: 1
+
+            Repeater {
+                model: ["OPCODE", "SENT", "RETRY", "CRC", "MISM", "P50", "P99"]
+                Label {
+                    text: modelData
+                    color: "#888"
+                    font.family: "Courier"
+                    font.pixelSize: 10
+                    Layout.fillWidth: index === 0
+                }
+            }
+
+            Repeater {
+                model: appController.i2cStats
+                delegate: Repeater {
+                    property var row: modelData
+                    model: [
+                        row.name,
+                        row.sent,
+                        row.retries,
+                        row.checksumFailures,
+                        row.mismatches,
+                        row.p50Ms.toFixed(1),
+                        row.p99Ms.toFixed(1)
+                    ]
+                    Label {
+                        text: modelData
+                        color: index === 0 ? "#00d4ff"
+                             : (index >= 2 && index <= 4 && modelData > 0) ? "#ffa500"
+                             : "#ccc"
+                        font.family: "Courier"
+                        font.pixelSize: 10
+                        Layout.fillWidth: index === 0
+                    }
+                }
+            }
+        }
+
+        Rectangle {
+            Layout.fillWidth: true
+            height: 1
+            color: "#444"
+        }
+
         // Response History
         Label {
             text: "📋 Response History"
@@ -377,6 +450,63 @@ Rectangle {
             }
         }
 
+        // Cross-thread trace, viewable in ui.perfetto.dev
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 5
+
+            Button {
+                Layout.fillWidth: true
+                text: appController.tracing ? "⏹ Stop Trace" : "⏺ Start Trace"
+                implicitHeight: 30
+
+                background: Rectangle {
+                    color: parent.pressed ? "#333" : (appController.tracing ? "#5a1e1e" : "#2a2a2a")
+                    border.color: "#555"
+                    radius: 4
+                }
+
+                contentItem: Text {
+                    text: parent.text
+                    color: "#ccc"
+                    font.pixelSize: 11
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                }
+
+                onClicked: appController.setTracing(!appController.tracing)
+            }
+
+            Button {
+                Layout.fillWidth: true
+                text: "💾 Dump Trace"
+                implicitHeight: 30
+
+                background: Rectangle {
+                    color: parent.pressed ? "#333" : "#2a2a2a"
+                    border.color: "#555"
+                    radius: 4
+                }
+
+                contentItem: Text {
+                    text: parent.text
+                    color: "#ccc"
+                    font.pixelSize: 11
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                }
+
+                onClicked: {
+                    var result = appController.dumpTrace()
+                    responseHistory.append({
+                        "cmd": "TRACE",
+                        "success": result.indexOf("OK") === 0,
+                        "response": result
+                    })
+                }
+            }
+        }
+
         // Clear button
         Button {
             Layout.fillWidth: true
@@ -0,0 +1,219 @@
+// Soak test for the I2C link on virtual time.
+//
+// Installs a SimulatedClock and runs the real I2CWorker against
+// SimulatedArduino for hours of cabinet operation: button polling, the
+// 1 s healthcheck, periodic power cuts of the boards and the recovery that
+// follows, all driven by the same timers as on the cabinet but without
+// waiting for them. Reports how every outage was recovered from and how
+// many presses made it through.
+//
+// Usage: cabinet_soak [--hours H] [--latency MS] [--drop P] [--corrupt P]
+//                     [--outage-every MIN] [--outage-length S]
+//                     [--press-every S] [--seed N]
+//
+// Exits non-zero if the link did not come back after every power cut.
+
+#include "Clock.h"
+#include "I2CWorker.h"
+#include "SimulatedArduino.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    constexpr uint8_t DEVICE_ADDRESS = 0x42;
+    constexpr int HEALTHCHECK_INTERVAL_MS = 1000; // As ApplicationController
+    constexpr int DRAIN_MS = 5000;                 // Settle time after the last press
+
+    struct Outage {
+        int64_t startMs = 0;
+        int64_t endMs = 0;
+        int64_t recoveredMs = -1; // Link operational again
+    };
+
+    bool isOperational(const I2CWorker::ConnectionState state) {
+        return state == I2CWorker::ConnectionState::Ready ||
+               state == I2CWorker::ConnectionState::Degraded;
+    }
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message) {
+        if (type == QtCriticalMsg || type == QtFatalMsg) {
+            std::fprintf(stderr, "%s\n", qPrintable(message));
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Before anything creates a timer
+    auto clockStorage = std::make_unique<SimulatedClock>();
+    SimulatedClock &clock = *clockStorage;
+    Clock::install(std::move(clockStorage));
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AllesSpitzeCabinetSoak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("I2C link soak test on virtual time");
+    parser.addHelpOption();
+    const QCommandLineOption hoursOption("hours", "Virtual cabinet hours to run.", "h", "8");
+    const QCommandLineOption latencyOption("latency", "Simulated response latency.", "ms", "20");
+    const QCommandLineOption dropOption("drop", "Probability of a missing reply.", "p", "0.001");
+    const QCommandLineOption corruptOption("corrupt", "Probability of a corrupt reply.", "p", "0.001");
+    const QCommandLineOption outageEveryOption("outage-every", "Power cut interval, 0 for none.", "min", "30");
+    const QCommandLineOption outageLengthOption("outage-length", "Length of each power cut.", "s", "20");
+    const QCommandLineOption pressEveryOption("press-every", "Button press interval.", "s", "5");
+    const QCommandLineOption seedOption("seed", "Fault injection seed.", "n", "1");
+    parser.addOptions({hoursOption, latencyOption, dropOption, corruptOption, outageEveryOption,
+                       outageLengthOption, pressEveryOption, seedOption});
+    parser.process(app);
+
+    const int64_t durationMs = static_cast<int64_t>(parser.value(hoursOption).toDouble() * 3600.0 * 1000.0);
+    const int outageEveryMs = std::max(0, parser.value(outageEveryOption).toInt()) * 60 * 1000;
+    const int outageLengthMs = std::max(1, parser.value(outageLengthOption).toInt()) * 1000;
+    const int pressEveryMs = std::max(1, static_cast<int>(parser.value(pressEveryOption).toDouble() * 1000.0));
+
+    SimulatedArduino::Config config;
+    config.latencyMs = std::max(0, parser.value(latencyOption).toInt());
+    config.dropRate = parser.value(dropOption).toDouble();
+    config.corruptRate = parser.value(corruptOption).toDouble();
+    config.seed = parser.value(seedOption).toUInt();
+
+    qInstallMessageHandler(quietMessageHandler);
+
+    auto transport = std::make_unique<SimulatedArduino>(config);
+    SimulatedArduino &sim = *transport;
+
+    // The worker stays on this thread: SimulatedClock fires timers directly
+    I2CWorker worker;
+    worker.setTransport(std::move(transport));
+    worker.initialize();
+
+    uint64_t pressesSent = 0;
+    uint64_t pressesReceived = 0;
+    uint64_t pressesLost = 0; // Still queued on a board when its power was cut
+    uint64_t recoveries = 0;
+    std::vector<Outage> outages;
+
+    QObject::connect(&worker, &I2CWorker::buttonEventsReceived,
+                     [&pressesReceived](const QVector<uint8_t> &buttons) {
+                         pressesReceived += static_cast<uint64_t>(buttons.size());
+                     });
+    QObject::connect(&worker, &I2CWorker::deviceStateChanged,
+                     [&recoveries](uint8_t, const I2CWorker::ConnectionState state) {
+                         if (state == I2CWorker::ConnectionState::Recovering) {
+                             ++recoveries;
+                         }
+                     });
+    QObject::connect(&worker, &I2CWorker::connectionStateChanged,
+                     [&outages, &clock](const I2CWorker::ConnectionState state) {
+                         if (isOperational(state) && !outages.empty() && outages.back().endMs > 0 &&
+                             outages.back().recoveredMs < 0) {
+                             outages.back().recoveredMs = clock.nowMs();
+                         }
+                     });
+
+    ClockTimer healthcheck;
+    healthcheck.setInterval(HEALTHCHECK_INTERVAL_MS);
+    QObject::connect(&healthcheck, &ClockTimer::timeout, &worker, &I2CWorker::sendHealthCheck);
+    healthcheck.start();
+
+    ClockTimer presses;
+    presses.setInterval(pressEveryMs);
+    QObject::connect(&presses, &ClockTimer::timeout, [&]() {
+        if (sim.isPowered()) {
+            sim.pressButton(static_cast<uint8_t>(pressesSent % 2), DEVICE_ADDRESS);
+            ++pressesSent;
+        }
+    });
+    presses.start();
+
+    ClockTimer powerCuts;
+    powerCuts.setInterval(outageEveryMs);
+    QObject::connect(&powerCuts, &ClockTimer::timeout, [&]() {
+        // Presses the worker has not fetched yet die with the board
+        pressesLost += pressesSent - pressesReceived - pressesLost;
+        sim.setPowered(false);
+        outages.push_back({clock.nowMs(), 0, -1});
+
+        ClockTimer::singleShot(outageLengthMs, &powerCuts, [&]() {
+            if (outages.back().endMs == 0) {
+                sim.setPowered(true);
+                outages.back().endMs = clock.nowMs();
+            }
+        });
+    });
+    if (outageEveryMs > 0) {
+        powerCuts.start();
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+
+    worker.openDevice(DEVICE_ADDRESS);
+
+    const int64_t startMs = clock.nowMs();
+    const auto run = [&clock](const int64_t untilMs) {
+        while (clock.nowMs() < untilMs) {
+            const auto next = clock.nextDueNs();
+            if (!next || *next / 1'000'000 > untilMs) {
+                clock.advance(untilMs - clock.nowMs());
+                break;
+            }
+            clock.advanceToNext();
+            QCoreApplication::processEvents();
+        }
+        QCoreApplication::processEvents();
+    };
+
+    run(startMs + durationMs);
+    presses.stop();
+    powerCuts.stop();
+    if (!outages.empty() && outages.back().endMs == 0) {
+        outages.back().endMs = clock.nowMs(); // Cut short
+    }
+    sim.setPowered(true);
+    run(clock.nowMs() + DRAIN_MS);
+
+    const double wallSeconds = static_cast<double>(wall.elapsed()) / 1000.0;
+    const double virtualSeconds = static_cast<double>(clock.nowMs() - startMs) / 1000.0;
+
+    std::printf("Virtual time:       %.1f h in %.1f s wall (%.0fx)\n",
+                virtualSeconds / 3600.0, wallSeconds, wallSeconds > 0 ? virtualSeconds / wallSeconds : 0.0);
+    // A dropped or corrupt poll reply takes its events with it, as on the bus
+    std::printf("Presses:            %llu sent, %llu received, %llu lost to power cuts, %llu to bus errors\n",
+                static_cast<unsigned long long>(pressesSent),
+                static_cast<unsigned long long>(pressesReceived),
+                static_cast<unsigned long long>(pressesLost),
+                static_cast<unsigned long long>(pressesSent - std::min(pressesSent, pressesReceived + pressesLost)));
+    std::printf("INIT handshakes:    %llu\n", static_cast<unsigned long long>(sim.initCount()));
+    std::printf("Recovery attempts:  %llu\n", static_cast<unsigned long long>(recoveries));
+
+    int64_t worstMs = 0;
+    int64_t totalMs = 0;
+    int unrecovered = 0;
+    for (const Outage &outage: outages) {
+        if (outage.recoveredMs < 0) {
+            ++unrecovered;
+            continue;
+        }
+        const int64_t recoveryMs = outage.recoveredMs - outage.endMs;
+        worstMs = std::max(worstMs, recoveryMs);
+        totalMs += recoveryMs;
+    }
+    const auto recovered = static_cast<int64_t>(outages.size()) - unrecovered;
+    std::printf("Power cuts:         %zu, %d not recovered\n", outages.size(), unrecovered);
+    if (recovered > 0) {
+        std::printf("Power back to link: mean %lld ms, worst %lld ms\n",
+                    static_cast<long long>(totalMs / recovered), static_cast<long long>(worstMs));
+    }
+
+    const bool linkUp = isOperational(worker.connectionState());
+    std::printf("Link at end:        %s\n", qPrintable(I2CWorker::connectionStateToString(worker.connectionState())));
+
+    worker.cleanup();
+    return linkUp && unrecovered == 0 ? 0 : 1;
+}
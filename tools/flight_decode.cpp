@@ -0,0 +1,212 @@
+// Decoder for the crash flight recorder (flight.ring in the app data
+// directory, written by FlightRecorder; flight-<timestamp>.ring is the
+// copy kept from a session that did not shut down cleanly).
+//
+// Usage: flight_decode <flight.ring> [--bus i2c_bus.ring] [--all] [--last N]
+//
+// Prints the last session, or every session with --all, one event per line
+// with its time offset and kernel thread id. --bus interleaves the I2C
+// frames captured during the same time span. A crash is followed by its
+// backtrace; frames inside the executable are also shown as offsets for
+// addr2line, which works on the unstripped binary from the same build.
+
+#include "FlightRecorder.h"
+#include "I2CBusRecorder.h"
+#include "I2CTelemetry.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    using Event = FlightRecorder::Event;
+    using Type = FlightRecorder::Type;
+    using Frame = I2CBusRecorder::Frame;
+
+    struct Executable {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        QString name;
+    };
+
+    QString hex(const std::span<const uint8_t> bytes) {
+        QString result;
+        for (const uint8_t byte: bytes) {
+            if (!result.isEmpty()) {
+                result += ' ';
+            }
+            result += QString("%1").arg(byte, 2, 16, QChar('0')).toUpper();
+        }
+        return result;
+    }
+
+    QString describe(const Event &event) {
+        switch (event.type) {
+            case Type::SessionStart:
+                return QString("%1, pid %2").arg(event.label()).arg(event.thread);
+            case Type::SessionEnd:
+                return "clean shutdown";
+            case Type::Crash:
+                return QString("%1 (signal %2) at 0x%3")
+                        .arg(event.label()).arg(event.code).arg(static_cast<uint64_t>(event.first()), 0, 16);
+            case Type::Power:
+                return event.code ? "on" : "off";
+            case Type::LinkState:
+                return QString("0x%1 -> %2").arg(event.first(), 2, 16, QChar('0')).arg(event.label());
+            case Type::Button:
+                return QString("button %1%2").arg(event.code).arg(event.first() ? "" : " (powered off)");
+            case Type::Money:
+                return QString("%1 %2, balance %3")
+                        .arg(FlightRecorder::moneyKindName(static_cast<FlightRecorder::MoneyKind>(event.code)))
+                        .arg(event.firstAmount(), 0, 'f', 2)
+                        .arg(event.secondAmount(), 0, 'f', 2);
+            case Type::SpinResult:
+                return event.label();
+            case Type::Risk:
+                return QString("%1, level %2, prize %3")
+                        .arg(FlightRecorder::riskOutcomeName(static_cast<FlightRecorder::RiskOutcome>(event.code)))
+                        .arg(event.first())
+                        .arg(event.secondAmount(), 0, 'f', 2);
+            case Type::SerialCommand:
+                return event.label().isEmpty() ? QString("command %1").arg(event.code) : event.label();
+            default:
+                return QString("code %1").arg(event.code);
+        }
+    }
+
+    void printBacktrace(const Event &event, const Executable &executable, std::vector<uint64_t> &offsets) {
+        for (std::size_t i = 0; i < FlightRecorder::FRAMES_PER_RECORD; ++i) {
+            const uint64_t address = event.words[i];
+            if (address == 0) {
+                continue;
+            }
+
+            const bool inExecutable = address >= executable.start && address < executable.end;
+            if (inExecutable) {
+                offsets.push_back(address - executable.start);
+            }
+            std::printf("%28s#%-3zu 0x%016llx%s\n", "", event.code + i,
+                        static_cast<unsigned long long>(address),
+                        inExecutable
+                            ? QString("  %1+0x%2").arg(executable.name)
+                                .arg(address - executable.start, 0, 16).toUtf8().constData()
+                            : "");
+        }
+    }
+
+    void printFrame(const Frame &frame, const uint64_t origin) {
+        std::printf("%12.3f ms  %-8s  %-13s %s 0x%02x %s #%d %s %s\n",
+                    static_cast<double>(frame.timestampNs - origin) / 1e6, "",
+                    "i2c",
+                    frame.direction == I2CBusRecorder::Direction::Tx ? "TX" : "RX",
+                    frame.address,
+                    qPrintable(I2CTelemetry::opcodeName(frame.command)),
+                    frame.attempt + 1,
+                    qPrintable(I2CBusRecorder::outcomeName(frame.outcome)),
+                    qPrintable(hex(frame.bytes())));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode a crash flight record");
+    parser.addHelpOption();
+    parser.addPositionalArgument("record", "Flight record (flight.ring or flight-<timestamp>.ring).");
+    const QCommandLineOption busOption("bus", "Interleave frames from this I2C bus capture.", "capture");
+    const QCommandLineOption allOption("all", "Every session still in the ring, not just the last.");
+    const QCommandLineOption lastOption("last", "Only the newest N events.", "n");
+    parser.addOptions({busOption, allOption, lastOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(2);
+    }
+
+    std::vector<Event> events;
+    QString error;
+    if (!FlightRecorder::load(parser.positionalArguments().first(), events, error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 2;
+    }
+    if (events.empty()) {
+        std::printf("Flight record is empty\n");
+        return 0;
+    }
+
+    std::size_t first = 0;
+    if (!parser.isSet(allOption)) {
+        for (std::size_t i = events.size(); i-- > 0;) {
+            if (events[i].type == Type::SessionStart) {
+                first = i;
+                break;
+            }
+        }
+    }
+    if (parser.isSet(lastOption)) {
+        const auto last = parser.value(lastOption).toULongLong();
+        first = std::max<std::size_t>(first, last < events.size() ? events.size() - last : 0);
+    }
+
+    // CLOCK_MONOTONIC restarts with every boot; only frames inside the
+    // shown span are taken, which also drops those from other boots
+    std::vector<Frame> frames;
+    if (parser.isSet(busOption)) {
+        if (!I2CBusRecorder::load(parser.value(busOption), frames, error)) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        const uint64_t from = events[first].timestampNs;
+        const uint64_t to = events.back().timestampNs;
+        std::erase_if(frames, [from, to](const Frame &f) { return f.timestampNs < from || f.timestampNs > to; });
+    }
+
+    Executable executable;
+    for (std::size_t i = 0; i <= first; ++i) {
+        if (events[i].type == Type::SessionStart) {
+            executable = {static_cast<uint64_t>(events[i].first()), static_cast<uint64_t>(events[i].second()),
+                          events[i].label()};
+        }
+    }
+
+    const uint64_t origin = events[first].timestampNs;
+    std::vector<uint64_t> offsets;
+    bool crashed = false;
+    std::size_t frame = 0;
+    for (std::size_t i = first; i < events.size(); ++i) {
+        const Event &event = events[i];
+        for (; frame < frames.size() && frames[frame].timestampNs <= event.timestampNs; ++frame) {
+            printFrame(frames[frame], origin);
+        }
+
+        if (event.type == Type::SessionStart) {
+            executable = {static_cast<uint64_t>(event.first()), static_cast<uint64_t>(event.second()), event.label()};
+        }
+        if (event.type == Type::Backtrace) {
+            printBacktrace(event, executable, offsets);
+            continue;
+        }
+        crashed = crashed || event.type == Type::Crash;
+
+        std::printf("%12.3f ms  %-8u  %-13s %s\n",
+                    static_cast<double>(event.timestampNs - origin) / 1e6,
+                    event.thread,
+                    qPrintable(FlightRecorder::typeName(event.type)),
+                    qPrintable(describe(event)));
+    }
+    for (; frame < frames.size(); ++frame) {
+        printFrame(frames[frame], origin);
+    }
+
+    if (crashed && !offsets.empty()) {
+        QString command = QString("addr2line -Cfpe %1").arg(executable.name);
+        for (const uint64_t offset: offsets) {
+            command += QString(" 0x%1").arg(offset, 0, 16);
+        }
+        std::printf("\nResolve with:\n  %s\n", qPrintable(command));
+    }
+    return crashed ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+// Throughput and latency benchmark for the I2C protocol path.
+//
+// Drives a real I2CWorker against SimulatedArduino and sweeps payload size,
+// injected error rate, command mix and the number of boards on the bus. For every scenario it reports
+// transactions/s, latency percentiles, retry amplification (frames on the
+// bus per logical operation) and how long m_i2c_mutex was held.
+//
+// Usage: i2c_bench [--ops N] [--latency MS] [--jitter MS] [--seed N]
+//                  [--output results.json]
+//
+// --latency defaults to 0 so the numbers reflect host-side overhead; pass
+// the cabinet's real response window to model end-to-end behaviour (the
+// board sweep only shows the benefit of pipelined polls with a latency).
+
+#include "I2CWorker.h"
+#include "SimulatedArduino.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    constexpr uint8_t DEVICE_ADDRESS = 0x42;
+    constexpr int READY_TIMEOUT_MS = 30000;
+
+    struct Options {
+        int ops = 2000;
+        int latencyMs = 0;
+        int jitterMs = 0;
+        uint32_t seed = 1;
+    };
+
+    struct Scenario {
+        QString sweep;     // "payload", "errors", "mix" or "boards"
+        QString mix;       // poll, tower, button, balance, name, mixed
+        int payloadSize;   // Only used by the "name" mix
+        double errorRate;  // Split evenly between dropped and corrupted replies
+        int boards = 1;
+    };
+
+    struct Result {
+        Scenario scenario;
+        bool ok = false;
+        int operations = 0;
+        double seconds = 0.0;
+        double opsPerSecond = 0.0;
+        double p50Us = 0.0;
+        double p90Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        uint64_t transactions = 0;
+        uint64_t attempts = 0;
+        uint64_t failures = 0;
+        uint64_t frames = 0;
+        double retryAmplification = 0.0;
+        double meanLockHoldUs = 0.0;
+        double maxLockHoldUs = 0.0;
+        int recoveries = 0;
+    };
+
+    // One button and one tower per board, display on the first
+    I2CDeviceMap deviceMap(const int boards) {
+        QJsonArray devices;
+        for (int n = 0; n < boards; ++n) {
+            devices.append(QJsonObject{
+                {"name", QString("board%1").arg(n)},
+                {"address", DEVICE_ADDRESS + n},
+                {"buttons", QJsonArray{n}},
+                {"towers", QJsonArray{n}},
+                {"display", n == 0}
+            });
+        }
+
+        I2CDeviceMap map = I2CDeviceMap::singleDevice(DEVICE_ADDRESS);
+        QString error;
+        I2CDeviceMap::fromJson(QJsonDocument(QJsonObject{{"devices", devices}}).toJson(), map, error);
+        return map;
+    }
+
+    bool isOperational(const I2CWorker &worker) {
+        const auto state = worker.connectionState();
+        return state == I2CWorker::ConnectionState::Ready ||
+               state == I2CWorker::ConnectionState::Degraded;
+    }
+
+    // Spins the event loop until the worker's state machine reaches Ready.
+    // Polling is stopped afterwards so only the benchmark drives the bus.
+    bool waitForReady(I2CWorker &worker, const int timeoutMs) {
+        if (!isOperational(worker)) {
+            QEventLoop loop;
+            QTimer timeout;
+            timeout.setSingleShot(true);
+            QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+            QObject::connect(&worker, &I2CWorker::connectionStateChanged, &loop,
+                             [&loop, &worker](I2CWorker::ConnectionState) {
+                                 if (isOperational(worker)) {
+                                     loop.quit();
+                                 }
+                             });
+            timeout.start(timeoutMs);
+            loop.exec();
+        }
+
+        worker.stopPolling();
+        return isOperational(worker);
+    }
+
+    double percentile(const std::vector<double> &sorted, const double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    // One logical operation. Output values change on every call so the
+    // device shadow never suppresses the transaction.
+    void runOperation(I2CWorker &worker, SimulatedArduino &sim, const QString &mix,
+                      const int i, const QString (&names)[2], const int boards) {
+        if (mix == "poll") {
+            if (i % 4 == 0 && boards > 1) {
+                sim.pressButton(0, static_cast<uint8_t>(DEVICE_ADDRESS + (i / 4) % boards));
+            } else if (i % 4 == 0) {
+                sim.pressButton(static_cast<uint8_t>(i % 8));
+            }
+            worker.pollButtonEvents();
+        } else if (mix == "tower") {
+            worker.highlightTower(static_cast<uint8_t>(i % 5), static_cast<uint8_t>((i / 5) % 6));
+        } else if (mix == "button") {
+            worker.highlightButton(static_cast<uint8_t>(i % 2), (i / 2) % 2 != 0);
+        } else if (mix == "balance") {
+            worker.updateUserBalance((i + 1) * 0.01);
+        } else if (mix == "name") {
+            worker.updateUserName(names[i % 2]);
+        } else {
+            // Roughly what a spinning cabinet sends: mostly polls, some output
+            switch (i % 20) {
+                case 0: case 5: case 10:
+                    worker.highlightTower(static_cast<uint8_t>((i / 5) % 5), static_cast<uint8_t>((i / 20) % 6));
+                    break;
+                case 3: case 13:
+                    worker.highlightButton(static_cast<uint8_t>((i / 10) % 2), (i / 20) % 2 != 0);
+                    break;
+                case 7: case 17: case 19:
+                    worker.updateUserBalance((i + 1) * 0.01);
+                    break;
+                default:
+                    if (i % 8 == 0) {
+                        sim.pressButton(static_cast<uint8_t>(i % 8));
+                    }
+                    worker.pollButtonEvents();
+                    break;
+            }
+        }
+    }
+
+    Result runScenario(const Scenario &scenario, const Options &options) {
+        Result result;
+        result.scenario = scenario;
+
+        SimulatedArduino::Config config;
+        config.latencyMs = options.latencyMs;
+        config.jitterMs = options.jitterMs;
+        config.dropRate = scenario.errorRate / 2.0;
+        config.corruptRate = scenario.errorRate / 2.0;
+        config.seed = options.seed;
+
+        auto transport = std::make_unique<SimulatedArduino>(config);
+        SimulatedArduino &sim = *transport;
+
+        I2CWorker worker;
+        worker.setTransport(std::move(transport));
+        worker.initialize();
+        if (scenario.boards > 1) {
+            worker.setDeviceMap(deviceMap(scenario.boards));
+            worker.openDevices();
+        } else {
+            worker.openDevice(DEVICE_ADDRESS);
+        }
+        if (!waitForReady(worker, READY_TIMEOUT_MS)) {
+            return result;
+        }
+
+        const QString names[2] = {
+            QString(scenario.payloadSize, QChar('A')),
+            QString(scenario.payloadSize, QChar('B'))
+        };
+
+        std::vector<double> latenciesUs;
+        latenciesUs.reserve(static_cast<std::size_t>(options.ops));
+
+        const I2CWorker::BusStatistics before = worker.busStatistics();
+        const uint64_t framesBefore = sim.framesReceived();
+        double busySeconds = 0.0;
+
+        for (int i = 0; i < options.ops; ++i) {
+            if (!isOperational(worker)) {
+                // Too many failures in a row; time spent in backoff is not
+                // protocol latency, so it stays out of the numbers
+                ++result.recoveries;
+                if (!waitForReady(worker, READY_TIMEOUT_MS)) {
+                    return result;
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            runOperation(worker, sim, scenario.mix, i, names, scenario.boards);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            busySeconds += elapsed.count();
+            latenciesUs.push_back(elapsed.count() * 1e6);
+        }
+
+        const I2CWorker::BusStatistics after = worker.busStatistics();
+        worker.cleanup();
+
+        std::ranges::sort(latenciesUs);
+
+        result.ok = true;
+        result.operations = options.ops;
+        result.seconds = busySeconds;
+        result.opsPerSecond = busySeconds > 0.0 ? options.ops / busySeconds : 0.0;
+        result.p50Us = percentile(latenciesUs, 0.50);
+        result.p90Us = percentile(latenciesUs, 0.90);
+        result.p99Us = percentile(latenciesUs, 0.99);
+        result.maxUs = latenciesUs.empty() ? 0.0 : latenciesUs.back();
+        result.transactions = after.transactions - before.transactions;
+        result.attempts = after.attempts - before.attempts;
+        result.failures = after.failures - before.failures;
+        result.frames = sim.framesReceived() - framesBefore;
+        result.retryAmplification = result.transactions > 0
+                                        ? static_cast<double>(result.attempts) / static_cast<double>(result.transactions)
+                                        : 0.0;
+
+        if (const uint64_t locks = after.lockAcquisitions - before.lockAcquisitions; locks > 0) {
+            result.meanLockHoldUs = static_cast<double>(after.lockHoldNs - before.lockHoldNs) /
+                                    static_cast<double>(locks) / 1000.0;
+        }
+        result.maxLockHoldUs = static_cast<double>(after.maxLockHoldNs) / 1000.0;
+        return result;
+    }
+
+    std::vector<Scenario> buildScenarios() {
+        std::vector<Scenario> scenarios;
+
+        for (const int size: {1, 16, 64, 128, 255}) {
+            scenarios.push_back({"payload", "name", size, 0.0});
+        }
+        for (const double rate: {0.0, 0.01, 0.05, 0.10, 0.20}) {
+            scenarios.push_back({"errors", "mixed", 0, rate});
+        }
+        for (const char *mix: {"poll", "tower", "button", "balance", "mixed"}) {
+            scenarios.push_back({"mix", mix, 0, 0.0});
+        }
+        for (const int boards: {1, 2, 4, 8}) {
+            scenarios.push_back({"boards", "poll", 0, 0.0, boards});
+        }
+        return scenarios;
+    }
+
+    QJsonObject toJson(const Result &r) {
+        return {
+            {"sweep", r.scenario.sweep},
+            {"mix", r.scenario.mix},
+            {"payload_bytes", r.scenario.payloadSize},
+            {"error_rate", r.scenario.errorRate},
+            {"boards", r.scenario.boards},
+            {"ok", r.ok},
+            {"operations", r.operations},
+            {"seconds", r.seconds},
+            {"ops_per_second", r.opsPerSecond},
+            {"latency_us", QJsonObject{
+                {"p50", r.p50Us},
+                {"p90", r.p90Us},
+                {"p99", r.p99Us},
+                {"max", r.maxUs}
+            }},
+            {"transactions", static_cast<qint64>(r.transactions)},
+            {"attempts", static_cast<qint64>(r.attempts)},
+            {"failures", static_cast<qint64>(r.failures)},
+            {"frames_on_bus", static_cast<qint64>(r.frames)},
+            {"retry_amplification", r.retryAmplification},
+            {"lock_hold_us", QJsonObject{
+                {"mean", r.meanLockHoldUs},
+                {"max", r.maxLockHoldUs}
+            }},
+            {"recoveries", r.recoveries}
+        };
+    }
+
+    // The worker logs every transaction; keep the console for the results
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message) {
+        if (type == QtCriticalMsg || type == QtFatalMsg) {
+            std::fprintf(stderr, "%s\n", qPrintable(message));
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AllesSpitzeI2CBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("I2C protocol throughput and latency benchmark");
+    parser.addHelpOption();
+    const QCommandLineOption opsOption("ops", "Operations per scenario.", "n", "2000");
+    const QCommandLineOption latencyOption("latency", "Simulated response latency.", "ms", "0");
+    const QCommandLineOption jitterOption("jitter", "Simulated response jitter.", "ms", "0");
+    const QCommandLineOption seedOption("seed", "Fault injection seed.", "n", "1");
+    const QCommandLineOption outputOption("output", "Write results as JSON.", "file");
+    parser.addOptions({opsOption, latencyOption, jitterOption, seedOption, outputOption});
+    parser.process(app);
+
+    Options options;
+    options.ops = std::max(1, parser.value(opsOption).toInt());
+    options.latencyMs = std::max(0, parser.value(latencyOption).toInt());
+    options.jitterMs = std::max(0, parser.value(jitterOption).toInt());
+    options.seed = parser.value(seedOption).toUInt();
+
+    qInstallMessageHandler(quietMessageHandler);
+
+    std::printf("%-8s %-8s %5s %3s %6s %10s %9s %9s %9s %7s %9s %9s\n",
+                "sweep", "mix", "bytes", "brd", "err", "ops/s", "p50 us", "p99 us", "max us",
+                "ampl", "lock us", "lock max");
+
+    QJsonArray results;
+    bool allOk = true;
+
+    for (const Scenario &scenario: buildScenarios()) {
+        const Result r = runScenario(scenario, options);
+        allOk = allOk && r.ok;
+        results.append(toJson(r));
+
+        if (!r.ok) {
+            std::printf("%-8s %-8s %5d %3d %6.2f  device never became ready\n",
+                        qPrintable(scenario.sweep), qPrintable(scenario.mix),
+                        scenario.payloadSize, scenario.boards, scenario.errorRate);
+            continue;
+        }
+
+        std::printf("%-8s %-8s %5d %3d %6.2f %10.0f %9.1f %9.1f %9.1f %7.3f %9.1f %9.1f\n",
+                    qPrintable(scenario.sweep), qPrintable(scenario.mix),
+                    scenario.payloadSize, scenario.boards, scenario.errorRate, r.opsPerSecond,
+                    r.p50Us, r.p99Us, r.maxUs, r.retryAmplification,
+                    r.meanLockHoldUs, r.maxLockHoldUs);
+    }
+
+    if (parser.isSet(outputOption)) {
+        const QJsonObject root{
+            {"benchmark", "i2c_bench"},
+            {"ops_per_scenario", options.ops},
+            {"latency_ms", options.latencyMs},
+            {"jitter_ms", options.jitterMs},
+            {"seed", static_cast<qint64>(options.seed)},
+            {"results", results}
+        };
+
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(file.fileName()));
+            return 2;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// Micro-benchmark for the I2C packet codec.
+//
+// Runs the encode/receive/validate/decode cycle of a polling transaction and
+// a balance update in a tight loop and counts heap allocations by replacing
+// the global operator new. Exits non-zero if the hot path allocated.
+//
+// Usage: i2c_codec_bench [iterations]
+
+#include "I2CPacket.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+    std::atomic<std::size_t> g_allocations{0};
+
+    // Stand-in for the Arduino: turns a request into a response in the
+    // receive buffer the same way read() on /dev/i2c-1 would
+    std::size_t fakeDevice(const std::span<const uint8_t> request,
+                           const std::span<uint8_t> storage,
+                           const uint8_t pressedButtons) {
+        const uint8_t command = request[0];
+        std::array<uint8_t, 1 + 2> payload{};
+        std::size_t payloadSize = 1;
+
+        if (command == 0x03 && pressedButtons > 0) {
+            payload[0] = pressedButtons;
+            payload[1] = 0x00;
+            payload[2] = 0x01;
+            payloadSize += pressedButtons;
+        }
+
+        const I2CPacket::TxPacket response(command | 0x80, std::span(payload.data(), payloadSize));
+        std::memcpy(storage.data(), response.bytes().data(), response.size());
+        // Real reads return the whole requested length; pad with garbage
+        std::memset(storage.data() + response.size(), 0xFF, 16);
+        return response.size() + 16;
+    }
+
+    struct Result {
+        double nsPerOp;
+        std::size_t allocations;
+    };
+
+    template<typename Fn>
+    Result run(const long iterations, Fn &&fn) {
+        const std::size_t allocsBefore = g_allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (long i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return {
+            std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations),
+            g_allocations.load() - allocsBefore
+        };
+    }
+}
+
+void *operator new(const std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+int main(const int argc, char *argv[]) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 5'000'000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    I2CPacket::RxBuffer rx;
+    volatile uint32_t sink = 0;
+
+    const Result poll = run(iterations, [&](const long i) {
+        const I2CPacket::TxPacket request(0x03, {});
+        const std::size_t n = fakeDevice(request.bytes(), rx.storage(), (i & 63) == 0 ? 2 : 0);
+        const I2CPacket::ResponseView response = rx.commit(n);
+
+        if (response.isComplete() && response.checksumValid() && response.command() == 0x83) {
+            const auto ids = response.payload().subspan(1);
+            for (std::size_t k = 0; k < response.status() && k < ids.size(); ++k) {
+                sink = sink + ids[k];
+            }
+        }
+    });
+
+    const Result balance = run(iterations, [&](const long i) {
+        const auto payload = I2CPacket::encodeInt32(static_cast<int32_t>(i));
+        const I2CPacket::TxPacket request(0x07, payload);
+        const std::size_t n = fakeDevice(request.bytes(), rx.storage(), 0);
+        const I2CPacket::ResponseView response = rx.commit(n);
+        sink = sink + (response.checksumValid() ? response.status() : 1);
+    });
+
+    std::printf("%-24s %10s %12s\n", "case", "ns/op", "allocations");
+    std::printf("%-24s %10.1f %12zu\n", "poll_button_events", poll.nsPerOp, poll.allocations);
+    std::printf("%-24s %10.1f %12zu\n", "update_user_balance", balance.nsPerOp, balance.allocations);
+    std::printf("iterations: %ld\n", iterations);
+
+    if (poll.allocations != 0 || balance.allocations != 0) {
+        std::fprintf(stderr, "FAIL: codec hot path allocated on the heap\n");
+        return 1;
+    }
+
+    return 0;
+}
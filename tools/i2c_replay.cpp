@@ -0,0 +1,287 @@
+// Decoder and replayer for I2C bus captures (i2c_bus.ring in the app data
+// directory, written by I2CBusRecorder).
+//
+// Usage: i2c_replay <capture> [--last N] [--summary]
+//        i2c_replay <capture> --replay [--speed X] [--sim latency=0,...]
+//
+// Without --replay every frame is printed with its time offset, direction,
+// address, attempt, outcome and bytes. --replay writes the captured TX frames to a
+// SimulatedArduino with the original spacing divided by --speed, reads each
+// reply at the captured RX time and reports where the simulator's answer
+// diverges from what the cabinet saw. Button presses seen in captured poll
+// replies are fed to the simulator first so polls replay deterministically.
+
+#include "I2CBusRecorder.h"
+#include "I2CWorker.h"
+#include "SimulatedArduino.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Frame = I2CBusRecorder::Frame;
+    using Outcome = I2CBusRecorder::Outcome;
+    using Direction = I2CBusRecorder::Direction;
+
+    QString hex(const std::span<const uint8_t> bytes) {
+        QString result;
+        for (const uint8_t byte: bytes) {
+            if (!result.isEmpty()) {
+                result += ' ';
+            }
+            result += QString("%1").arg(byte, 2, 16, QChar('0')).toUpper();
+        }
+        return result;
+    }
+
+    void printFrames(const std::vector<Frame> &frames, const std::size_t first) {
+        const uint64_t origin = frames.empty() ? 0 : frames[first].timestampNs;
+
+        for (std::size_t i = first; i < frames.size(); ++i) {
+            const Frame &f = frames[i];
+            std::printf("%12.3f ms  %s  0x%02x  %-15s #%d  %-12s %s%s\n",
+                        static_cast<double>(f.timestampNs - origin) / 1e6,
+                        f.direction == Direction::Tx ? "TX" : "RX",
+                        f.address,
+                        qPrintable(I2CTelemetry::opcodeName(f.command)),
+                        f.attempt + 1,
+                        qPrintable(I2CBusRecorder::outcomeName(f.outcome)),
+                        qPrintable(hex(f.bytes())),
+                        f.truncated() ? QString(" ... (%1 bytes)").arg(f.length).toUtf8().constData() : "");
+        }
+    }
+
+    void printSummary(const std::vector<Frame> &frames) {
+        std::map<std::pair<uint8_t, uint8_t>, uint64_t> counts;
+        for (const Frame &f: frames) {
+            counts[{f.command, static_cast<uint8_t>(f.outcome)}]++;
+        }
+
+        if (!frames.empty()) {
+            std::printf("%zu frames over %.3f s\n", frames.size(),
+                        static_cast<double>(frames.back().timestampNs - frames.front().timestampNs) / 1e9);
+        }
+        for (const auto &[key, count]: counts) {
+            std::printf("  %-15s %-12s %8llu\n",
+                        qPrintable(I2CTelemetry::opcodeName(key.first)),
+                        qPrintable(I2CBusRecorder::outcomeName(static_cast<Outcome>(key.second))),
+                        static_cast<unsigned long long>(count));
+        }
+    }
+
+    Outcome classify(const std::span<const uint8_t> reply, const uint8_t command) {
+        const I2CPacket::ResponseView view(reply);
+        if (!view.isComplete()) {
+            return Outcome::NoResponse;
+        }
+        if (!view.checksumValid()) {
+            return Outcome::ChecksumFailure;
+        }
+        if (view.command() != (command | 0x80)) {
+            return Outcome::Mismatch;
+        }
+        return Outcome::Ok;
+    }
+
+    // The captured RX that answered frames[txIndex], if any. Polls to several
+    // boards are pipelined, so the reply need not be the next frame; it is
+    // the first RX from the same board before that board is written again.
+    const Frame *replyFor(const std::vector<Frame> &frames, const std::size_t txIndex) {
+        const Frame &tx = frames[txIndex];
+        for (std::size_t i = txIndex + 1; i < frames.size(); ++i) {
+            const Frame &next = frames[i];
+            if (next.address != tx.address) {
+                continue;
+            }
+            if (next.direction == Direction::Rx && next.command == tx.command && next.attempt == tx.attempt) {
+                return &next;
+            }
+            break;
+        }
+        return nullptr;
+    }
+
+    struct PendingReply {
+        const Frame *tx;
+        const Frame *rx;
+    };
+
+    PendingReply *nextDue(std::vector<PendingReply> &pending) {
+        const auto it = std::ranges::min_element(pending, {}, [](const PendingReply &p) {
+            return p.rx->timestampNs;
+        });
+        return it != pending.end() ? &*it : nullptr;
+    }
+
+    int replay(const std::vector<Frame> &frames, const std::size_t first,
+               const double speed, const SimulatedArduino::Config &config) {
+        SimulatedArduino sim(config);
+        QString error;
+        if (!sim.open(frames[first].address ? frames[first].address : 0x42, error)) {
+            std::fprintf(stderr, "Cannot open simulator: %s\n", qPrintable(error));
+            return 2;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const uint64_t origin = frames[first].timestampNs;
+        const Clock::time_point start = Clock::now();
+        const auto waitUntil = [&](const uint64_t timestampNs) {
+            const auto offset = std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(timestampNs - origin) / speed));
+            std::this_thread::sleep_until(start + offset);
+        };
+
+        uint64_t replayed = 0;
+        uint64_t skipped = 0;
+        uint64_t diverged = 0;
+        std::array<uint8_t, I2CPacket::MAX_PACKET_SIZE> reply{};
+
+        // Replies not yet read, in capture order of their RX frame
+        std::vector<PendingReply> pending;
+
+        const auto readReply = [&](const PendingReply &p) {
+            const Frame &tx = *p.tx;
+            const Frame &rx = *p.rx;
+
+            waitUntil(rx.timestampNs);
+            sim.selectAddress(rx.address, error);
+            const ssize_t n = sim.read(reply);
+            const std::span<const uint8_t> got(reply.data(), n > 0 ? static_cast<std::size_t>(n) : 0);
+            const Outcome outcome = classify(got, tx.command);
+
+            const bool sameBytes = rx.outcome != Outcome::Ok ||
+                                   std::ranges::equal(got.first(std::min(got.size(), std::size_t{rx.captured})),
+                                                      rx.bytes());
+            if (outcome != rx.outcome || !sameBytes) {
+                ++diverged;
+                std::printf("%12.3f ms  0x%02x  %-15s #%d  captured %-12s [%s]  simulated %-12s [%s]\n",
+                            static_cast<double>(rx.timestampNs - origin) / 1e6,
+                            rx.address,
+                            qPrintable(I2CTelemetry::opcodeName(tx.command)),
+                            tx.attempt + 1,
+                            qPrintable(I2CBusRecorder::outcomeName(rx.outcome)),
+                            qPrintable(hex(rx.bytes())),
+                            qPrintable(I2CBusRecorder::outcomeName(outcome)),
+                            qPrintable(hex(got)));
+            }
+        };
+
+        const auto drainBefore = [&](const uint64_t timestampNs) {
+            while (PendingReply *due = nextDue(pending)) {
+                if (due->rx->timestampNs > timestampNs) {
+                    break;
+                }
+                const PendingReply p = *due;
+                pending.erase(pending.begin() + (due - pending.data()));
+                readReply(p);
+            }
+        };
+
+        for (std::size_t i = first; i < frames.size(); ++i) {
+            const Frame &tx = frames[i];
+            if (tx.direction != Direction::Tx || tx.outcome != Outcome::Sent) {
+                continue;
+            }
+            if (tx.truncated()) {
+                ++skipped;
+                continue;
+            }
+
+            drainBefore(tx.timestampNs);
+
+            const Frame *rx = replyFor(frames, i);
+
+            // Recreate the presses the cabinet reported in this poll
+            if (rx && rx->outcome == Outcome::Ok && tx.command == I2CWorker::CMD_POLL_BUTTON_EVENTS &&
+                rx->captured > 3) {
+                const uint8_t count = rx->data[2];
+                for (uint8_t n = 0; n < count && 3u + n < rx->captured; ++n) {
+                    sim.pressButton(rx->data[3 + n], tx.address);
+                }
+            }
+
+            waitUntil(tx.timestampNs);
+            sim.selectAddress(tx.address, error);
+            sim.write(tx.bytes());
+            ++replayed;
+
+            if (rx) {
+                pending.push_back({&tx, rx});
+            }
+        }
+        drainBefore(UINT64_MAX);
+
+        std::printf("Replayed %llu frames at %.1fx, %llu diverged, %llu skipped (truncated)\n",
+                    static_cast<unsigned long long>(replayed), speed,
+                    static_cast<unsigned long long>(diverged),
+                    static_cast<unsigned long long>(skipped));
+        return diverged == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode or replay an I2C bus capture");
+    parser.addHelpOption();
+    parser.addPositionalArgument("capture", "Capture file (i2c_bus.ring).");
+    const QCommandLineOption lastOption("last", "Only the newest N frames.", "n");
+    const QCommandLineOption summaryOption("summary", "Frame counts per opcode and outcome.");
+    const QCommandLineOption replayOption("replay", "Replay TX frames against the simulator.");
+    const QCommandLineOption speedOption("speed", "Replay speed factor.", "x", "1");
+    const QCommandLineOption simOption("sim", "Simulator options (see SimulatedArduino::Config).",
+                                       "spec", "latency=0");
+    parser.addOptions({lastOption, summaryOption, replayOption, speedOption, simOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(2);
+    }
+
+    std::vector<Frame> frames;
+    QString error;
+    if (!I2CBusRecorder::load(parser.positionalArguments().first(), frames, error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 2;
+    }
+    if (frames.empty()) {
+        std::printf("Capture is empty\n");
+        return 0;
+    }
+
+    std::size_t first = 0;
+    if (parser.isSet(lastOption)) {
+        const auto last = parser.value(lastOption).toULongLong();
+        first = last < frames.size() ? frames.size() - last : 0;
+    }
+
+    if (parser.isSet(replayOption)) {
+        const double speed = parser.value(speedOption).toDouble();
+        if (speed <= 0.0) {
+            std::fprintf(stderr, "--speed must be positive\n");
+            return 2;
+        }
+
+        const auto config = SimulatedArduino::Config::fromString(parser.value(simOption), error);
+        if (!error.isEmpty()) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        return replay(frames, first, speed, config);
+    }
+
+    if (parser.isSet(summaryOption)) {
+        printSummary(frames);
+    } else {
+        printFrames(frames, first);
+    }
+    return 0;
+}
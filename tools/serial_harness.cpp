@@ -0,0 +1,858 @@
+// End-to-end harness for the serial command path.
+//
+// Opens a pseudo-terminal pair and runs the real ApplicationController,
+// headless, with the I2C simulator and its serial port on the slave side.
+// Scripted command streams go in from the master side at full speed. For
+// every scenario it reports commands/s and response latency percentiles,
+// checks that each reply is the expected one, and confirms what reached the
+// game through STATUS and through the EVT records the controller publishes.
+// Exits non-zero on any mismatch.
+//
+// Usage: serial_harness [--commands N] [--timeout MS] [--output results.json]
+//
+// Balances, logs and traces go to Qt's test-mode data directory, not the
+// cabinet's.
+
+#include "ApplicationController.h"
+#include "SerialBinaryProtocol.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <optional>
+#include <poll.h>
+#include <pty.h>
+#include <string>
+#include <string_view>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+    using SteadyClock = std::chrono::steady_clock;
+    namespace Binary = SerialBinaryProtocol;
+
+    constexpr std::string_view STATUS_END = "==========================";
+    constexpr int COALESCE_INTERVAL_MS = 200;
+
+    // Binary event class numbers, as in the Subscribe mask
+    constexpr std::array<std::string_view, SerialWorker::EVENT_CLASS_COUNT> EVENT_CLASS_NAMES = {
+        "SPIN", "BALANCE", "RISK", "POWER", "I2C"
+    };
+
+    // One command on the wire and what must come back for it
+    struct Step {
+        std::string request;
+        std::string expectedReply; // Text: whole line; binary: unused
+        bool expectsBalance = false;
+        double balance = 0.0;
+    };
+
+    // An EVT line or Event frame
+    struct Event {
+        uint64_t seq = 0;
+        std::string eventClass;
+        std::string fields;
+    };
+
+    struct DecodedFrame {
+        uint8_t type = 0;
+        uint16_t requestId = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    struct Result {
+        QString name;
+        bool ok = true;
+        int commands = 0;
+        double seconds = 0.0;
+        double commandsPerSecond = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        QString error;
+    };
+
+    double percentile(const std::vector<double> &sorted, const double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    // unit is one delimited frame, delimiter included
+    std::optional<DecodedFrame> decodeFrame(const std::string &unit) {
+        std::optional<DecodedFrame> result;
+        Binary::FrameDecoder decoder;
+        const std::vector<uint8_t> bytes(unit.begin(), unit.end());
+        decoder.feed(bytes, [&](const Binary::Frame &frame) {
+            result = DecodedFrame{frame.type, frame.requestId, {frame.payload.begin(), frame.payload.end()}};
+            return true;
+        }, [] {});
+        return result;
+    }
+
+    std::string binaryFrame(const Binary::Type type, const uint16_t requestId,
+                            const std::span<const uint8_t> payload) {
+        const Binary::TxFrame frame(static_cast<uint8_t>(type), requestId, payload);
+        const auto bytes = frame.bytes();
+        return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    }
+
+    // Master side of the pty: non-blocking writes interleaved with reads so
+    // a long burst can never deadlock against the controller's replies.
+    // Replies and pushed events are told apart as they arrive.
+    class Master {
+    public:
+        explicit Master(const int fd)
+            : m_fd(fd) {
+        }
+
+        // Sends every step's request (all at once when pipelined, otherwise
+        // one after the other) and collects one reply unit per step. Units
+        // are lines in text mode and frames in binary mode.
+        bool exchange(const std::vector<Step> &steps, const bool binary, const bool pipelined,
+                      const int timeoutMs, std::vector<std::string> &replies,
+                      std::vector<double> &latenciesUs) {
+            replies.clear();
+            latenciesUs.clear();
+            std::vector<SteadyClock::time_point> sentAt(steps.size());
+            const SteadyClock::time_point deadline = SteadyClock::now() + std::chrono::milliseconds(timeoutMs);
+
+            std::size_t nextStep = 0;
+            std::string pending;
+            std::vector<std::size_t> stepEnds; // Offsets into pending where a step finishes
+            std::size_t written = 0;
+
+            while (replies.size() < steps.size()) {
+                // Queue more requests: everything when pipelined, else one
+                // once the previous reply is in
+                while (nextStep < steps.size() && (pipelined || replies.size() == nextStep)) {
+                    pending += steps[nextStep].request;
+                    stepEnds.push_back(pending.size());
+                    ++nextStep;
+                    if (!pipelined) {
+                        break;
+                    }
+                }
+
+                const auto now = SteadyClock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+
+                pollfd pfd{m_fd, static_cast<short>(POLLIN | (written < pending.size() ? POLLOUT : 0)), 0};
+                const auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+                if (::poll(&pfd, 1, static_cast<int>(std::max<long long>(1, waitMs))) < 0) {
+                    return false;
+                }
+
+                if ((pfd.revents & POLLOUT) && written < pending.size()) {
+                    const ssize_t n = ::write(m_fd, pending.data() + written, pending.size() - written);
+                    if (n > 0) {
+                        const std::size_t before = written;
+                        written += static_cast<std::size_t>(n);
+                        // Latency counts from the moment the last byte of a
+                        // request went out
+                        const std::size_t firstStep = nextStep - stepEnds.size();
+                        for (std::size_t i = 0; i < stepEnds.size(); ++i) {
+                            if (stepEnds[i] > before && stepEnds[i] <= written) {
+                                sentAt[firstStep + i] = SteadyClock::now();
+                            }
+                        }
+                    }
+                }
+
+                if (pfd.revents & POLLIN) {
+                    readAvailable();
+                    collect(binary, replies, &sentAt, &latenciesUs);
+                }
+
+                if (written == pending.size() && written > 0) {
+                    // Keep offsets small; sentAt is indexed by step
+                    pending.clear();
+                    stepEnds.clear();
+                    written = 0;
+                }
+            }
+            return true;
+        }
+
+        // Sends request and collects replies up to and including the first
+        // one isLast accepts
+        bool request(const std::string &bytes, const bool binary, const int timeoutMs,
+                     const std::function<bool(const std::string &)> &isLast, std::vector<std::string> &replies) {
+            replies.clear();
+            if (!writeAll(bytes)) {
+                return false;
+            }
+            return readUntil(binary, timeoutMs, [&] { return !replies.empty() && isLast(replies.back()); }, replies);
+        }
+
+        // Reads for a while, keeping only events; replies are not expected
+        void pump(const int ms, const bool binary) {
+            std::vector<std::string> replies;
+            readUntil(binary, ms, [] { return false; }, replies);
+        }
+
+        // Waits for the welcome banner, dropping it
+        bool waitForBanner(const int timeoutMs) {
+            const SteadyClock::time_point deadline = SteadyClock::now() + std::chrono::milliseconds(timeoutMs);
+            while (SteadyClock::now() < deadline) {
+                pollfd pfd{m_fd, POLLIN, 0};
+                if (::poll(&pfd, 1, 10) > 0) {
+                    readAvailable();
+                    if (const std::size_t at = m_input.find("# Commands:"); at != std::string::npos) {
+                        if (const std::size_t end = m_input.find('\n', at); end != std::string::npos) {
+                            m_input.erase(0, end + 1);
+                            return true;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool writeAll(const std::string &bytes) {
+            std::size_t done = 0;
+            while (done < bytes.size()) {
+                pollfd pfd{m_fd, POLLOUT, 0};
+                if (::poll(&pfd, 1, 1000) <= 0) {
+                    return false;
+                }
+                const ssize_t n = ::write(m_fd, bytes.data() + done, bytes.size() - done);
+                if (n > 0) {
+                    done += static_cast<std::size_t>(n);
+                }
+            }
+            return true;
+        }
+
+        std::vector<Event> takeEvents() {
+            return std::exchange(m_events, {});
+        }
+
+    private:
+        bool readUntil(const bool binary, const int timeoutMs, const std::function<bool()> &done,
+                       std::vector<std::string> &replies) {
+            const SteadyClock::time_point deadline = SteadyClock::now() + std::chrono::milliseconds(timeoutMs);
+            collect(binary, replies, nullptr, nullptr);
+            while (!done()) {
+                const auto now = SteadyClock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+                const auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+                pollfd pfd{m_fd, POLLIN, 0};
+                if (::poll(&pfd, 1, static_cast<int>(std::max<long long>(1, waitMs))) > 0) {
+                    readAvailable();
+                    collect(binary, replies, nullptr, nullptr);
+                }
+            }
+            return true;
+        }
+
+        void readAvailable() {
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::read(m_fd, buffer, sizeof(buffer))) > 0) {
+                m_input.append(buffer, static_cast<std::size_t>(n));
+            }
+        }
+
+        void collect(const bool binary, std::vector<std::string> &replies,
+                     const std::vector<SteadyClock::time_point> *sentAt, std::vector<double> *latenciesUs) {
+            const char separator = binary ? '\0' : '\n';
+            std::size_t start = 0;
+            for (std::size_t end; (end = m_input.find(separator, start)) != std::string::npos; start = end + 1) {
+                std::string unit = m_input.substr(start, end - start);
+                if (unit.empty()) {
+                    continue; // Idle delimiters between frames
+                }
+                if (binary) {
+                    unit.push_back('\0');
+                }
+                if (takeEvent(unit, binary)) {
+                    continue;
+                }
+
+                const std::size_t index = replies.size();
+                if (sentAt && index < sentAt->size()) {
+                    latenciesUs->push_back(
+                        std::chrono::duration<double, std::micro>(SteadyClock::now() - (*sentAt)[index]).count());
+                }
+                replies.push_back(std::move(unit));
+            }
+            m_input.erase(0, start);
+        }
+
+        bool takeEvent(const std::string &unit, const bool binary) {
+            if (!binary) {
+                // EVT <seq> <CLASS> <fields>
+                if (!unit.starts_with("EVT ")) {
+                    return false;
+                }
+                const std::size_t classAt = unit.find(' ', 4);
+                const std::size_t fieldsAt = unit.find(' ', classAt + 1);
+                Event event;
+                event.seq = std::stoull(unit.substr(4, classAt - 4));
+                event.eventClass = unit.substr(classAt + 1, fieldsAt - classAt - 1);
+                event.fields = fieldsAt == std::string::npos ? std::string() : unit.substr(fieldsAt + 1);
+                m_events.push_back(std::move(event));
+                return true;
+            }
+
+            const std::optional<DecodedFrame> frame = decodeFrame(unit);
+            if (!frame || frame->type != static_cast<uint8_t>(Binary::Type::Event) || frame->payload.size() < 5) {
+                return false;
+            }
+            Event event;
+            event.seq = static_cast<uint32_t>(Binary::readInt32(std::span(frame->payload).subspan(1)));
+            event.eventClass = frame->payload[0] < EVENT_CLASS_NAMES.size()
+                                   ? std::string(EVENT_CLASS_NAMES[frame->payload[0]])
+                                   : std::string("?");
+            event.fields.assign(frame->payload.begin() + 5, frame->payload.end());
+            m_events.push_back(std::move(event));
+            return true;
+        }
+
+        int m_fd;
+        std::string m_input;
+        std::vector<Event> m_events;
+    };
+
+    std::string balanceLine(const double balance) {
+        return QString("OK: Balance set to %1").arg(balance).toStdString();
+    }
+
+    std::vector<Step> textBalanceSteps(const int count) {
+        std::vector<Step> steps;
+        for (int i = 0; i < count; ++i) {
+            const double balance = i + 0.25;
+            steps.push_back({QString("SET_BALANCE %1\n").arg(balance).toStdString(), balanceLine(balance), true, balance});
+        }
+        return steps;
+    }
+
+    // Balance updates with the rest of the command set mixed in
+    std::vector<Step> textMixedSteps(const int count) {
+        std::vector<Step> steps;
+        for (int i = 0; i < count; ++i) {
+            const double balance = i + 0.5;
+            switch (i % 5) {
+                case 0: steps.push_back({"power_on\r\n", "OK: Powering on"}); break;
+                case 1: steps.push_back({"SET_PROB {\"coin\":10,\"teufel\":5}\n", "OK: Probabilities updated"}); break;
+                case 2: steps.push_back({"BOGUS 1 2 3\n",
+                                         "ERROR: Unknown command. Available: POWER_ON, POWER_OFF, SET_BALANCE, "
+                                         "SET_PROB, STATUS, I2C_STATS, LATENCY, METRICS, SERIAL_STATS, SUBSCRIBE, "
+                                         "UNSUBSCRIBE, TRACE"});
+                    break;
+                case 3: steps.push_back({"SET_BALANCE -4\n", "ERROR: Invalid balance value"}); break;
+                default:
+                    steps.push_back({QString("  balance   %1 \n").arg(balance).toStdString(), balanceLine(balance),
+                                     true, balance});
+                    break;
+            }
+        }
+        return steps;
+    }
+
+    std::vector<Step> binaryBalanceSteps(const int count) {
+        std::vector<Step> steps;
+        for (int i = 0; i < count; ++i) {
+            const int32_t cents = i * 100 + 25;
+            std::array<uint8_t, 4> payload{};
+            Binary::writeInt32(payload, cents);
+            steps.push_back({binaryFrame(Binary::Type::SetBalance, static_cast<uint16_t>(i), payload), {},
+                             true, cents / 100.0});
+        }
+        return steps;
+    }
+
+    // Text replies must match line for line
+    bool checkTextReplies(const std::vector<Step> &steps, const std::vector<std::string> &replies, QString &error) {
+        for (std::size_t i = 0; i < steps.size(); ++i) {
+            if (replies[i] != steps[i].expectedReply) {
+                error = QString("reply %1: expected '%2', got '%3'")
+                    .arg(i).arg(QString::fromStdString(steps[i].expectedReply), QString::fromStdString(replies[i]));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Binary replies: SetBalance | 0x80, status Ok, matching request id
+    bool checkBinaryReplies(const std::vector<Step> &steps, const std::vector<std::string> &replies, QString &error) {
+        std::vector<bool> seen(steps.size(), false);
+        for (std::size_t i = 0; i < replies.size(); ++i) {
+            const std::optional<DecodedFrame> frame = decodeFrame(replies[i]);
+            const bool valid = frame &&
+                               frame->type == (static_cast<uint8_t>(Binary::Type::SetBalance) | Binary::REPLY_FLAG) &&
+                               !frame->payload.empty() &&
+                               frame->payload[0] == static_cast<uint8_t>(Binary::Status::Ok) &&
+                               frame->requestId < steps.size() && !seen[frame->requestId];
+            if (!valid) {
+                error = QString("binary reply %1 is not a fresh Ok for SetBalance").arg(i);
+                return false;
+            }
+            seen[frame->requestId] = true;
+        }
+        return true;
+    }
+
+    // Balance the controller reports, through the real STATUS path
+    std::optional<double> queryBalance(Master &master, const bool binary, const int timeoutMs) {
+        std::vector<std::string> replies;
+        if (!binary) {
+            if (!master.request("STATUS\n", false, timeoutMs,
+                                [](const std::string &line) { return line == STATUS_END; }, replies)) {
+                return std::nullopt;
+            }
+            for (const std::string &line: replies) {
+                if (line.starts_with("Balance: ")) {
+                    return QString::fromStdString(line.substr(9)).toDouble();
+                }
+            }
+            return std::nullopt;
+        }
+
+        constexpr uint16_t STATUS_REQUEST_ID = 0xFFF0;
+        const auto isStatusReply = [](const std::string &unit) {
+            const std::optional<DecodedFrame> frame = decodeFrame(unit);
+            return frame && frame->requestId == STATUS_REQUEST_ID;
+        };
+        if (!master.request(binaryFrame(Binary::Type::GetStatus, STATUS_REQUEST_ID, {}), true, timeoutMs,
+                            isStatusReply, replies)) {
+            return std::nullopt;
+        }
+        const std::optional<DecodedFrame> frame = decodeFrame(replies.back());
+        if (!frame || frame->payload.size() != 1 + Binary::STATUS_PAYLOAD_SIZE ||
+            frame->payload[0] != static_cast<uint8_t>(Binary::Status::Ok)) {
+            return std::nullopt;
+        }
+        return Binary::readInt32(std::span(frame->payload).subspan(2)) / 100.0;
+    }
+
+    std::optional<double> balanceField(const Event &event) {
+        if (event.eventClass != "BALANCE" || !event.fields.starts_with("balance=")) {
+            return std::nullopt;
+        }
+        return QString::fromStdString(event.fields.substr(8)).toDouble();
+    }
+
+    // The game must end up with the last balance sent, and the BALANCE
+    // records must follow the updates in order. Records the output queue
+    // dropped are allowed but must show up as sequence gaps.
+    bool checkGameState(const std::vector<Step> &steps, Master &master, const bool binary, const int timeoutMs,
+                        QString &error) {
+        std::vector<double> expected;
+        for (const Step &step: steps) {
+            if (step.expectsBalance) {
+                expected.push_back(step.balance);
+            }
+        }
+
+        // STATUS is answered after every earlier command was handled, and
+        // their records were queued ahead of it
+        const std::optional<double> balance = queryBalance(master, binary, timeoutMs);
+        if (!balance) {
+            error = "no STATUS report after the scenario";
+            return false;
+        }
+        if (!expected.empty() && std::abs(*balance - expected.back()) > 0.005) {
+            error = QString("game balance is %1, expected %2").arg(*balance).arg(expected.back());
+            return false;
+        }
+
+        const std::vector<Event> events = master.takeEvents();
+        std::size_t next = 0;
+        uint64_t gaps = 0;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const std::optional<double> value = balanceField(events[i]);
+            if (!value) {
+                error = QString("unexpected record %1 %2").arg(QString::fromStdString(events[i].eventClass),
+                                                                QString::fromStdString(events[i].fields));
+                return false;
+            }
+            if (i > 0) {
+                if (events[i].seq <= events[i - 1].seq) {
+                    error = "EVT sequence numbers not increasing";
+                    return false;
+                }
+                gaps += events[i].seq - events[i - 1].seq - 1;
+            }
+
+            const std::size_t skippedFrom = next;
+            while (next < expected.size() && std::abs(expected[next] - *value) > 0.005) {
+                ++next;
+            }
+            if (next == expected.size()) {
+                error = QString("BALANCE record %1 out of order or unknown").arg(*value);
+                return false;
+            }
+            if (i > 0 && next - skippedFrom > events[i].seq - events[i - 1].seq - 1) {
+                error = "BALANCE records missing without a sequence gap";
+                return false;
+            }
+            ++next;
+        }
+
+        if (events.empty() && !expected.empty()) {
+            error = "no BALANCE records";
+            return false;
+        }
+        if (gaps > 0) {
+            std::printf("  %llu BALANCE records dropped by the output queue\n", static_cast<unsigned long long>(gaps));
+        }
+        return true;
+    }
+
+    Result runScenario(const QString &name, Master &master, const std::vector<Step> &steps, const bool binary,
+                       const bool pipelined, const int timeoutMs) {
+        Result result;
+        result.name = name;
+        result.commands = static_cast<int>(steps.size());
+
+        std::vector<std::string> replies;
+        std::vector<double> latenciesUs;
+        const auto start = SteadyClock::now();
+        if (!master.exchange(steps, binary, pipelined, timeoutMs, replies, latenciesUs)) {
+            result.ok = false;
+            result.error = QString("timed out after %1 of %2 replies").arg(replies.size()).arg(steps.size());
+            return result;
+        }
+        result.seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+        result.commandsPerSecond = static_cast<double>(steps.size()) / result.seconds;
+
+        std::sort(latenciesUs.begin(), latenciesUs.end());
+        result.p50Us = percentile(latenciesUs, 0.50);
+        result.p99Us = percentile(latenciesUs, 0.99);
+        result.maxUs = latenciesUs.empty() ? 0.0 : latenciesUs.back();
+
+        result.ok = (binary ? checkBinaryReplies(steps, replies, result.error)
+                            : checkTextReplies(steps, replies, result.error)) &&
+                    checkGameState(steps, master, binary, timeoutMs, result.error);
+        return result;
+    }
+
+    // A text command whose reply ends with a known line
+    struct ReportCheck {
+        std::string command;
+        std::string firstLine;
+        std::function<bool(const std::string &)> isLast;
+        std::string mustContain; // Prefix of some line, or empty
+    };
+
+    // The reports the controller and the worker produce: each must arrive
+    // whole and carry its key content
+    Result runReportChecks(Master &master, const int timeoutMs) {
+        Result result;
+        result.name = "reports";
+
+        const auto equals = [](const std::string_view expected) {
+            return [expected](const std::string &line) { return line == expected; };
+        };
+        const auto startsWith = [](const std::string_view prefix) {
+            return [prefix](const std::string &line) { return line.starts_with(prefix); };
+        };
+
+        // METRICS has no end marker; a STATUS right behind it is answered
+        // after it
+        const std::vector<ReportCheck> checks = {
+            {"STATUS\n", "=== AllesSpitze Status ===", equals(STATUS_END), "Power: ON"},
+            {"I2C_STATS\n", "=== I2C Statistics ===", equals("======================"), "OPCODE"},
+            {"LATENCY\n", "=== Input Latency ===", equals("====================="), "press->frame"},
+            {"METRICS\nSTATUS\n", "# HELP", equals(STATUS_END), "allesspitze_healthcheck_consecutive_failures "},
+            {"SERIAL_STATS\n", "=== Serial Output ===", equals("====================="), "Policy: keep-replies"},
+            {"TRACE ON\n", "OK: Tracing on", equals("OK: Tracing on"), ""},
+            {"TRACE STATUS\n", "OK: Tracing is on", equals("OK: Tracing is on"), ""},
+            {"TRACE DUMP\n", "OK: Trace written to", startsWith("OK: Trace written to"), ""},
+            {"TRACE OFF\n", "OK: Tracing off", equals("OK: Tracing off"), ""},
+        };
+
+        std::vector<double> latenciesUs;
+        const auto start = SteadyClock::now();
+        for (const ReportCheck &check: checks) {
+            ++result.commands;
+            std::vector<std::string> lines;
+            const auto sent = SteadyClock::now();
+            if (!master.request(check.command, false, timeoutMs, check.isLast, lines)) {
+                result.ok = false;
+                result.error = QString("%1: incomplete reply").arg(QString::fromStdString(check.command).trimmed());
+                return result;
+            }
+            latenciesUs.push_back(std::chrono::duration<double, std::micro>(SteadyClock::now() - sent).count());
+
+            const bool contains = check.mustContain.empty() ||
+                                  std::ranges::any_of(lines, [&](const std::string &line) {
+                                      return line.starts_with(check.mustContain);
+                                  });
+            if (!lines.front().starts_with(check.firstLine) || !contains) {
+                result.ok = false;
+                result.error = QString("%1: unexpected reply '%2'")
+                    .arg(QString::fromStdString(check.command).trimmed(), QString::fromStdString(lines.front()));
+                return result;
+            }
+        }
+
+        result.seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+        std::sort(latenciesUs.begin(), latenciesUs.end());
+        result.p50Us = percentile(latenciesUs, 0.50);
+        result.p99Us = percentile(latenciesUs, 0.99);
+        result.maxUs = latenciesUs.back();
+        return result;
+    }
+
+    // POWER records, then a BALANCE burst under a rate limit: the first
+    // record goes out at once and the rest coalesce, the newest winning
+    Result runEventChecks(Master &master, const int timeoutMs) {
+        Result result;
+        result.name = "events";
+
+        const auto fail = [&result](const QString &error) {
+            result.ok = false;
+            result.error = error;
+            return result;
+        };
+        const auto reply = [&](const std::string &command, std::string &line) {
+            ++result.commands;
+            std::vector<std::string> lines;
+            if (!master.request(command, false, timeoutMs, [](const std::string &) { return true; }, lines)) {
+                return false;
+            }
+            line = lines.front();
+            return true;
+        };
+
+        std::string line;
+        master.takeEvents();
+        if (!reply("SUBSCRIBE POWER\n", line) || line != "OK: Subscriptions: POWER" ||
+            !reply("POWER_OFF\n", line) || !reply("POWER_ON\n", line)) {
+            return fail("SUBSCRIBE POWER or power commands not answered as expected");
+        }
+        // STATUS comes back after both power changes were published
+        if (!queryBalance(master, false, timeoutMs)) {
+            return fail("no STATUS report after the power cycle");
+        }
+        const std::vector<Event> power = master.takeEvents();
+        if (power.size() != 2 || power[0].eventClass != "POWER" || power[0].fields != "state=off" ||
+            power[1].fields != "state=on" || power[1].seq != power[0].seq + 1) {
+            return fail(QString("expected POWER state=off, state=on; got %1 records").arg(power.size()));
+        }
+
+        const std::string subscribe = "SUBSCRIBE BALANCE:" + std::to_string(COALESCE_INTERVAL_MS) + "\n";
+        if (!reply("UNSUBSCRIBE POWER\n", line) || !reply(subscribe, line) ||
+            line != "OK: Subscriptions: BALANCE:" + std::to_string(COALESCE_INTERVAL_MS)) {
+            return fail("SUBSCRIBE with a rate limit not answered as expected");
+        }
+
+        std::vector<Step> burst;
+        for (int i = 0; i < 50; ++i) {
+            const double balance = 7000 + i + 0.75;
+            burst.push_back({QString("SET_BALANCE %1\n").arg(balance).toStdString(), balanceLine(balance), true,
+                             balance});
+        }
+        std::vector<std::string> replies;
+        std::vector<double> latenciesUs;
+        result.commands += static_cast<int>(burst.size());
+        if (!master.exchange(burst, false, true, timeoutMs, replies, latenciesUs) ||
+            !checkTextReplies(burst, replies, result.error)) {
+            return fail("burst: " + result.error);
+        }
+
+        master.pump(COALESCE_INTERVAL_MS * 3, false);
+        const std::vector<Event> balances = master.takeEvents();
+        if (balances.empty() || balances.size() >= burst.size() || !balanceField(balances.back()) ||
+            std::abs(*balanceField(balances.back()) - burst.back().balance) > 0.005) {
+            return fail(QString("expected the burst to coalesce into fewer records ending at %1, got %2")
+                .arg(burst.back().balance).arg(balances.size()));
+        }
+        for (std::size_t i = 1; i < balances.size(); ++i) {
+            if (balances[i].seq != balances[i - 1].seq + 1) {
+                return fail("coalesced records must not leave sequence gaps");
+            }
+        }
+
+        if (!reply("UNSUBSCRIBE\n", line) || line != "OK: Subscriptions: none") {
+            return fail("UNSUBSCRIBE not answered as expected");
+        }
+        return result;
+    }
+
+    QJsonObject toJson(const Result &r) {
+        return {
+            {"scenario", r.name},
+            {"ok", r.ok},
+            {"commands", r.commands},
+            {"seconds", r.seconds},
+            {"commands_per_second", r.commandsPerSecond},
+            {"p50_us", r.p50Us},
+            {"p99_us", r.p99Us},
+            {"max_us", r.maxUs},
+            {"error", r.error}
+        };
+    }
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message) {
+        if (type == QtCriticalMsg || type == QtFatalMsg) {
+            std::fprintf(stderr, "%s\n", qPrintable(message));
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AllesSpitzeSerialHarness");
+    // Before DebugLogger picks its directory
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serial command path harness over a pseudo-terminal");
+    parser.addHelpOption();
+    const QCommandLineOption commandsOption("commands", "Commands per scenario.", "n", "2000");
+    const QCommandLineOption timeoutOption("timeout", "Per-scenario timeout.", "ms", "30000");
+    const QCommandLineOption outputOption("output", "Write results as JSON.", "file");
+    parser.addOptions({commandsOption, timeoutOption, outputOption});
+    parser.process(app);
+
+    const int commands = std::max(1, parser.value(commandsOption).toInt());
+    const int timeoutMs = std::max(100, parser.value(timeoutOption).toInt());
+
+    qInstallMessageHandler(quietMessageHandler);
+
+    int masterFd = -1;
+    int slaveFd = -1;
+    char slaveName[256] = {};
+    if (::openpty(&masterFd, &slaveFd, slaveName, nullptr, nullptr) != 0) {
+        std::perror("openpty");
+        return 2;
+    }
+
+    // Raw on both ends so nothing rewrites '\n' or swallows 0x00; the slave
+    // stays open here so the master never sees a hangup between opens
+    termios tio{};
+    ::tcgetattr(slaveFd, &tio);
+    ::cfmakeraw(&tio);
+    ::tcsetattr(slaveFd, TCSANOW, &tio);
+    ::fcntl(masterFd, F_SETFL, ::fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+    // The cabinet configuration, with the bus simulated and the serial port
+    // on the pty
+    qputenv("ALLESSPITZE_SERIAL_PORT", slaveName);
+    qputenv("ALLESSPITZE_I2C", "sim");
+    qunsetenv("ALLESSPITZE_SERIAL_OVERFLOW");
+    qunsetenv("ALLESSPITZE_TRACE");
+
+    ApplicationController controller(true);
+    controller.initialize();
+    if (!controller.start()) {
+        std::fprintf(stderr, "controller did not start\n");
+        return 2;
+    }
+
+    std::vector<Result> results;
+    bool connected = false;
+
+    // The driver runs beside the event loop, which keeps the controller
+    // going
+    std::thread driver([&] {
+        Master master(masterFd);
+        connected = master.waitForBanner(timeoutMs);
+        if (connected) {
+            std::vector<std::string> lines;
+            master.request("SUBSCRIBE BALANCE\n", false, timeoutMs, [](const std::string &) { return true; }, lines);
+
+            results.push_back(runScenario("text-pingpong", master, textBalanceSteps(commands), false, false,
+                                          timeoutMs));
+            results.push_back(runScenario("text-pipelined", master, textBalanceSteps(commands), false, true,
+                                          timeoutMs));
+            results.push_back(runScenario("text-mixed", master, textMixedSteps(commands), false, true, timeoutMs));
+            master.request("UNSUBSCRIBE\n", false, timeoutMs, [](const std::string &) { return true; }, lines);
+            master.takeEvents();
+
+            results.push_back(runReportChecks(master, timeoutMs));
+            results.push_back(runEventChecks(master, timeoutMs));
+
+            // One NUL switches to binary; TextMode at the end switches back
+            master.writeAll(std::string(1, '\0'));
+            const std::array<uint8_t, 3> balanceOnly = {
+                1u << static_cast<unsigned>(SerialWorker::EventClass::Balance), 0, 0
+            };
+            master.request(binaryFrame(Binary::Type::Subscribe, 0, balanceOnly), true, timeoutMs,
+                           [](const std::string &) { return true; }, lines);
+            results.push_back(runScenario("binary-pingpong", master, binaryBalanceSteps(commands), true, false,
+                                          timeoutMs));
+            results.push_back(runScenario("binary-pipelined", master, binaryBalanceSteps(commands), true, true,
+                                          timeoutMs));
+            master.request(binaryFrame(Binary::Type::Subscribe, 0, std::array<uint8_t, 3>{}), true, timeoutMs,
+                           [](const std::string &) { return true; }, lines);
+            master.request(binaryFrame(Binary::Type::TextMode, 0, {}), true, timeoutMs,
+                           [](const std::string &) { return true; }, lines);
+
+            Result back;
+            back.name = "text-again";
+            back.commands = 1;
+            if (!queryBalance(master, false, timeoutMs)) {
+                back.ok = false;
+                back.error = "no text STATUS after TextMode";
+            }
+            results.push_back(back);
+        }
+
+        QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+    });
+
+    QCoreApplication::exec();
+    driver.join();
+
+    if (!connected) {
+        std::fprintf(stderr, "no welcome banner on %s\n", slaveName);
+        ::close(masterFd);
+        ::close(slaveFd);
+        return 2;
+    }
+
+    std::printf("%-18s %8s %12s %10s %10s %10s  %s\n", "scenario", "cmds", "cmds/s", "p50 us", "p99 us", "max us",
+                "result");
+    QJsonArray json;
+    bool allOk = true;
+    for (const Result &r: results) {
+        allOk = allOk && r.ok;
+        json.append(toJson(r));
+        std::printf("%-18s %8d %12.0f %10.1f %10.1f %10.1f  %s\n", qPrintable(r.name), r.commands,
+                    r.commandsPerSecond, r.p50Us, r.p99Us, r.maxUs, r.ok ? "ok" : qPrintable(r.error));
+    }
+
+    if (parser.isSet(outputOption)) {
+        const QJsonObject root{
+            {"benchmark", "serial_harness"},
+            {"commands_per_scenario", commands},
+            {"results", json}
+        };
+
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(outputOption)));
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    ::close(masterFd);
+    ::close(slaveFd);
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// Throughput benchmark for the serial command parser.
+//
+// Feeds a scripted bulk-configuration stream through the line framer,
+// tokenizer and command table the way SerialWorker does, at several read
+// sizes, and reports lines per second next to the previous
+// QByteArray/QStringList parser. Heap allocations are counted by replacing
+// the global operator new; exits non-zero if the new path allocated.
+//
+// Usage: serial_parse_bench [lines]
+
+#include "SerialCommandParser.h"
+#include "SerialLineFramer.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace {
+    std::atomic<std::size_t> g_allocations{0};
+
+    enum class Command { PowerOn, PowerOff, SetBalance, SetProbabilities, Status, I2CStats };
+
+    struct Entry {
+        std::string_view name;
+        std::string_view alias;
+        Command command;
+    };
+
+    // Same names as SerialWorker::COMMANDS
+    constexpr std::array<Entry, 6> COMMANDS = {{
+        {"POWER_ON", "ON", Command::PowerOn},
+        {"POWER_OFF", "OFF", Command::PowerOff},
+        {"SET_BALANCE", "BALANCE", Command::SetBalance},
+        {"SET_PROB", "PROBABILITIES", Command::SetProbabilities},
+        {"STATUS", "?", Command::Status},
+        {"I2C_STATS", "", Command::I2CStats},
+    }};
+
+    // What a configuration script sends: mostly balance updates with the
+    // odd status poll, probability table and CRLF line ending
+    std::string makeScript(const long lines) {
+        std::string script;
+        script.reserve(static_cast<std::size_t>(lines) * 24);
+        for (long i = 0; i < lines; ++i) {
+            switch (i % 8) {
+                case 0: script += "SET_PROB {\"coin\":10,\"kleeblatt\":15,\"teufel\":5}\n"; break;
+                case 1: script += "status\r\n"; break;
+                case 2: script += "POWER_ON\n"; break;
+                default: script += "SET_BALANCE " + std::to_string(i % 1000) + ".50\n"; break;
+            }
+        }
+        return script;
+    }
+
+    struct Result {
+        double linesPerSecond;
+        std::size_t allocations;
+        double checksum;
+    };
+
+    template<typename Fn>
+    Result run(const long lines, Fn &&fn) {
+        const std::size_t allocsBefore = g_allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        const double checksum = fn();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return {
+            static_cast<double>(lines) / std::chrono::duration<double>(elapsed).count(),
+            g_allocations.load() - allocsBefore,
+            checksum
+        };
+    }
+
+    // The framer/tokenizer path from SerialWorker::handleReadyRead()
+    double parseFast(const std::string &script, const std::size_t readSize) {
+        SerialLineFramer framer;
+        double checksum = 0.0;
+
+        const auto onLine = [&](const std::string_view line) {
+            const auto [name, args] = SerialCommandParser::tokenize(line);
+            const Entry *entry = SerialCommandParser::find(COMMANDS, name);
+            if (!entry) {
+                return;
+            }
+            checksum += static_cast<double>(entry->command);
+
+            if (entry->command == Command::SetBalance) {
+                std::string_view rest = args;
+                double balance = 0.0;
+                if (SerialCommandParser::parseDouble(SerialCommandParser::nextToken(rest), balance)) {
+                    checksum += balance;
+                }
+            } else if (entry->command == Command::SetProbabilities) {
+                checksum += static_cast<double>(args.size());
+            }
+        };
+
+        for (std::size_t pos = 0; pos < script.size();) {
+            // Mimic QSerialPort::read() into the ring, readSize bytes at most
+            const std::span<char> space = framer.writable();
+            const std::size_t count = std::min({space.size(), readSize, script.size() - pos});
+            std::memcpy(space.data(), script.data() + pos, count);
+            framer.commit(count);
+            framer.drain(onLine);
+            pos += count;
+        }
+        return checksum;
+    }
+
+    // The parser SerialWorker used before the framer, minus the responses
+    double parseLegacy(const std::string &script, const std::size_t readSize) {
+        QByteArray buffer;
+        double checksum = 0.0;
+
+        for (std::size_t pos = 0; pos < script.size(); pos += readSize) {
+            const std::size_t count = std::min(readSize, script.size() - pos);
+            buffer.append(script.data() + pos, static_cast<qsizetype>(count));
+
+            while (buffer.contains('\n')) {
+                const qsizetype newlinePos = buffer.indexOf('\n');
+                QByteArray line = buffer.left(newlinePos);
+                buffer.remove(0, newlinePos + 1);
+                if (line.endsWith('\r')) {
+                    line.chop(1);
+                }
+                if (line.isEmpty()) {
+                    continue;
+                }
+
+                const QString text = QString::fromUtf8(line).trimmed();
+                const QStringList parts = text.split(' ', Qt::SkipEmptyParts);
+                if (parts.isEmpty()) {
+                    continue;
+                }
+
+                const QString cmd = parts[0].toUpper();
+                if (cmd == "POWER_ON" || cmd == "ON") {
+                    checksum += static_cast<double>(Command::PowerOn);
+                } else if (cmd == "SET_BALANCE" || cmd == "BALANCE") {
+                    checksum += static_cast<double>(Command::SetBalance);
+                    bool ok = false;
+                    const double balance = parts.size() > 1 ? parts[1].toDouble(&ok) : 0.0;
+                    if (ok) {
+                        checksum += balance;
+                    }
+                } else if (cmd == "SET_PROB" || cmd == "PROBABILITIES") {
+                    checksum += static_cast<double>(Command::SetProbabilities);
+                    checksum += static_cast<double>(text.mid(cmd.length()).trimmed().toUtf8().size());
+                } else if (cmd == "STATUS" || cmd == "?") {
+                    checksum += static_cast<double>(Command::Status);
+                }
+            }
+        }
+        return checksum;
+    }
+}
+
+void *operator new(const std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+int main(const int argc, char *argv[]) {
+    const long lines = argc > 1 ? std::atol(argv[1]) : 200'000;
+    if (lines <= 0) {
+        std::fprintf(stderr, "usage: %s [lines]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string script = makeScript(lines);
+    bool allocated = false;
+    bool mismatch = false;
+
+    std::printf("%-8s %-10s %14s %12s\n", "read", "parser", "lines/s", "allocations");
+    // 32 bytes is a typical FTDI read at 115200 baud; the larger sizes model
+    // a burst that piled up while the thread was busy
+    for (const std::size_t readSize: {std::size_t{32}, std::size_t{4096}, script.size()}) {
+        const Result fast = run(lines, [&] { return parseFast(script, readSize); });
+        const Result legacy = run(lines, [&] { return parseLegacy(script, readSize); });
+
+        const std::string label = readSize == script.size() ? "all" : std::to_string(readSize);
+        std::printf("%-8s %-10s %14.0f %12zu\n", label.c_str(), "framer", fast.linesPerSecond, fast.allocations);
+        std::printf("%-8s %-10s %14.0f %12zu\n", label.c_str(), "legacy", legacy.linesPerSecond, legacy.allocations);
+
+        allocated = allocated || fast.allocations != 0;
+        mismatch = mismatch || fast.checksum != legacy.checksum;
+    }
+    std::printf("lines: %ld (%zu bytes)\n", lines, script.size());
+
+    if (mismatch) {
+        std::fprintf(stderr, "FAIL: framer and legacy parser disagree\n");
+        return 1;
+    }
+    if (allocated) {
+        std::fprintf(stderr, "FAIL: parser hot path allocated on the heap\n");
+        return 1;
+    }
+    return 0;
+}